@@ -1,7 +1,7 @@
 #====================================================================================================================#
 # Function: compile_shaders
 # Description: 
-#	If the shader is missing or has been modified (re)compile it, otherwise skip it
+#	Adds the compile_shaders target, a shader is (re)compiled by the build when it is missing or has been modified
 # Usage: 
 #	compile_shaders(src_dir dest_dir)
 function(compile_shaders SRC_DIR DEST_DIR)
@@ -32,34 +32,24 @@ function(compile_shaders SRC_DIR DEST_DIR)
 	)
 
 	list(LENGTH shaders shaders_count)
-	message(STATUS "compile_shaders: Compiling ${shaders_count} shaders from ${SRC_DIR} to ${DEST_DIR}")
+	message(STATUS "compile_shaders: ${shaders_count} shaders from ${SRC_DIR} are compiled to ${DEST_DIR}")
 
-	set(shader_log)
+	set(outputs)
 	foreach(shader IN LISTS shaders)
 		get_filename_component(filename ${shader} NAME)
 		get_filename_component(filename_we ${shader} NAME_WE)
 		set(output_file ${DEST_DIR}/${filename_we}.spv)
 
-		if(NOT EXISTS ${output_file} OR ${shader} IS_NEWER_THAN ${output_file})
-			execute_process(
-				COMMAND ${Vulkan_GLSLC_EXECUTABLE} ${shader} -o ${output_file}
-				OUTPUT_VARIABLE output
-				RESULT_VARIABLE result
-			)
-			if(result)
-				list(APPEND shader_log "compile_shaders: ❌ ${filename} -> ${filename_we}.spv (${result})")
-				message(WARNING ${output})
-			else()
-				list(APPEND shader_log "compile_shaders: ✅ ${filename} -> ${filename_we}.spv (sucsess)")
-			endif()
-		else()
-			list(APPEND shader_log "compile_shaders: ♻️ ${filename} -> ${filename_we}.spv (up to date)")
-		endif()
-	endforeach()
+		add_custom_command(
+			OUTPUT ${output_file}
+			COMMAND ${Vulkan_GLSLC_EXECUTABLE} ${shader} -o ${output_file}
+			DEPENDS ${shader}
+			COMMENT "compile_shaders: ${filename} -> ${filename_we}.spv"
+			VERBATIM
+		)
 
-	foreach(_line IN LISTS _log)
-		message(STATUS ${_line})
+		list(APPEND outputs ${output_file})
 	endforeach()
 
-	unset(shader_log)
+	add_custom_target(compile_shaders ALL DEPENDS ${outputs})
 endfunction()
\ No newline at end of file
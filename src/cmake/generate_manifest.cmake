@@ -0,0 +1,19 @@
+#====================================================================================================================#
+# Script: generate_manifest
+# Description: 
+#	Lists every file of the resource folder in RES_DIR/resources.manifest, one path relative to RES_DIR per line.
+#	FileProvider builds its index from the manifest instead of scanning the folder at startup
+# Usage: 
+#	cmake -DRES_DIR=<resource folder> -P generate_manifest.cmake
+if(NOT RES_DIR)
+	message(FATAL_ERROR "generate_manifest: RES_DIR not specified")
+endif()
+
+file(GLOB_RECURSE resources RELATIVE ${RES_DIR} ${RES_DIR}/*)
+list(REMOVE_ITEM resources resources.manifest)
+list(SORT resources)
+list(LENGTH resources resources_count)
+list(JOIN resources "\n" manifest)
+
+file(WRITE ${RES_DIR}/resources.manifest "${manifest}\n")
+message(STATUS "generate_manifest: ${resources_count} files listed in ${RES_DIR}/resources.manifest")
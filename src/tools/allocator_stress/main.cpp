@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "context/Context.hpp"
+#include "memory/MemoryAllocator.hpp"
+#include "utils/Tools.hpp"
+
+
+// Memory allocator stress test.
+// Creates tens of thousands of buffers through vktools::create_buffer, the path of BufferHolder, with sizes spread from
+// 256 bytes to 256 KiB and a few of several MiB. Every round frees a random half of them and refills the set with new sizes.
+// After every phase it checks that
+//  - no two live sub-allocations of a block overlap and every offset honours the alignment of its buffer
+//  - the host visible buffers are mapped, their first and last byte are written
+//  - the statistics of the allocator match the live buffers
+//  - the VkDeviceMemory objects (blocks and dedicated) stay below maxMemoryAllocationCount
+// At the end every buffer is freed, the blocks must be empty and trim() must give all of them back.
+// Reports the time per allocation and free, the overhead of the buddy rounding and the fragmentation of every phase.
+// The context is headless, the test runs on lavapipe.
+//
+// Usage: allocator_stress [buffer count] [rounds] [seed]
+
+
+struct TestBuffer
+{
+    VkBuffer     handle = VK_NULL_HANDLE;
+    Allocation   allocation;
+    VkDeviceSize alignment = 0;
+    bool         hostVisible = false;
+};
+
+
+struct Phase
+{
+    const char* name;
+    uint32_t    round;
+    double      time; // us per buffer
+};
+
+
+static VkDeviceSize random_size(std::mt19937& rng) noexcept
+{
+//  one buffer in a hundred is a large one, the largest of them exceed half a block and become dedicated allocations
+    if (rng() % 100 == 0)
+        return VkDeviceSize(1 + rng() % 48) * 1024 * 1024;
+
+//  log uniform between 256 bytes and 256 KiB, odd sizes included
+    const double exponent = std::uniform_real_distribution<double>(8.0, 18.0)(rng);
+
+    return static_cast<VkDeviceSize>(std::exp2(exponent));
+}
+
+
+static bool create(TestBuffer& buffer, std::mt19937& rng, VkDevice device) noexcept
+{
+    static constexpr VkBufferUsageFlags usages[] =
+    {
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+    };
+
+    const VkBufferUsageFlags usage = usages[rng() % std::size(usages)] | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    buffer.hostVisible = (rng() % 4 == 0);
+    buffer.handle      = vktools::create_buffer(random_size(rng),
+                                                usage,
+                                                buffer.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                &buffer.allocation,
+                                                device);
+
+    if (!buffer.handle)
+        return false;
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(device, buffer.handle, &requirements);
+    buffer.alignment = requirements.alignment;
+
+    return true;
+}
+
+
+static bool validate(const std::vector<TestBuffer>& buffers, uint32_t memoryObjectLimit) noexcept
+{
+    struct Range
+    {
+        VkDeviceMemory memory;
+        VkDeviceSize   begin;
+        VkDeviceSize   end;
+    };
+
+    std::vector<Range> ranges;
+    VkDeviceSize requested = 0;
+    uint32_t live = 0;
+    bool valid = true;
+
+    for (const auto& buffer : buffers)
+    {
+        if (!buffer.handle)
+            continue;
+
+        const Allocation& allocation = buffer.allocation;
+
+        live++;
+        requested += allocation.size;
+
+        if (allocation.offset % buffer.alignment)
+        {
+            spdlog::error("Allocator stress: offset {} breaks the alignment {}", allocation.offset, buffer.alignment);
+            valid = false;
+        }
+
+        if (buffer.hostVisible)
+        {
+            if (!allocation.mapped)
+            {
+                spdlog::error("Allocator stress: a host visible buffer of {} bytes is not mapped", allocation.size);
+                valid = false;
+            }
+            else
+            {
+                static_cast<uint8_t*>(allocation.mapped)[0] = 0xAB;
+                static_cast<uint8_t*>(allocation.mapped)[allocation.size - 1] = 0xCD;
+            }
+        }
+
+        if (allocation.block)
+            ranges.push_back({ allocation.memory, allocation.offset, allocation.offset + allocation.size });
+    }
+
+    std::sort(ranges.begin(), ranges.end(), [](const Range& a, const Range& b) { return (a.memory != b.memory) ? a.memory < b.memory : a.begin < b.begin; });
+
+    for (size_t i = 1; i < ranges.size(); ++i)
+    {
+        if (ranges[i].memory == ranges[i - 1].memory && ranges[i].begin < ranges[i - 1].end)
+        {
+            spdlog::error("Allocator stress: [{}, {}) overlaps [{}, {})", ranges[i].begin, ranges[i].end, ranges[i - 1].begin, ranges[i - 1].end);
+            valid = false;
+        }
+    }
+
+    const auto stats = vkAllocator->getStatistics();
+
+    if (stats.allocationCount != live || stats.bytesRequested != requested)
+    {
+        spdlog::error("Allocator stress: the statistics count {} allocations of {} bytes, {} of {} bytes are live", stats.allocationCount, stats.bytesRequested, live, requested);
+        valid = false;
+    }
+
+    if (stats.blockCount + stats.dedicatedCount > memoryObjectLimit)
+    {
+        spdlog::error("Allocator stress: {} memory objects exceed maxMemoryAllocationCount {}", stats.blockCount + stats.dedicatedCount, memoryObjectLimit);
+        valid = false;
+    }
+
+    return valid;
+}
+
+
+static void report(const Phase& phase) noexcept
+{
+    const auto stats = vkAllocator->getStatistics();
+
+    spdlog::info("Allocator stress: round {} {:<7} {:7.2f} us per buffer, {:6} live, {:3} blocks, {:2} dedicated, {:6.1f} MiB reserved, "
+                 "{:5.1f}% buddy overhead, largest free range {:8} KiB, fragmentation {:.3f}",
+                 phase.round, phase.name, phase.time, stats.allocationCount, stats.blockCount, stats.dedicatedCount, stats.bytesReserved / (1024.0 * 1024.0),
+                 stats.bytesRequested ? 100.0 * double(stats.bytesAllocated - stats.bytesRequested) / double(stats.bytesRequested) : 0.0,
+                 stats.largestFreeRange / 1024, stats.fragmentation);
+}
+
+
+int main(int argc, char* argv[])
+{
+    const uint32_t bufferCount = (argc > 1) ? static_cast<uint32_t>(std::stoul(argv[1])) : 20000;
+    const uint32_t rounds      = (argc > 2) ? static_cast<uint32_t>(std::stoul(argv[2])) : 8;
+    const uint32_t seed        = (argc > 3) ? static_cast<uint32_t>(std::stoul(argv[3])) : 1;
+
+    if (bufferCount == 0)
+    {
+        spdlog::error("Usage: allocator_stress [buffer count] [rounds] [seed]");
+
+        return EXIT_FAILURE;
+    }
+
+    VulkanContext context;
+    MemoryAllocator allocator;
+
+    if (!context.create(true) || !allocator.create())
+    {
+        spdlog::error("Allocator stress: failed to create the vulkan context");
+
+        return EXIT_FAILURE;
+    }
+
+    const auto device = context.get<VkDevice>();
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(context.get<VkPhysicalDevice>(), &properties);
+
+    const uint32_t memoryObjectLimit = properties.limits.maxMemoryAllocationCount;
+
+    spdlog::info("Allocator stress: {} buffers, {} rounds, seed {}, maxMemoryAllocationCount {}", bufferCount, rounds, seed, memoryObjectLimit);
+
+    std::mt19937 rng(seed);
+    std::vector<TestBuffer> buffers(bufferCount);
+    std::vector<uint32_t> order(bufferCount);
+    bool passed = true;
+
+//  fills every empty slot, returns the time per created buffer
+    const auto fill = [&]() -> double
+    {
+        uint32_t created = 0;
+        const auto start = std::chrono::steady_clock::now();
+
+        for (auto& buffer : buffers)
+        {
+            if (buffer.handle)
+                continue;
+
+            if (!create(buffer, rng, device))
+            {
+                spdlog::error("Allocator stress: failed to create buffer {} of {}", created, bufferCount);
+                passed = false;
+
+                break;
+            }
+
+            created++;
+        }
+
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / std::max(created, 1u);
+    };
+
+//  frees a random part of the buffers, all of them with a count of bufferCount
+    const auto release = [&](uint32_t count) -> double
+    {
+        for (uint32_t i = 0; i < bufferCount; ++i)
+            order[i] = i;
+
+        std::shuffle(order.begin(), order.end(), rng);
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            TestBuffer& buffer = buffers[order[i]];
+
+            vktools::destroy_buffer(buffer.handle, buffer.allocation, device);
+            buffer = {};
+        }
+
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / std::max(count, 1u);
+    };
+
+    Phase phase = { "fill", 0, fill() };
+
+    passed = passed && validate(buffers, memoryObjectLimit);
+    report(phase);
+
+    for (uint32_t round = 1; round <= rounds && passed; ++round)
+    {
+        phase = { "free", round, release(bufferCount / 2) };
+        passed = validate(buffers, memoryObjectLimit);
+        report(phase);
+
+        phase = { "refill", round, fill() };
+        passed = passed && validate(buffers, memoryObjectLimit);
+        report(phase);
+    }
+
+    phase = { "free", rounds + 1, release(bufferCount) };
+    report(phase);
+
+    const auto stats = allocator.getStatistics();
+
+    if (stats.allocationCount != 0 || stats.bytesAllocated != 0 || stats.fragmentation != 0.f)
+    {
+        spdlog::error("Allocator stress: {} allocations of {} bytes left after freeing every buffer, fragmentation {:.3f}",
+                      stats.allocationCount, stats.bytesAllocated, stats.fragmentation);
+        passed = false;
+    }
+
+    allocator.trim();
+
+    if (allocator.getStatistics().blockCount != 0)
+    {
+        spdlog::error("Allocator stress: trim() left {} empty blocks", allocator.getStatistics().blockCount);
+        passed = false;
+    }
+
+    allocator.destroy();
+    context.destroy();
+
+    spdlog::info("Allocator stress: {}", passed ? "passed" : "FAILED");
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
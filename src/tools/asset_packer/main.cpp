@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "files/Lz4.hpp"
+#include "files/MappedFile.hpp"
+#include "files/PackFormat.hpp"
+
+
+// Asset packer.
+// Writes the files of one or more directories into a single pack (files/PackFormat.hpp) served by FileProvider.
+// A directory is packed under its own virtual prefix with directory=prefix, res/ itself goes to the root.
+// Entries are LZ4 compressed when it saves at least an eighth of their size, unless --store is given.
+//
+// Usage: asset_packer [--store] <output pack> <directory>[=<virtual prefix>]...
+
+
+struct Source
+{
+    std::string           virtualPath;
+    std::filesystem::path path;
+};
+
+
+static bool write_padding(FILE* file, uint64_t* offset, uint64_t alignment) noexcept
+{
+    static const uint8_t zeros[pack_data_alignment] = {};
+
+    const uint64_t padding = (alignment - *offset % alignment) % alignment;
+    *offset += padding;
+
+    return fwrite(zeros, 1, padding, file) == padding;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    int argument = 1;
+    bool compress = true;
+
+    if (argument < argc && std::string(argv[argument]) == "--store")
+    {
+        compress = false;
+        argument++;
+    }
+
+    if (argc - argument < 2)
+    {
+        spdlog::error("Usage: asset_packer [--store] <output pack> <directory>[=<virtual prefix>]...");
+
+        return EXIT_FAILURE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::filesystem::path output = argv[argument++];
+
+    std::vector<Source> sources;
+
+    for (; argument < argc; ++argument)
+    {
+        const std::string directoryArgument = argv[argument];
+        const size_t separator = directoryArgument.find('=');
+
+        const std::filesystem::path directory = directoryArgument.substr(0, separator);
+        const std::string prefix = (separator == std::string::npos) ? std::string() : directoryArgument.substr(separator + 1) + '/';
+
+        std::error_code error;
+
+        for (const auto& file : std::filesystem::recursive_directory_iterator(directory, error))
+            if (file.is_regular_file() && file.path().filename() != "resources.manifest")
+                sources.push_back({ prefix + file.path().lexically_relative(directory).generic_string(), file.path() });
+
+        if (error)
+        {
+            spdlog::error("Asset packer: failed to list {}, {}", directory.string(), error.message());
+
+            return EXIT_FAILURE;
+        }
+    }
+
+//  a later directory overrides the files of an earlier one, the compiled shaders win over stale copies
+    std::stable_sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) { return a.virtualPath < b.virtualPath; });
+
+    for (size_t i = 1; i < sources.size(); )
+    {
+        if (sources[i - 1].virtualPath == sources[i].virtualPath)
+            sources.erase(sources.begin() + (i - 1));
+        else
+            ++i;
+    }
+
+    std::vector<PackEntry> entries(sources.size());
+    std::string paths;
+
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        entries[i] = {};
+        entries[i].pathHash   = pack_hash(sources[i].virtualPath);
+        entries[i].pathOffset = static_cast<uint32_t>(paths.size());
+        entries[i].pathLength = static_cast<uint32_t>(sources[i].virtualPath.size());
+        paths += sources[i].virtualPath;
+    }
+
+//  the order of the table, the sources follow it so that entry i is source i
+    std::vector<size_t> order(sources.size());
+
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+    {
+        return (entries[a].pathHash != entries[b].pathHash) ? entries[a].pathHash < entries[b].pathHash : sources[a].virtualPath < sources[b].virtualPath;
+    });
+
+    {
+        std::vector<PackEntry> sortedEntries;
+        std::vector<Source>    sortedSources;
+
+        for (size_t i : order)
+        {
+            sortedEntries.push_back(entries[i]);
+            sortedSources.push_back(std::move(sources[i]));
+        }
+
+        entries = std::move(sortedEntries);
+        sources = std::move(sortedSources);
+    }
+
+    std::vector<PackName> names(sources.size());
+
+    for (size_t i = 0; i < sources.size(); ++i)
+        names[i] = { pack_hash(pack_file_name(sources[i].virtualPath)), static_cast<uint32_t>(i), 0 };
+
+    std::sort(names.begin(), names.end(), [&](const PackName& a, const PackName& b)
+    {
+        return (a.nameHash != b.nameHash) ? a.nameHash < b.nameHash : sources[a.entry].virtualPath < sources[b.entry].virtualPath;
+    });
+
+    PackHeader header =
+    {
+        .magic         = {},
+        .version       = pack_version,
+        .entryCount    = static_cast<uint32_t>(entries.size()),
+        .reserved      = 0,
+        .entriesOffset = sizeof(PackHeader),
+        .namesOffset   = sizeof(PackHeader) + sizeof(PackEntry) * entries.size(),
+        .pathsOffset   = sizeof(PackHeader) + sizeof(PackEntry) * entries.size() + sizeof(PackName) * names.size()
+    };
+
+    memcpy(header.magic, pack_magic, sizeof(header.magic));
+
+    const std::filesystem::path temporary = std::filesystem::path(output).concat(".tmp");
+    FILE* file = fopen(temporary.string().c_str(), "wb");
+
+    if (!file)
+    {
+        spdlog::error("Asset packer: failed to create {}", temporary.string());
+
+        return EXIT_FAILURE;
+    }
+
+//  the tables are written once the data offsets are known
+    uint64_t offset = header.pathsOffset + paths.size();
+    bool written = fseek(file, static_cast<long>(offset), SEEK_SET) == 0;
+
+    uint64_t totalSize  = 0;
+    uint64_t storedSize = 0;
+
+    for (size_t i = 0; i < sources.size() && written; ++i)
+    {
+        MappedFile source;
+        std::vector<uint8_t> compressed;
+        std::span<const uint8_t> data;
+
+//      an empty file cannot be mapped, it is stored as an empty entry
+        if (source.open(sources[i].path))
+            data = source.getData();
+        else if (std::error_code error; std::filesystem::file_size(sources[i].path, error) != 0 || error)
+            written = false;
+
+        if (compress && !data.empty())
+            compressed = lz4_compress(data);
+
+        const bool useCompressed = !compressed.empty() && compressed.size() <= data.size() - data.size() / 8;
+        const std::span<const uint8_t> stored = useCompressed ? std::span<const uint8_t>(compressed) : data;
+
+        written = written && write_padding(file, &offset, pack_data_alignment);
+
+        entries[i].offset      = offset;
+        entries[i].size        = data.size();
+        entries[i].storedSize  = stored.size();
+        entries[i].compression = useCompressed ? PackCompressionLz4 : PackCompressionNone;
+
+        written = written && fwrite(stored.data(), 1, stored.size(), file) == stored.size();
+        offset += stored.size();
+
+        totalSize  += data.size();
+        storedSize += stored.size();
+    }
+
+    written = written && fseek(file, 0, SEEK_SET) == 0 &&
+              fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(entries.data(), sizeof(PackEntry), entries.size(), file) == entries.size() &&
+              fwrite(names.data(), sizeof(PackName), names.size(), file) == names.size() &&
+              fwrite(paths.data(), 1, paths.size(), file) == paths.size();
+
+    written = (fclose(file) == 0) && written;
+
+    std::error_code error;
+
+    if (written)
+        std::filesystem::rename(temporary, output, error);
+
+    if (!written || error)
+    {
+        spdlog::error("Asset packer: failed to write {}", output.string());
+        std::filesystem::remove(temporary, error);
+
+        return EXIT_FAILURE;
+    }
+
+    spdlog::info("Asset packer: {} files, {:.2f} MiB stored as {:.2f} MiB in {} ({:.3f} s)",
+                 entries.size(), totalSize / (1024.0 * 1024.0), storedSize / (1024.0 * 1024.0), output.string(),
+                 std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+    return EXIT_SUCCESS;
+}
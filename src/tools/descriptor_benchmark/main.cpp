@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "context/Context.hpp"
+#include "pipeline/descriptors/DescriptorUpdateTemplate.hpp"
+#include "pipeline/descriptors/DescriptorWriter.hpp"
+
+
+// Descriptor update CPU microbenchmark.
+// Writes every set of a pool of identical sets, each holding two uniform buffers and two storage buffers, and reports
+// the CPU time per set of each way to do it:
+//  single write - one vkUpdateDescriptorSets per descriptor, the former DescriptorPool::writeBufferInfo
+//  per set      - one vkUpdateDescriptorSets per set with its four writes
+//  writer       - DescriptorWriter, every write of every set in one vkUpdateDescriptorSets
+//  template     - DescriptorUpdateTemplate, one vkUpdateDescriptorSetWithTemplate per set
+// Nothing is drawn, the device only has to exist and the context is headless. The offsets differ from set to set so no
+// update is a no-op.
+//
+// Usage: descriptor_benchmark [set count] [passes]
+
+
+static constexpr uint32_t binding_count = 4;
+static constexpr uint32_t offset_count  = 64;
+static constexpr VkDeviceSize block_size = 256; // the largest minUniformBufferOffsetAlignment allowed by the spec
+
+static constexpr std::array<VkDescriptorType, binding_count> binding_types =
+{
+    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+};
+
+
+// the data of a template update, one info per binding
+struct SetData
+{
+    std::array<VkDescriptorBufferInfo, binding_count> buffers;
+};
+
+
+struct Resources
+{
+    VkBuffer              buffer = VK_NULL_HANDLE;
+    VkDeviceMemory        memory = VK_NULL_HANDLE;
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    VkDescriptorPool      pool   = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> sets;
+    std::vector<SetData>         data; // what every set gets written, filled before the timing
+};
+
+
+static bool create_buffer(Resources& resources, VkDevice device) noexcept
+{
+    const VkBufferCreateInfo bufferInfo =
+    {
+        .sType                 = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext                 = VK_NULL_HANDLE,
+        .flags                 = 0,
+        .size                  = block_size * offset_count,
+        .usage                 = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 0,
+        .pQueueFamilyIndices   = VK_NULL_HANDLE
+    };
+
+    if (vkCreateBuffer(device, &bufferInfo, VK_NULL_HANDLE, &resources.buffer) != VK_SUCCESS)
+        return false;
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(device, resources.buffer, &requirements);
+
+//  the buffer is never accessed, any memory type it accepts will do
+    const VkMemoryAllocateInfo allocateInfo =
+    {
+        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext           = VK_NULL_HANDLE,
+        .allocationSize  = requirements.size,
+        .memoryTypeIndex = static_cast<uint32_t>(std::countr_zero(requirements.memoryTypeBits))
+    };
+
+    if (vkAllocateMemory(device, &allocateInfo, VK_NULL_HANDLE, &resources.memory) != VK_SUCCESS)
+        return false;
+
+    return (vkBindBufferMemory(device, resources.buffer, resources.memory, 0) == VK_SUCCESS);
+}
+
+
+static bool create_sets(Resources& resources, uint32_t setCount, VkDevice device) noexcept
+{
+    std::array<VkDescriptorSetLayoutBinding, binding_count> bindings;
+
+    for (uint32_t i = 0; i < binding_count; ++i)
+        bindings[i] = { i, binding_types[i], 1, VK_SHADER_STAGE_VERTEX_BIT, VK_NULL_HANDLE };
+
+    const VkDescriptorSetLayoutCreateInfo layoutInfo =
+    {
+        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext        = VK_NULL_HANDLE,
+        .flags        = 0,
+        .bindingCount = binding_count,
+        .pBindings    = bindings.data()
+    };
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, VK_NULL_HANDLE, &resources.layout) != VK_SUCCESS)
+        return false;
+
+    const std::array<VkDescriptorPoolSize, 2> poolSizes =
+    {
+        VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 * setCount },
+        VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * setCount }
+    };
+
+    const VkDescriptorPoolCreateInfo poolInfo =
+    {
+        .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext         = VK_NULL_HANDLE,
+        .flags         = 0,
+        .maxSets       = setCount,
+        .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+        .pPoolSizes    = poolSizes.data()
+    };
+
+    if (vkCreateDescriptorPool(device, &poolInfo, VK_NULL_HANDLE, &resources.pool) != VK_SUCCESS)
+        return false;
+
+    const std::vector<VkDescriptorSetLayout> layouts(setCount, resources.layout);
+    resources.sets.resize(setCount);
+
+    const VkDescriptorSetAllocateInfo allocateInfo =
+    {
+        .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext              = VK_NULL_HANDLE,
+        .descriptorPool     = resources.pool,
+        .descriptorSetCount = setCount,
+        .pSetLayouts        = layouts.data()
+    };
+
+    if (vkAllocateDescriptorSets(device, &allocateInfo, resources.sets.data()) != VK_SUCCESS)
+        return false;
+
+    resources.data.resize(setCount);
+
+    for (uint32_t i = 0; i < setCount; ++i)
+    {
+        for (uint32_t binding = 0; binding < binding_count; ++binding)
+        {
+            const VkDeviceSize offset = ((i + binding) % offset_count) * block_size;
+
+            resources.data[i].buffers[binding] = { resources.buffer, offset, block_size };
+        }
+    }
+
+    return true;
+}
+
+
+static void destroy(Resources& resources, VkDevice device) noexcept
+{
+    if (resources.pool)
+        vkDestroyDescriptorPool(device, resources.pool, VK_NULL_HANDLE);
+
+    if (resources.layout)
+        vkDestroyDescriptorSetLayout(device, resources.layout, VK_NULL_HANDLE);
+
+    if (resources.buffer)
+        vkDestroyBuffer(device, resources.buffer, VK_NULL_HANDLE);
+
+    if (resources.memory)
+        vkFreeMemory(device, resources.memory, VK_NULL_HANDLE);
+}
+
+
+static VkWriteDescriptorSet make_write(VkDescriptorSet set, uint32_t binding, const VkDescriptorBufferInfo* bufferInfo) noexcept
+{
+    return
+    {
+        .sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext            = VK_NULL_HANDLE,
+        .dstSet           = set,
+        .dstBinding       = binding,
+        .dstArrayElement  = 0,
+        .descriptorCount  = 1,
+        .descriptorType   = binding_types[binding],
+        .pImageInfo       = VK_NULL_HANDLE,
+        .pBufferInfo      = bufferInfo,
+        .pTexelBufferView = VK_NULL_HANDLE
+    };
+}
+
+
+int main(int argc, char* argv[])
+{
+    const uint32_t setCount = (argc > 1) ? static_cast<uint32_t>(std::stoul(argv[1])) : 4096;
+    const uint32_t passes   = (argc > 2) ? static_cast<uint32_t>(std::stoul(argv[2])) : 20;
+
+    if (setCount == 0 || passes == 0)
+    {
+        spdlog::error("Usage: descriptor_benchmark [set count] [passes]");
+
+        return EXIT_FAILURE;
+    }
+
+    VulkanContext context;
+
+    if (!context.create(true))
+    {
+        spdlog::error("Descriptor benchmark: failed to create the vulkan context");
+
+        return EXIT_FAILURE;
+    }
+
+    const auto device = context.get<VkDevice>();
+
+    Resources resources;
+    DescriptorUpdateTemplate updateTemplate;
+    DescriptorWriter writer;
+
+    std::array<VkDescriptorUpdateTemplateEntry, binding_count> entries;
+
+    for (uint32_t i = 0; i < binding_count; ++i)
+        entries[i] = { i, 0, 1, binding_types[i], offsetof(SetData, buffers) + i * sizeof(VkDescriptorBufferInfo), sizeof(VkDescriptorBufferInfo) };
+
+    if (!create_buffer(resources, device) || !create_sets(resources, setCount, device) || !updateTemplate.create(resources.layout, entries))
+    {
+        spdlog::error("Descriptor benchmark: failed to create {} sets", setCount);
+
+        updateTemplate.destroy();
+        destroy(resources, device);
+        context.destroy();
+
+        return EXIT_FAILURE;
+    }
+
+    writer.reserve(static_cast<size_t>(setCount) * binding_count);
+
+    struct Method
+    {
+        const char* name;
+        void (*run)(const Resources&, const DescriptorUpdateTemplate&, DescriptorWriter&, VkDevice);
+    };
+
+    const std::array<Method, 4> methods =
+    {
+        Method { "single write", [](const Resources& res, const DescriptorUpdateTemplate&, DescriptorWriter&, VkDevice logicalDevice)
+        {
+            for (size_t i = 0; i < res.sets.size(); ++i)
+            {
+                for (uint32_t binding = 0; binding < binding_count; ++binding)
+                {
+                    const VkWriteDescriptorSet write = make_write(res.sets[i], binding, &res.data[i].buffers[binding]);
+                    vkUpdateDescriptorSets(logicalDevice, 1, &write, 0, VK_NULL_HANDLE);
+                }
+            }
+        }},
+        Method { "per set", [](const Resources& res, const DescriptorUpdateTemplate&, DescriptorWriter&, VkDevice logicalDevice)
+        {
+            for (size_t i = 0; i < res.sets.size(); ++i)
+            {
+                std::array<VkWriteDescriptorSet, binding_count> writes;
+
+                for (uint32_t binding = 0; binding < binding_count; ++binding)
+                    writes[binding] = make_write(res.sets[i], binding, &res.data[i].buffers[binding]);
+
+                vkUpdateDescriptorSets(logicalDevice, binding_count, writes.data(), 0, VK_NULL_HANDLE);
+            }
+        }},
+        Method { "writer", [](const Resources& res, const DescriptorUpdateTemplate&, DescriptorWriter& batch, VkDevice)
+        {
+            for (size_t i = 0; i < res.sets.size(); ++i)
+            {
+                for (uint32_t binding = 0; binding < binding_count; ++binding)
+                    batch.writeBuffer(res.sets[i], binding, binding_types[binding], res.data[i].buffers[binding]);
+            }
+
+            batch.flush();
+        }},
+        Method { "template", [](const Resources& res, const DescriptorUpdateTemplate& update, DescriptorWriter&, VkDevice)
+        {
+            for (size_t i = 0; i < res.sets.size(); ++i)
+                update.update(res.sets[i], &res.data[i]);
+        }}
+    };
+
+    spdlog::info("Descriptor benchmark: {} sets of {} buffer descriptors, {} passes", setCount, binding_count, passes);
+
+    for (const auto& method : methods)
+    {
+//      the first pass warms the caches and the allocations of the writer, it is not timed
+        method.run(resources, updateTemplate, writer, device);
+
+        std::vector<double> times;
+
+        for (uint32_t pass = 0; pass < passes; ++pass)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            method.run(resources, updateTemplate, writer, device);
+            times.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        std::sort(times.begin(), times.end());
+
+        const double median = times[times.size() / 2];
+
+        spdlog::info("Descriptor benchmark: {:<12} {:9.1f} us median, {:9.1f} us best, {:7.1f} ns per set, {:7.1f} ns per descriptor",
+                     method.name, median, times.front(), 1000.0 * median / setCount, 1000.0 * median / (setCount * binding_count));
+    }
+
+    updateTemplate.destroy();
+    destroy(resources, device);
+    context.destroy();
+
+    return EXIT_SUCCESS;
+}
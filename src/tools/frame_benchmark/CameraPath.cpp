@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "spdlog/spdlog.h"
+
+#include "CameraPath.hpp"
+
+
+bool CameraPath::loadFromFile(const std::filesystem::path& path) noexcept
+{
+    std::ifstream file(path);
+
+    if (!file)
+    {
+        spdlog::error("Camera path: failed to open {}", path.string());
+
+        return false;
+    }
+
+    keys.clear();
+
+    std::string line;
+    uint32_t lineNumber = 0;
+
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+
+        line = line.substr(0, line.find('#'));
+
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        std::istringstream stream(line);
+        Key key;
+
+        if (!(stream >> key.time >> key.position[0] >> key.position[1] >> key.position[2] >> key.yaw >> key.pitch))
+        {
+            spdlog::error("Camera path: {}:{} is not \"time x y z yaw pitch\"", path.string(), lineNumber);
+
+            return false;
+        }
+
+        if (!keys.empty() && key.time <= keys.back().time)
+        {
+            spdlog::error("Camera path: {}:{} the time does not follow the previous key", path.string(), lineNumber);
+
+            return false;
+        }
+
+        keys.push_back(key);
+    }
+
+    if (keys.empty())
+    {
+        spdlog::error("Camera path: {} has no keys", path.string());
+
+        return false;
+    }
+
+    return true;
+}
+
+
+void CameraPath::setDefault() noexcept
+{
+//  the grid of cubes lies in front of the start pose, along -z
+    keys =
+    {
+        Key {  0.f, {  0.f,  0.f,   3.f }, -90.f,   0.f },
+        Key {  4.f, {  0.f,  2.f, -10.f }, -90.f, -10.f },
+        Key {  8.f, {  8.f,  4.f, -30.f }, -60.f, -15.f },
+        Key { 12.f, { -8.f, -2.f, -40.f }, -120.f, 10.f },
+        Key { 16.f, {  0.f,  0.f,   3.f }, -90.f,   0.f }
+    };
+}
+
+
+CameraPath::Key CameraPath::sample(float time) const noexcept
+{
+    if (keys.size() < 2)
+        return keys.empty() ? Key {} : keys.front();
+
+    const float duration = keys.back().time - keys.front().time;
+    time = keys.front().time + std::fmod(std::max(time, 0.f), duration);
+
+//  the first key past the time, the pose lies between it and the key before
+    const auto next = std::upper_bound(keys.begin() + 1, keys.end() - 1, time, [](float t, const Key& key) { return t < key.time; });
+    const auto& a = *(next - 1);
+    const auto& b = *next;
+
+    const float t = std::clamp((time - a.time) / (b.time - a.time), 0.f, 1.f);
+    const auto lerp = [t](float from, float to) { return from + (to - from) * t; };
+
+    return
+    {
+        .time     = time,
+        .position = { lerp(a.position[0], b.position[0]), lerp(a.position[1], b.position[1]), lerp(a.position[2], b.position[2]) },
+        .yaw      = lerp(a.yaw, b.yaw),
+        .pitch    = lerp(a.pitch, b.pitch)
+    };
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+
+// Key frames of the camera replayed by the frame benchmark. The pose between two keys is interpolated linearly,
+// the path starts over once its last key has been passed.
+struct CameraPath
+{
+    struct Key
+    {
+        float time;        // seconds from the start of the path
+        float position[3];
+        float yaw;         // degrees
+        float pitch;       // degrees
+    };
+
+//  One key per line: time x y z yaw pitch, the keys in ascending time, '#' starts a comment
+    bool loadFromFile(const std::filesystem::path& path) noexcept;
+    void setDefault() noexcept; // a fly through the cube grid and back to the start pose of the camera
+    Key sample(float time) const noexcept;
+
+    std::vector<Key> keys;
+};
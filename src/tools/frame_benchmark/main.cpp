@@ -0,0 +1,545 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "VulkanApi.hpp"
+#include "CameraPath.hpp"
+
+
+// Frame benchmark.
+// Renders the scene of the main app into an offscreen view, no window and no present, so it runs headless on any
+// device including lavapipe. The camera replays a path at a fixed timestep, every run draws the same frames whatever
+// the frame rate. The warm-up frames are drawn at the start of the path and are not measured.
+// Reported as JSON, every time in milliseconds:
+//  frame_time  - wall time of the whole drawFrame call, the fence wait included
+//  cpu_time    - the work of the engine in the frame, from the end of the fence wait to the end of drawFrame
+//  record_time - the part of cpu_time spent recording the draws, the part --threads spreads over the recording threads
+//  gpu_time    - timestamps around the command buffer, absent when the queue has no timestamps
+//  gpu_scopes  - every scope of the GPU profiler, by name
+//  pipeline_statistics - per frame averages of the rendering, --pipeline-statistics on a device which supports them
+//  draw_calls  - per frame
+//  memory      - device memory of the allocator, peak over the run and at its end
+// The engine log goes to logs/log.txt, stdout only gets the JSON. --cpu-trace writes the CPU scopes of the engine as
+// Chrome trace JSON, they are only recorded by a build with VULKAN_API_CPU_PROFILER.
+// --sweep runs the benchmark once per value of an option, each run in its own process so every one starts with a new
+// engine, and reports the averages of every run next to their ratio to the first run, e.g. --sweep draw-path 0,1,2
+// compares the instanced draw with the draws per cube on the same path and --sweep threads 0,1,2,4,8 gives the scaling
+// of the recording. --shading replaces the fragment shader with benchmark_shading.frag, --sweep shading-variant
+// specialized,generic compares its pipeline with the parameters as specialization constants against the one reading them
+// from the uniform buffer, the difference is in gpu_time.
+//
+// Usage: frame_benchmark [--frames N] [--warmup N] [--timestep seconds] [--size WxH] [--path file] [--instances N]
+//                        [--draw-path 0|1|2] [--threads N] [--frames-in-flight N] [--no-bindless] [--textures dir]
+//                        [--pipeline-statistics] [--gpu-log file.csv] [--cpu-trace file.json] [--output file.json]
+//                        [--save-frame file] [--shading iterations] [--shading-detail] [--shading-variant specialized|generic]
+//                        [--sweep option value,value,...]
+
+
+struct Options
+{
+    uint32_t    frames         = 1000;
+    uint32_t    warmup         = 100;
+    float       timestep       = 1.f / 60.f;
+    uint32_t    width          = 1280;
+    uint32_t    height         = 720;
+    uint32_t    instances      = 0;  // 0 - the default of the engine
+    uint32_t    drawPath       = 0;
+    uint32_t    threads        = 0;
+    uint32_t    framesInFlight = 0;  // 0 - the default of the engine
+    uint32_t    shading        = 0;  // iterations of the shading benchmark, 0 - the shader of the scene
+    bool        shadingDetail  = false;
+    bool        specialized    = true;
+    bool        bindless       = true;
+    bool        statistics     = false;
+    std::string path;                // empty - CameraPath::setDefault()
+    std::string textures;
+    std::string output;              // empty - stdout
+    std::string saveFrame;
+    std::string gpuLog;
+    std::string cpuTrace;
+    std::string sweep;               // an option without its dashes, empty - a single run
+    std::string sweepValues;         // comma separated
+};
+
+
+struct Summary
+{
+    double avg = 0.0;
+    double min = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+
+static bool parse_options(int argc, char* argv[], Options& options) noexcept
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view name = argv[i];
+
+        if (name == "--no-bindless")
+        {
+            options.bindless = false;
+
+            continue;
+        }
+
+        if (name == "--pipeline-statistics")
+        {
+            options.statistics = true;
+
+            continue;
+        }
+
+        if (name == "--shading-detail")
+        {
+            options.shadingDetail = true;
+
+            continue;
+        }
+
+        if (name == "--sweep")
+        {
+            if (i + 2 >= argc)
+                return false;
+
+            options.sweep       = argv[i + 1];
+            options.sweepValues = argv[i + 2];
+            i += 2;
+
+            continue;
+        }
+
+        if (i + 1 == argc)
+            return false;
+
+        const char* value = argv[++i];
+        char* end = nullptr;
+
+        const auto number = [&value, &end]() { return static_cast<uint32_t>(std::strtoul(value, &end, 10)); };
+
+        if      (name == "--frames")           options.frames         = number();
+        else if (name == "--warmup")           options.warmup         = number();
+        else if (name == "--instances")        options.instances      = number();
+        else if (name == "--draw-path")        options.drawPath       = number();
+        else if (name == "--threads")          options.threads        = number();
+        else if (name == "--frames-in-flight") options.framesInFlight = number();
+        else if (name == "--shading")          options.shading        = number();
+        else if (name == "--timestep")         options.timestep       = std::strtof(value, &end);
+        else if (name == "--path")             options.path           = value;
+        else if (name == "--textures")         options.textures       = value;
+        else if (name == "--output")           options.output         = value;
+        else if (name == "--save-frame")       options.saveFrame      = value;
+        else if (name == "--gpu-log")          options.gpuLog         = value;
+        else if (name == "--cpu-trace")        options.cpuTrace       = value;
+        else if (name == "--shading-variant")
+        {
+            if (std::string_view(value) != "specialized" && std::string_view(value) != "generic")
+                return false;
+
+            options.specialized = std::string_view(value) == "specialized";
+        }
+        else if (name == "--size")
+        {
+            options.width = static_cast<uint32_t>(std::strtoul(value, &end, 10));
+
+            if (*end != 'x')
+                return false;
+
+            options.height = static_cast<uint32_t>(std::strtoul(end + 1, &end, 10));
+        }
+        else
+        {
+            return false;
+        }
+
+//      the numbers must take the whole value
+        if (end && *end != '\0')
+            return false;
+    }
+
+    return options.frames > 0 && options.timestep > 0.f && options.width > 0 && options.height > 0 &&
+           (options.sweep.empty() || (options.sweep != "sweep" && options.sweep != "output" && !options.sweepValues.empty()));
+}
+
+
+// nearest rank percentiles, sorts the samples
+static Summary summarize(std::vector<double>& samples) noexcept
+{
+    if (samples.empty())
+        return {};
+
+    std::sort(samples.begin(), samples.end());
+
+    const auto percentile = [&samples](double p)
+    {
+        const size_t rank = static_cast<size_t>(p * static_cast<double>(samples.size()) + 0.5);
+
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    };
+
+    return
+    {
+        .avg = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size()),
+        .min = samples.front(),
+        .p50 = percentile(0.50),
+        .p95 = percentile(0.95),
+        .p99 = percentile(0.99),
+        .max = samples.back()
+    };
+}
+
+
+static void print_summary(FILE* file, const char* name, const Summary& summary, const char* indent = "    ", bool last = false) noexcept
+{
+    std::fprintf(file, "%s\"%s\": { \"avg\": %.4f, \"min\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+                 indent, name, summary.avg, summary.min, summary.p50, summary.p95, summary.p99, summary.max, last ? "" : ",");
+}
+
+
+// the number after key in the JSON written by a run, 0 - absent
+static double read_number(const std::string& json, const std::string& key) noexcept
+{
+    const size_t position = json.find(key);
+
+    return (position == std::string::npos) ? 0.0 : std::strtod(json.c_str() + position + key.size(), nullptr);
+}
+
+
+// Runs this executable with the arguments of the sweep replaced by one of its values, the JSON of every run is read back
+// from a temporary file
+static bool run_sweep(int argc, char* argv[], const Options& options) noexcept
+{
+    struct Run
+    {
+        std::string value;
+        std::string json;
+        double      framesPerSecond;
+        double      frameTime;
+        double      cpuTime;
+        double      recordTime;
+        double      gpuTime;
+    };
+
+    std::string command = std::string("\"") + argv[0] + '"';
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view name = argv[i];
+
+        if (name == "--sweep")
+            i += 2;
+        else if (name == "--output" || name == "--" + options.sweep)
+            i += 1;
+        else
+            command += std::string(" \"") + argv[i] + '"';
+    }
+
+    std::vector<Run> runs;
+    std::stringstream values(options.sweepValues);
+    std::error_code error;
+
+    for (std::string value; std::getline(values, value, ',');)
+    {
+        const auto output = std::filesystem::temp_directory_path(error) / ("frame_benchmark_sweep_" + std::to_string(runs.size()) + ".json");
+
+        std::string run = command + " --" + options.sweep + " \"" + value + "\" --output \"" + output.string() + '"';
+
+#ifdef _WIN32
+//      cmd strips the outer quotes of a line starting with one
+        run = '"' + run + '"';
+#endif
+
+        if (std::system(run.c_str()) != 0)
+        {
+            spdlog::error("Frame benchmark: the run with --{} {} failed", options.sweep, value);
+
+            return false;
+        }
+
+        std::ifstream file(output);
+        std::stringstream json;
+        json << file.rdbuf();
+        file.close();
+        std::filesystem::remove(output, error);
+
+        const std::string text = json.str();
+
+        runs.push_back({ value,
+                         text,
+                         read_number(text, "\"frames_per_second\": "),
+                         read_number(text, "\"frame_time\": { \"avg\": "),
+                         read_number(text, "\"cpu_time\": { \"avg\": "),
+                         read_number(text, "\"record_time\": { \"avg\": "),
+                         read_number(text, "\"gpu_time\": { \"avg\": ") });
+    }
+
+    FILE* file = options.output.empty() ? stdout : std::fopen(options.output.c_str(), "w");
+
+    if (!file)
+    {
+        spdlog::error("Frame benchmark: failed to open {}", options.output);
+
+        return false;
+    }
+
+    const auto ratio = [](double value, double first) { return (first > 0.0) ? value / first : 0.0; };
+
+    std::fprintf(file, "{\n");
+    std::fprintf(file, "    \"sweep\": \"%s\",\n", options.sweep.c_str());
+    std::fprintf(file, "    \"runs\": [\n");
+
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        const Run& run = runs[i];
+        std::string result = run.json;
+
+//      nested one level deeper
+        for (size_t position = result.find('\n'); position != std::string::npos && position + 1 < result.size(); position = result.find('\n', position + 1))
+            result.insert(position + 1, "            ");
+
+        while (!result.empty() && (result.back() == '\n' || result.back() == ' '))
+            result.pop_back();
+
+        std::fprintf(file, "        {\n");
+        std::fprintf(file, "            \"value\": \"%s\",\n", run.value.c_str());
+        std::fprintf(file, "            \"frames_per_second\": %.2f,\n", run.framesPerSecond);
+        std::fprintf(file, "            \"frame_time\": %.4f,\n", run.frameTime);
+        std::fprintf(file, "            \"cpu_time\": %.4f,\n", run.cpuTime);
+        std::fprintf(file, "            \"record_time\": %.4f,\n", run.recordTime);
+        std::fprintf(file, "            \"gpu_time\": %.4f,\n", run.gpuTime);
+        std::fprintf(file, "            \"relative\": { \"frame_time\": %.3f, \"cpu_time\": %.3f, \"record_time\": %.3f, \"gpu_time\": %.3f },\n",
+                     ratio(run.frameTime, runs[0].frameTime), ratio(run.cpuTime, runs[0].cpuTime), ratio(run.recordTime, runs[0].recordTime),
+                     ratio(run.gpuTime, runs[0].gpuTime));
+        std::fprintf(file, "            \"result\": %s\n", result.c_str());
+        std::fprintf(file, "        }%s\n", (i + 1 == runs.size()) ? "" : ",");
+    }
+
+    std::fprintf(file, "    ]\n");
+    std::fprintf(file, "}\n");
+
+    if (file != stdout)
+        std::fclose(file);
+
+    return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+    Options options;
+
+    if (!parse_options(argc, argv, options))
+    {
+        spdlog::error("Usage: frame_benchmark [--frames N] [--warmup N] [--timestep seconds] [--size WxH] [--path file] [--instances N] "
+                      "[--draw-path 0|1|2] [--threads N] [--frames-in-flight N] [--no-bindless] [--textures dir] [--pipeline-statistics] [--gpu-log file.csv] "
+                      "[--cpu-trace file.json] [--output file.json] [--save-frame file] [--shading iterations] [--shading-detail] "
+                      "[--shading-variant specialized|generic] [--sweep option value,value,...]");
+
+        return EXIT_FAILURE;
+    }
+
+    if (!options.sweep.empty())
+        return run_sweep(argc, argv, options) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    CameraPath cameraPath;
+
+    if (options.path.empty())
+        cameraPath.setDefault();
+    else if (!cameraPath.loadFromFile(options.path))
+        return EXIT_FAILURE;
+
+    VulkanApi api;
+
+    if (!api.init() || !api.createContext(true))
+    {
+        spdlog::error("Frame benchmark: failed to create the vulkan context");
+
+        return EXIT_FAILURE;
+    }
+
+    if (options.framesInFlight)
+        api.setFramesInFlight(options.framesInFlight);
+
+    if (options.instances)
+        api.setInstanceCount(options.instances);
+
+    if (!options.textures.empty())
+        api.setTextureDirectory(options.textures.c_str());
+
+    api.setRecordingThreads(options.threads);
+    api.setDrawPath(options.drawPath);
+    api.setBindlessTextures(options.bindless);
+    api.setPipelineStatistics(options.statistics);
+
+    if (options.shading)
+        api.setShadingBenchmark(options.shading, options.shadingDetail, options.specialized);
+
+    if (!options.gpuLog.empty() && !api.setGpuProfilerLog(options.gpuLog.c_str()))
+        return EXIT_FAILURE;
+
+    if (!api.createOffscreenView(options.width, options.height))
+    {
+        spdlog::error("Frame benchmark: failed to create the {}x{} offscreen view", options.width, options.height);
+
+        return EXIT_FAILURE;
+    }
+
+    const auto placeCamera = [&api, &cameraPath](float time)
+    {
+        const auto key = cameraPath.sample(time);
+
+        api.setCamera(key.position[0], key.position[1], key.position[2], key.yaw, key.pitch);
+    };
+
+    for (uint32_t i = 0; i < options.warmup; ++i)
+    {
+        placeCamera(0.f);
+        api.drawFrame();
+    }
+
+    std::vector<double> frameTimes;
+    std::vector<double> cpuTimes;
+    std::vector<double> recordTimes;
+    std::vector<double> gpuTimes;
+    uint64_t drawCalls = 0;
+    uint64_t peakMemory = 0;
+
+    struct GpuScope
+    {
+        std::string         name;
+        std::vector<double> times;
+    };
+
+    std::vector<GpuScope> gpuScopes;
+    GpuPipelineStatistics pipelineStatistics = {};
+    uint32_t              statisticsFrames   = 0;
+
+    frameTimes.reserve(options.frames);
+    cpuTimes.reserve(options.frames);
+    recordTimes.reserve(options.frames);
+    gpuTimes.reserve(options.frames);
+
+    const auto runStart = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < options.frames; ++i)
+    {
+        placeCamera(static_cast<float>(i) * options.timestep);
+
+        const auto frameStart = std::chrono::steady_clock::now();
+        api.drawFrame();
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+
+        const auto statistics = api.getFrameStatistics();
+
+        cpuTimes.push_back(statistics.cpuTime);
+        recordTimes.push_back(statistics.recordTime);
+        drawCalls += statistics.drawCalls;
+        peakMemory = std::max(peakMemory, statistics.memoryReserved);
+
+//      the timestamps of a frame are read back when its frame in flight comes around again, 0 until then
+        if (statistics.gpuTime > 0.0)
+            gpuTimes.push_back(statistics.gpuTime);
+
+        for (const auto& timing : api.getGpuTimings())
+        {
+            auto scope = std::find_if(gpuScopes.begin(), gpuScopes.end(), [&timing](const GpuScope& s) { return s.name == timing.name; });
+
+            if (scope == gpuScopes.end())
+                scope = gpuScopes.insert(gpuScopes.end(), { timing.name, {} });
+
+            scope->times.push_back(timing.time);
+        }
+
+        if (const auto counters = api.getPipelineStatistics(); counters.vertexInvocations)
+        {
+            pipelineStatistics.inputPrimitives     += counters.inputPrimitives;
+            pipelineStatistics.vertexInvocations   += counters.vertexInvocations;
+            pipelineStatistics.fragmentInvocations += counters.fragmentInvocations;
+            statisticsFrames++;
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+    const auto last = api.getFrameStatistics();
+
+    if (!options.saveFrame.empty() && !api.saveFrame(options.saveFrame.c_str()))
+        spdlog::error("Frame benchmark: failed to save the last frame to {}", options.saveFrame);
+
+    if (!options.cpuTrace.empty() && !api.saveCpuTrace(options.cpuTrace.c_str()))
+        spdlog::error("Frame benchmark: failed to save the CPU trace to {}", options.cpuTrace);
+
+    FILE* file = options.output.empty() ? stdout : std::fopen(options.output.c_str(), "w");
+
+    if (!file)
+    {
+        spdlog::error("Frame benchmark: failed to open {}", options.output);
+
+        return EXIT_FAILURE;
+    }
+
+    std::fprintf(file, "{\n");
+    std::fprintf(file, "    \"frames\": %u,\n", options.frames);
+    std::fprintf(file, "    \"warmup\": %u,\n", options.warmup);
+    std::fprintf(file, "    \"timestep\": %.6f,\n", options.timestep);
+    std::fprintf(file, "    \"width\": %u,\n", options.width);
+    std::fprintf(file, "    \"height\": %u,\n", options.height);
+    std::fprintf(file, "    \"draw_path\": %u,\n", options.drawPath);
+    std::fprintf(file, "    \"recording_threads\": %u,\n", options.threads);
+    std::fprintf(file, "    \"bindless\": %s,\n", options.bindless ? "true" : "false");
+
+    if (options.shading)
+        std::fprintf(file, "    \"shading\": { \"iterations\": %u, \"detail\": %s, \"variant\": \"%s\" },\n",
+                     options.shading, options.shadingDetail ? "true" : "false", options.specialized ? "specialized" : "generic");
+
+    std::fprintf(file, "    \"frames_per_second\": %.2f,\n", static_cast<double>(options.frames) / seconds);
+
+    print_summary(file, "frame_time", summarize(frameTimes));
+    print_summary(file, "cpu_time", summarize(cpuTimes));
+    print_summary(file, "record_time", summarize(recordTimes));
+
+    if (!gpuTimes.empty())
+        print_summary(file, "gpu_time", summarize(gpuTimes));
+
+    if (!gpuScopes.empty())
+    {
+        std::fprintf(file, "    \"gpu_scopes\": {\n");
+
+        for (size_t i = 0; i < gpuScopes.size(); ++i)
+            print_summary(file, gpuScopes[i].name.c_str(), summarize(gpuScopes[i].times), "        ", i + 1 == gpuScopes.size());
+
+        std::fprintf(file, "    },\n");
+    }
+
+    if (statisticsFrames)
+    {
+        std::fprintf(file, "    \"pipeline_statistics\": { \"input_primitives\": %.1f, \"vertex_invocations\": %.1f, \"fragment_invocations\": %.1f },\n",
+                     static_cast<double>(pipelineStatistics.inputPrimitives) / statisticsFrames,
+                     static_cast<double>(pipelineStatistics.vertexInvocations) / statisticsFrames,
+                     static_cast<double>(pipelineStatistics.fragmentInvocations) / statisticsFrames);
+    }
+
+    std::fprintf(file, "    \"draw_calls\": %.1f,\n", static_cast<double>(drawCalls) / options.frames);
+    std::fprintf(file, "    \"memory\": { \"peak_reserved\": %llu, \"reserved\": %llu, \"allocated\": %llu }\n",
+                 static_cast<unsigned long long>(peakMemory),
+                 static_cast<unsigned long long>(last.memoryReserved),
+                 static_cast<unsigned long long>(last.memoryAllocated));
+    std::fprintf(file, "}\n");
+
+    if (file != stdout)
+        std::fclose(file);
+
+    return EXIT_SUCCESS;
+}
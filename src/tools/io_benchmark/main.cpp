@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "files/FileProvider.hpp"
+#include "files/MappedFile.hpp"
+
+
+// Asset I/O microbenchmark.
+// Loads every file of a directory into a staging sized buffer, once through stdio into a heap buffer (the former shader path)
+// and once from a memory mapping (MappedFile), and reports the time of both.
+// With --lookup it resolves file names with a recursive scan per lookup (the former FileProvider) and with the FileProvider index.
+// With --startup it times FileProvider opening the directory and reading every file, from <directory>.pack when it exists.
+//
+// Usage: io_benchmark <asset directory> [passes]
+//        io_benchmark --lookup <asset directory> [lookups]
+//        io_benchmark --startup <asset directory>
+//        io_benchmark --generate <directory> <file count> <file size in KiB>
+
+
+//  fseek/ftell/malloc/fread, then the copy into the staging memory
+static bool load_with_stdio(const std::filesystem::path& path, uint8_t* staging) noexcept
+{
+    FILE* file = fopen(path.string().c_str(), "rb");
+
+    if (!file)
+        return false;
+
+    fseek(file, 0, SEEK_END);
+    const size_t size = static_cast<size_t>(ftell(file));
+    fseek(file, 0, SEEK_SET);
+
+    std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[size]);
+    const bool read = buffer && fread(buffer.get(), 1, size, file) == size;
+    fclose(file);
+
+    if (read)
+        memcpy(staging, buffer.get(), size);
+
+    return read;
+}
+
+
+//  the copy into the staging memory reads the mapping directly
+static bool load_with_mapping(const std::filesystem::path& path, uint8_t* staging) noexcept
+{
+    MappedFile file;
+
+    if (!file.open(path))
+        return false;
+
+    const auto data = file.getData();
+    memcpy(staging, data.data(), data.size());
+
+    return true;
+}
+
+
+//  the former FileProvider::findPathToFile
+static std::filesystem::path scan_for_file(const std::filesystem::path& directory, const std::string& filename) noexcept
+{
+    std::error_code error;
+
+    for (const auto& file : std::filesystem::recursive_directory_iterator(directory, error))
+        if (file.path().filename() == filename)
+            return file.path();
+
+    return {};
+}
+
+
+static bool benchmark_lookups(const std::filesystem::path& directory, uint32_t lookups) noexcept
+{
+    std::vector<std::string> names;
+    std::error_code error;
+
+    for (const auto& file : std::filesystem::recursive_directory_iterator(directory, error))
+        if (file.is_regular_file() && file.path().filename() != "resources.manifest")
+            names.push_back(file.path().filename().string());
+
+    if (names.empty())
+    {
+        spdlog::error("I/O benchmark: no file in {}", directory.string());
+
+        return false;
+    }
+
+    using namespace std::chrono;
+
+//  a scan costs a walk of the whole tree, a handful is enough to time it
+    const uint32_t scans = std::min<uint32_t>(lookups, 16);
+    auto start = steady_clock::now();
+
+    for (uint32_t i = 0; i < scans; ++i)
+        if (scan_for_file(directory, names[(i * 7919) % names.size()]).empty())
+            return false;
+
+    const double scanTime = duration<double, std::micro>(steady_clock::now() - start).count() / scans;
+
+    FileProvider fileProvider(directory);
+
+    start = steady_clock::now();
+    fileProvider.findPathToFile(names.front());
+    const double indexTime = duration<double, std::milli>(steady_clock::now() - start).count();
+
+    start = steady_clock::now();
+
+    for (uint32_t i = 0; i < lookups; ++i)
+        if (fileProvider.findPathToFile(names[(i * 7919) % names.size()]).empty())
+            return false;
+
+    const double lookupTime = duration<double, std::micro>(steady_clock::now() - start).count() / lookups;
+
+    spdlog::info("I/O benchmark: {} files, scan {:.3f} us per lookup, index built in {:.3f} ms then {:.3f} us per lookup",
+                 names.size(), scanTime, indexTime, lookupTime);
+
+    return true;
+}
+
+
+static bool benchmark_startup(const std::filesystem::path& directory) noexcept
+{
+    std::vector<std::string> virtualPaths;
+    std::error_code error;
+
+    for (const auto& file : std::filesystem::recursive_directory_iterator(directory, error))
+        if (file.is_regular_file() && file.file_size() > 0 && file.path().filename() != "resources.manifest")
+            virtualPaths.push_back(file.path().lexically_relative(directory).generic_string());
+
+    using namespace std::chrono;
+
+    const auto start = steady_clock::now();
+
+    FileProvider fileProvider(directory);
+
+    size_t bytes = 0;
+    uint32_t checksum = 0;
+
+    for (const auto& virtualPath : virtualPaths)
+    {
+        FileData file;
+
+        if (!fileProvider.readFile(fileProvider.findPathToFile(virtualPath), &file))
+        {
+            spdlog::error("I/O benchmark: failed to read {}", virtualPath);
+
+            return false;
+        }
+
+//      the data has to be touched, a mapping alone reads nothing
+        for (size_t i = 0; i < file.data.size(); i += 4096)
+            checksum += file.data[i];
+
+        bytes += file.data.size();
+    }
+
+    std::filesystem::path pack = directory;
+    pack += ".pack";
+
+    spdlog::info("I/O benchmark: {} files, {:.2f} MiB read from {} in {:.3f} ms (checksum {})",
+                 virtualPaths.size(), bytes / (1024.0 * 1024.0), std::filesystem::exists(pack) ? "the pack" : "loose files",
+                 duration<double, std::milli>(steady_clock::now() - start).count(), checksum);
+
+    return true;
+}
+
+
+static bool generate(const std::filesystem::path& directory, uint32_t count, size_t size) noexcept
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    std::vector<uint8_t> content(size);
+
+    for (size_t i = 0; i < size; ++i)
+        content[i] = static_cast<uint8_t>(i * 2654435761u >> 24);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        FILE* file = fopen((directory / ("asset_" + std::to_string(i) + ".bin")).string().c_str(), "wb");
+
+        if (!file)
+            return false;
+
+        const bool written = fwrite(content.data(), 1, size, file) == size;
+        fclose(file);
+
+        if (!written)
+            return false;
+    }
+
+    spdlog::info("I/O benchmark: generated {} files of {} KiB in {}", count, size / 1024, directory.string());
+
+    return true;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    if (argc == 5 && std::string(argv[1]) == "--generate")
+        return generate(argv[2], static_cast<uint32_t>(std::stoul(argv[3])), std::stoul(argv[4]) * 1024) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    if (argc >= 3 && std::string(argv[1]) == "--lookup")
+        return benchmark_lookups(argv[2], (argc > 3) ? static_cast<uint32_t>(std::stoul(argv[3])) : 1000000) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    if (argc == 3 && std::string(argv[1]) == "--startup")
+        return benchmark_startup(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    if (argc < 2)
+    {
+        spdlog::error("Usage: io_benchmark <asset directory> [passes] | --lookup <asset directory> [lookups] | --startup <asset directory> | --generate <directory> <file count> <file size in KiB>");
+
+        return EXIT_FAILURE;
+    }
+
+    const uint32_t passes = (argc > 2) ? static_cast<uint32_t>(std::stoul(argv[2])) : 5;
+
+    std::vector<std::filesystem::path> files;
+    size_t largest = 0;
+    size_t total   = 0;
+
+    std::error_code error;
+
+    for (const auto& file : std::filesystem::recursive_directory_iterator(argv[1], error))
+    {
+        if (file.is_regular_file() && file.file_size() > 0)
+        {
+            files.push_back(file.path());
+            largest = std::max<size_t>(largest, file.file_size());
+            total  += file.file_size();
+        }
+    }
+
+    if (files.empty())
+    {
+        spdlog::error("I/O benchmark: no file in {}", argv[1]);
+
+        return EXIT_FAILURE;
+    }
+
+    std::vector<uint8_t> staging(largest);
+
+    using Loader = bool (*)(const std::filesystem::path&, uint8_t*) noexcept;
+
+    const std::pair<const char*, Loader> loaders[] =
+    {
+        { "stdio + heap", load_with_stdio },
+        { "mmap",         load_with_mapping }
+    };
+
+//  one untimed pass so both loaders read from a warm page cache
+    for (const auto& path : files)
+        load_with_stdio(path, staging.data());
+
+    spdlog::info("I/O benchmark: {} files, {:.2f} MiB, {} passes", files.size(), total / (1024.0 * 1024.0), passes);
+
+    for (const auto& [name, loader] : loaders)
+    {
+        double best = 0;
+
+        for (uint32_t pass = 0; pass < passes; ++pass)
+        {
+            const auto start = std::chrono::steady_clock::now();
+
+            for (const auto& path : files)
+                if (!loader(path, staging.data()))
+                    spdlog::error("I/O benchmark: {} failed to load {}", name, path.string());
+
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            best = (pass == 0) ? seconds : std::min(best, seconds);
+        }
+
+        spdlog::info("I/O benchmark: {:<12} {:8.3f} ms, {:8.3f} us per file, {:8.1f} MiB/s",
+                     name, best * 1e3, best * 1e6 / files.size(), total / (1024.0 * 1024.0) / best);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "BlockEncoder.hpp"
+
+
+//  Mean and dominant direction of the first channelCount channels, found with a few power iterations on the covariance
+static void find_principal_axis(const uint8_t texels[64], int channelCount, float mean[4], float axis[4]) noexcept
+{
+    for (int c = 0; c < 4; ++c)
+    {
+        mean[c] = 0.f;
+
+        for (int i = 0; i < 16; ++i)
+            mean[c] += texels[i * 4 + c];
+
+        mean[c] /= 16.f;
+    }
+
+    float covariance[4][4] = {};
+
+    for (int i = 0; i < 16; ++i)
+        for (int a = 0; a < channelCount; ++a)
+            for (int b = 0; b < channelCount; ++b)
+                covariance[a][b] += (texels[i * 4 + a] - mean[a]) * (texels[i * 4 + b] - mean[b]);
+
+    for (int c = 0; c < 4; ++c)
+        axis[c] = (c < channelCount) ? 1.f : 0.f;
+
+    for (int iteration = 0; iteration < 8; ++iteration)
+    {
+        float next[4] = {};
+        float length  = 0.f;
+
+        for (int a = 0; a < channelCount; ++a)
+        {
+            for (int b = 0; b < channelCount; ++b)
+                next[a] += covariance[a][b] * axis[b];
+
+            length += next[a] * next[a];
+        }
+
+//      a flat block, any direction does
+        if (length < 1e-6f)
+            return;
+
+        length = std::sqrt(length);
+
+        for (int c = 0; c < channelCount; ++c)
+            axis[c] = next[c] / length;
+    }
+}
+
+
+//  Texels with the smallest and the largest projection on the axis give the endpoints
+static void find_endpoints(const uint8_t texels[64], const float mean[4], const float axis[4], float low[4], float high[4]) noexcept
+{
+    float minT = 0.f;
+    float maxT = 0.f;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        float t = 0.f;
+
+        for (int c = 0; c < 4; ++c)
+            t += (texels[i * 4 + c] - mean[c]) * axis[c];
+
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+
+    for (int c = 0; c < 4; ++c)
+    {
+        low[c]  = std::clamp(mean[c] + axis[c] * minT, 0.f, 255.f);
+        high[c] = std::clamp(mean[c] + axis[c] * maxT, 0.f, 255.f);
+    }
+}
+
+
+static int squared_distance(const uint8_t* texel, const int color[4], int channelCount) noexcept
+{
+    int distance = 0;
+
+    for (int c = 0; c < channelCount; ++c)
+        distance += (texel[c] - color[c]) * (texel[c] - color[c]);
+
+    return distance;
+}
+
+
+static uint16_t pack_rgb565(const float color[4]) noexcept
+{
+    const int r = static_cast<int>(color[0] * 31.f / 255.f + 0.5f);
+    const int g = static_cast<int>(color[1] * 63.f / 255.f + 0.5f);
+    const int b = static_cast<int>(color[2] * 31.f / 255.f + 0.5f);
+
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+
+static void unpack_rgb565(uint16_t packed, int color[4]) noexcept
+{
+    const int r = (packed >> 11) & 31;
+    const int g = (packed >> 5) & 63;
+    const int b = packed & 31;
+
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+    color[3] = 255;
+}
+
+
+void encode_bc1_block(const uint8_t texels[64], uint8_t block[8]) noexcept
+{
+    float mean[4], axis[4], low[4], high[4];
+
+    find_principal_axis(texels, 3, mean, axis);
+    find_endpoints(texels, mean, axis, low, high);
+
+    uint16_t color0 = pack_rgb565(high);
+    uint16_t color1 = pack_rgb565(low);
+
+//  the four color mode needs color0 > color1, equal endpoints only use index 0
+    if (color0 < color1)
+        std::swap(color0, color1);
+
+    int palette[4][4];
+    unpack_rgb565(color0, palette[0]);
+    unpack_rgb565(color1, palette[1]);
+
+    for (int c = 0; c < 3; ++c)
+    {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    uint32_t indices = 0;
+
+    if (color0 != color1)
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            int best = 0;
+            int bestDistance = squared_distance(&texels[i * 4], palette[0], 3);
+
+            for (int p = 1; p < 4; ++p)
+            {
+                if (const int distance = squared_distance(&texels[i * 4], palette[p], 3); distance < bestDistance)
+                {
+                    best = p;
+                    bestDistance = distance;
+                }
+            }
+
+            indices |= uint32_t(best) << (i * 2);
+        }
+    }
+
+    block[0] = static_cast<uint8_t>(color0);
+    block[1] = static_cast<uint8_t>(color0 >> 8);
+    block[2] = static_cast<uint8_t>(color1);
+    block[3] = static_cast<uint8_t>(color1 >> 8);
+
+    for (int i = 0; i < 4; ++i)
+        block[4 + i] = static_cast<uint8_t>(indices >> (i * 8));
+}
+
+
+//  Writes the low bitCount bits of value at bit position, the block is little endian
+static void write_bits(uint8_t block[16], uint32_t& position, uint32_t value, uint32_t bitCount) noexcept
+{
+    for (uint32_t i = 0; i < bitCount; ++i, ++position)
+        block[position / 8] |= static_cast<uint8_t>(((value >> i) & 1) << (position % 8));
+}
+
+
+//  Mode 6 endpoints are 7 bits per channel plus a parity bit shared by the channels, the parity giving the smaller error wins
+static void quantize_bc7_endpoint(const float endpoint[4], int quantized[4], int* parity) noexcept
+{
+    float bestError = -1.f;
+
+    for (int p = 0; p < 2; ++p)
+    {
+        int candidate[4];
+        float error = 0.f;
+
+        for (int c = 0; c < 4; ++c)
+        {
+            candidate[c] = std::clamp(static_cast<int>(std::lround((endpoint[c] - p) / 2.f)), 0, 127);
+
+            const float delta = endpoint[c] - float((candidate[c] << 1) | p);
+            error += delta * delta;
+        }
+
+        if (bestError < 0.f || error < bestError)
+        {
+            bestError = error;
+            std::copy(candidate, candidate + 4, quantized);
+            *parity = p;
+        }
+    }
+}
+
+
+void encode_bc7_block(const uint8_t texels[64], uint8_t block[16]) noexcept
+{
+    constexpr int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    float mean[4], axis[4], low[4], high[4];
+
+    find_principal_axis(texels, 4, mean, axis);
+    find_endpoints(texels, mean, axis, low, high);
+
+    int quantized[2][4];
+    int parity[2];
+
+    quantize_bc7_endpoint(low, quantized[0], &parity[0]);
+    quantize_bc7_endpoint(high, quantized[1], &parity[1]);
+
+    int endpoints[2][4];
+
+    for (int e = 0; e < 2; ++e)
+        for (int c = 0; c < 4; ++c)
+            endpoints[e][c] = (quantized[e][c] << 1) | parity[e];
+
+    int palette[16][4];
+
+    for (int w = 0; w < 16; ++w)
+        for (int c = 0; c < 4; ++c)
+            palette[w][c] = ((64 - weights[w]) * endpoints[0][c] + weights[w] * endpoints[1][c] + 32) >> 6;
+
+    int indices[16];
+
+    for (int i = 0; i < 16; ++i)
+    {
+        int best = 0;
+        int bestDistance = squared_distance(&texels[i * 4], palette[0], 4);
+
+        for (int w = 1; w < 16; ++w)
+        {
+            if (const int distance = squared_distance(&texels[i * 4], palette[w], 4); distance < bestDistance)
+            {
+                best = w;
+                bestDistance = distance;
+            }
+        }
+
+        indices[i] = best;
+    }
+
+//  the most significant bit of the first index is implicit zero, swapping the endpoints flips the indices
+    if (indices[0] & 8)
+    {
+        std::swap(quantized[0], quantized[1]);
+        std::swap(parity[0], parity[1]);
+
+        for (int& index : indices)
+            index = 15 - index;
+    }
+
+    memset(block, 0, 16);
+
+    uint32_t position = 0;
+    write_bits(block, position, 1u << 6, 7);
+
+    for (int c = 0; c < 4; ++c)
+    {
+        write_bits(block, position, quantized[0][c], 7);
+        write_bits(block, position, quantized[1][c], 7);
+    }
+
+    write_bits(block, position, parity[0], 1);
+    write_bits(block, position, parity[1], 1);
+    write_bits(block, position, indices[0], 3);
+
+    for (int i = 1; i < 16; ++i)
+        write_bits(block, position, indices[i], 4);
+}
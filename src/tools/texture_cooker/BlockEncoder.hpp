@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+// Block compression of 4x4 RGBA8 texel blocks, texels are stored row after row.
+// Both encoders fit the endpoints along the principal axis of the block, they favour speed over the best quality.
+
+//  BC1 without the punch-through alpha, the alpha channel is ignored
+void encode_bc1_block(const uint8_t texels[64], uint8_t block[8]) noexcept;
+
+//  BC7 mode 6, a single subset with RGBA endpoints and 4 bit indices
+void encode_bc7_block(const uint8_t texels[64], uint8_t block[16]) noexcept;
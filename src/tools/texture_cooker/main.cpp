@@ -0,0 +1,412 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "files/CookedTexture.hpp"
+#include "files/MappedFile.hpp"
+#include "BlockEncoder.hpp"
+
+
+// Offline texture cooker.
+// Converts every image of a directory into a .ctex container (files/CookedTexture.hpp) holding a BC7, a BC1 and an RGBA8 payload,
+// each with its whole mip chain. The engine uploads the first payload the device samples without decoding anything.
+// With --compare it loads every cooked texture and its source image the way TextureStreamer does and reports the time
+// and memory of both paths.
+//
+// Usage: texture_cooker <source directory> <output directory>
+//        texture_cooker --compare <source directory> <cooked directory> [passes]
+
+
+struct Image
+{
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> texels; // RGBA8
+};
+
+
+//  Each texel averages a 2x2 block of the previous level, odd sizes clamp to the edge
+static Image downsample(const Image& src) noexcept
+{
+    Image dst = { std::max(src.width / 2, 1u), std::max(src.height / 2, 1u), {} };
+    dst.texels.resize(size_t(dst.width) * dst.height * 4);
+
+    for (uint32_t y = 0; y < dst.height; ++y)
+    {
+        const uint32_t y0 = std::min(2 * y, src.height - 1);
+        const uint32_t y1 = std::min(2 * y + 1, src.height - 1);
+
+        for (uint32_t x = 0; x < dst.width; ++x)
+        {
+            const uint32_t x0 = std::min(2 * x, src.width - 1);
+            const uint32_t x1 = std::min(2 * x + 1, src.width - 1);
+
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                const uint32_t sum = src.texels[(size_t(y0) * src.width + x0) * 4 + c] + src.texels[(size_t(y0) * src.width + x1) * 4 + c] +
+                                     src.texels[(size_t(y1) * src.width + x0) * 4 + c] + src.texels[(size_t(y1) * src.width + x1) * 4 + c];
+
+                dst.texels[(size_t(y) * dst.width + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+
+    return dst;
+}
+
+
+//  Appends the blocks of a level, the texels past the edge of levels smaller than a block repeat the last row and column
+template<size_t BlockSize>
+static void compress_level(const Image& level, void (*encode)(const uint8_t*, uint8_t*) noexcept, std::vector<uint8_t>& out) noexcept
+{
+    uint8_t texels[64];
+    uint8_t block[BlockSize];
+
+    for (uint32_t by = 0; by < level.height; by += 4)
+    {
+        for (uint32_t bx = 0; bx < level.width; bx += 4)
+        {
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                const uint32_t x = std::min(bx + i % 4, level.width - 1);
+                const uint32_t y = std::min(by + i / 4, level.height - 1);
+
+                memcpy(&texels[i * 4], &level.texels[(size_t(y) * level.width + x) * 4], 4);
+            }
+
+            encode(texels, block);
+            out.insert(out.end(), block, block + BlockSize);
+        }
+    }
+}
+
+
+static bool cook(const std::filesystem::path& source, const std::filesystem::path& destination) noexcept
+{
+    int width, height, channels;
+    stbi_uc* pixels = stbi_load(source.generic_string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+    if (!pixels)
+    {
+        spdlog::error("Texture cooker: failed to decode {}, {}", source.string(), stbi_failure_reason());
+
+        return false;
+    }
+
+    std::vector<Image> levels(1);
+    levels[0] = { static_cast<uint32_t>(width), static_cast<uint32_t>(height), std::vector<uint8_t>(pixels, pixels + size_t(width) * height * 4) };
+    stbi_image_free(pixels);
+
+    while (levels.back().width > 1 || levels.back().height > 1)
+        levels.push_back(downsample(levels.back()));
+
+//  ordered by preference, BC1 keeps only opaque images since it has no alpha channel here
+    bool opaque = true;
+
+    for (size_t i = 3; i < levels[0].texels.size() && opaque; i += 4)
+        opaque = levels[0].texels[i] == 255;
+
+    std::vector<VkFormat> formats = { VK_FORMAT_BC7_SRGB_BLOCK };
+
+    if (opaque)
+        formats.push_back(VK_FORMAT_BC1_RGB_SRGB_BLOCK);
+
+    formats.push_back(VK_FORMAT_R8G8B8A8_SRGB);
+
+    std::vector<std::vector<uint8_t>> payloadData(formats.size());
+
+    for (size_t p = 0; p < formats.size(); ++p)
+    {
+        for (const auto& level : levels)
+        {
+            switch (formats[p])
+            {
+                case VK_FORMAT_BC7_SRGB_BLOCK:
+                    compress_level<16>(level, encode_bc7_block, payloadData[p]);
+                    break;
+
+                case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                    compress_level<8>(level, encode_bc1_block, payloadData[p]);
+                    break;
+
+                default:
+                    payloadData[p].insert(payloadData[p].end(), level.texels.begin(), level.texels.end());
+                    break;
+            }
+        }
+    }
+
+    CookedTextureHeader header =
+    {
+        .magic        = {},
+        .version      = cooked_texture_version,
+        .width        = levels[0].width,
+        .height       = levels[0].height,
+        .levelCount   = static_cast<uint32_t>(levels.size()),
+        .payloadCount = static_cast<uint32_t>(formats.size())
+    };
+
+    memcpy(header.magic, cooked_texture_magic, sizeof(header.magic));
+
+    std::vector<CookedTexturePayload> payloads;
+    uint64_t offset = sizeof(CookedTextureHeader) + sizeof(CookedTexturePayload) * formats.size();
+
+    for (size_t p = 0; p < formats.size(); ++p)
+    {
+        payloads.push_back({ formats[p], 0, offset, payloadData[p].size() });
+        offset += payloadData[p].size();
+    }
+
+    FILE* file = fopen(destination.string().c_str(), "wb");
+
+    if (!file)
+    {
+        spdlog::error("Texture cooker: failed to create {}", destination.string());
+
+        return false;
+    }
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(payloads.data(), sizeof(CookedTexturePayload), payloads.size(), file) == payloads.size();
+
+    for (const auto& data : payloadData)
+        written = written && fwrite(data.data(), 1, data.size(), file) == data.size();
+
+    fclose(file);
+
+    if (!written)
+    {
+        spdlog::error("Texture cooker: failed to write {}", destination.string());
+        std::filesystem::remove(destination);
+
+        return false;
+    }
+
+    spdlog::info("Texture cooker: {} -> {} ({}x{}, {} levels, RGBA8 {} KiB, BC1 {} KiB, BC7 {} KiB)",
+                 source.filename().string(), destination.filename().string(), width, height, levels.size(),
+                 get_mip_chain_size(VK_FORMAT_R8G8B8A8_SRGB, header.width, header.height, header.levelCount) / 1024,
+                 opaque ? get_mip_chain_size(VK_FORMAT_BC1_RGB_SRGB_BLOCK, header.width, header.height, header.levelCount) / 1024 : 0,
+                 get_mip_chain_size(VK_FORMAT_BC7_SRGB_BLOCK, header.width, header.height, header.levelCount) / 1024);
+
+    return true;
+}
+
+
+static constexpr std::array<std::string_view, 5> source_extensions = { ".jpg", ".jpeg", ".png", ".bmp", ".tga" };
+
+
+//  stbi_load and the copy into Decoded::pixels, the runtime path of a source image
+static bool load_source(const std::filesystem::path& path, std::vector<uint8_t>& staging, bool cpuMips, Image* image) noexcept
+{
+    int width, height, channels;
+    stbi_uc* pixels = stbi_load(path.generic_string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+    if (!pixels)
+        return false;
+
+    image->width  = static_cast<uint32_t>(width);
+    image->height = static_cast<uint32_t>(height);
+    image->texels.assign(pixels, pixels + size_t(width) * height * 4);
+    stbi_image_free(pixels);
+
+//  the streamer builds the chain on the CPU when the device cannot blit RGBA8 with a linear filter
+    Image level;
+    const Image* previous = image;
+
+    while (cpuMips && (previous->width > 1 || previous->height > 1))
+    {
+        level = downsample(*previous);
+        image->texels.insert(image->texels.end(), level.texels.begin(), level.texels.end());
+        previous = &level;
+    }
+
+    staging.resize(std::max(staging.size(), image->texels.size()));
+    memcpy(staging.data(), image->texels.data(), image->texels.size());
+
+    return true;
+}
+
+
+//  the checks of CookedImage::loadFromFile and the copy of the first payload from the mapping into the staging memory
+static bool load_cooked(const std::filesystem::path& path, std::vector<uint8_t>& staging, CookedTexturePayload* chosen) noexcept
+{
+    MappedFile file;
+
+    if (!file.open(path))
+        return false;
+
+    const auto bytes = file.getData();
+    const auto* header = reinterpret_cast<const CookedTextureHeader*>(bytes.data());
+
+    if (bytes.size() < sizeof(CookedTextureHeader) + sizeof(CookedTexturePayload) ||
+        memcmp(header->magic, cooked_texture_magic, sizeof(header->magic)) != 0 ||
+        header->version != cooked_texture_version || header->payloadCount == 0)
+        return false;
+
+    const auto* payload = reinterpret_cast<const CookedTexturePayload*>(bytes.data() + sizeof(CookedTextureHeader));
+
+    if (payload->byteOffset > bytes.size() || payload->byteLength > bytes.size() - payload->byteOffset)
+        return false;
+
+    staging.resize(std::max<size_t>(staging.size(), payload->byteLength));
+    memcpy(staging.data(), bytes.data() + payload->byteOffset, payload->byteLength);
+    *chosen = *payload;
+
+    return true;
+}
+
+
+static bool compare(const std::filesystem::path& sourceDir, const std::filesystem::path& cookedDir, uint32_t passes) noexcept
+{
+    std::vector<std::pair<std::filesystem::path, std::filesystem::path>> textures;
+    std::error_code error;
+
+    for (const auto& file : std::filesystem::recursive_directory_iterator(sourceDir, error))
+    {
+        const std::string extension = file.path().extension().string();
+        const std::filesystem::path cooked = cookedDir / file.path().filename().replace_extension(".ctex");
+
+        if (file.is_regular_file() && std::find(source_extensions.begin(), source_extensions.end(), extension) != source_extensions.end() &&
+            std::filesystem::exists(cooked))
+            textures.emplace_back(file.path(), cooked);
+    }
+
+    if (textures.empty())
+    {
+        spdlog::error("Texture cooker: no source image of {} has a cooked texture in {}", sourceDir.string(), cookedDir.string());
+
+        return false;
+    }
+
+    struct Path
+    {
+        const char* name;
+        double      time        = 0; // ms, the best pass
+        uint64_t    fileBytes   = 0;
+        uint64_t    heapBytes   = 0; // largest heap memory held by a decoder thread, the stb buffer and Decoded::pixels
+        uint64_t    deviceBytes = 0; // texels of every mip level
+    };
+
+    Path paths[] = { { "source" }, { "source + mips" }, { "cooked" } };
+    std::vector<uint8_t> staging;
+
+    for (uint32_t pass = 0; pass <= passes; ++pass)
+    {
+        for (size_t p = 0; p < std::size(paths); ++p)
+        {
+            Path& path = paths[p];
+            const auto start = std::chrono::steady_clock::now();
+
+            for (const auto& [source, cooked] : textures)
+            {
+                Image image = {};
+                CookedTexturePayload payload = {};
+
+                if (p < 2 ? !load_source(source, staging, p == 1, &image) : !load_cooked(cooked, staging, &payload))
+                {
+                    spdlog::error("Texture cooker: failed to load {}", (p < 2 ? source : cooked).string());
+
+                    return false;
+                }
+
+//              the sizes are the same every pass
+                if (pass == 0)
+                {
+                    const uint32_t levelCount = 32 - static_cast<uint32_t>(std::countl_zero(std::max(image.width, image.height) | 1u));
+
+                    path.fileBytes   += std::filesystem::file_size(p < 2 ? source : cooked, error);
+                    path.heapBytes    = std::max<uint64_t>(path.heapBytes, p < 2 ? uint64_t(image.width) * image.height * 4 + image.texels.size() : 0);
+                    path.deviceBytes += p < 2 ? get_mip_chain_size(VK_FORMAT_R8G8B8A8_SRGB, image.width, image.height, levelCount) : payload.byteLength;
+                }
+            }
+
+//          the first pass warms the page cache, it is not timed
+            const double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            if (pass)
+                path.time = (pass == 1) ? time : std::min(path.time, time);
+        }
+    }
+
+    spdlog::info("Texture cooker: {} textures, best of {} passes", textures.size(), passes);
+
+    for (const auto& path : paths)
+        spdlog::info("Texture cooker: {:<13} {:9.3f} ms, {:8.3f} ms per texture, {:8.2f} MiB on disk, {:8.2f} MiB on the device, {:8.2f} MiB of heap per decoder",
+                     path.name, path.time, path.time / textures.size(), path.fileBytes / (1024.0 * 1024.0),
+                     path.deviceBytes / (1024.0 * 1024.0), path.heapBytes / (1024.0 * 1024.0));
+
+    return true;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    if ((argc == 4 || argc == 5) && std::string_view(argv[1]) == "--compare")
+        return compare(argv[2], argv[3], (argc == 5) ? std::max(static_cast<uint32_t>(std::stoul(argv[4])), 1u) : 5) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    if (argc != 3)
+    {
+        spdlog::error("Usage: texture_cooker <source directory> <output directory> | --compare <source directory> <cooked directory> [passes]");
+
+        return EXIT_FAILURE;
+    }
+
+    const std::filesystem::path sourceDir = argv[1];
+    const std::filesystem::path outputDir = argv[2];
+
+    std::error_code error;
+    std::filesystem::create_directories(outputDir, error);
+
+    if (error)
+    {
+        spdlog::error("Texture cooker: failed to create {}, {}", outputDir.string(), error.message());
+
+        return EXIT_FAILURE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    uint32_t cooked = 0;
+    uint32_t failed = 0;
+
+    for (const auto& file : std::filesystem::recursive_directory_iterator(sourceDir, error))
+    {
+        const std::string extension = file.path().extension().string();
+
+        if (!file.is_regular_file() || std::find(source_extensions.begin(), source_extensions.end(), extension) == source_extensions.end())
+            continue;
+
+        const std::filesystem::path destination = outputDir / file.path().filename().replace_extension(".ctex");
+
+//      up to date
+        if (std::filesystem::exists(destination) && std::filesystem::last_write_time(destination) >= file.last_write_time())
+            continue;
+
+        cook(file.path(), destination) ? cooked++ : failed++;
+    }
+
+    if (error)
+    {
+        spdlog::error("Texture cooker: failed to list {}, {}", sourceDir.string(), error.message());
+
+        return EXIT_FAILURE;
+    }
+
+    spdlog::info("Texture cooker: {} textures cooked, {} failed in {:.3f} s", cooked, failed,
+                 std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "context/Context.hpp"
+#include "memory/MemoryAllocator.hpp"
+#include "buffers/StagingRing.hpp"
+#include "utils/Tools.hpp"
+
+
+// Buffer upload microbenchmark.
+// Fills a set of device local buffers, the meshes of a streamed scene, and reports uploads per second of each way to do it:
+//  per upload - a host visible staging buffer with its own vkAllocateMemory per upload, a single time command buffer and
+//               vkQueueWaitIdle, the former BufferHolder::allocate
+//  ring       - StagingRing, every copy recorded into the current batch and a single flush and wait at the end
+// The destination buffers are created once through the MemoryAllocator and reused by every pass. An upload size above
+// half of the ring exercises the split uploads of StagingRing. The context is headless.
+//
+// Usage: upload_benchmark [upload count] [upload size in KiB] [passes] [ring size in MiB]
+
+
+struct DeviceBuffer
+{
+    VkBuffer   handle = VK_NULL_HANDLE;
+    Allocation allocation;
+};
+
+
+struct StagingBuffer
+{
+    VkBuffer       buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+};
+
+
+//  vkCreateBuffer/vkAllocateMemory/vkMapMemory, what every upload paid before the staging ring
+static StagingBuffer create_staging_buffer(VkDeviceSize size, const void* data, VkDevice device, VkPhysicalDevice gpu) noexcept
+{
+    StagingBuffer staging;
+
+    const VkBufferCreateInfo bufferInfo =
+    {
+        .sType                 = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext                 = VK_NULL_HANDLE,
+        .flags                 = 0,
+        .size                  = size,
+        .usage                 = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 0,
+        .pQueueFamilyIndices   = VK_NULL_HANDLE
+    };
+
+    if (vkCreateBuffer(device, &bufferInfo, VK_NULL_HANDLE, &staging.buffer) != VK_SUCCESS)
+        return {};
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(device, staging.buffer, &requirements);
+
+    const VkMemoryAllocateInfo allocateInfo =
+    {
+        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext           = VK_NULL_HANDLE,
+        .allocationSize  = requirements.size,
+        .memoryTypeIndex = vktools::find_memory_type(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, gpu)
+    };
+
+    void* mapped = nullptr;
+
+    if (vkAllocateMemory(device, &allocateInfo, VK_NULL_HANDLE, &staging.memory) != VK_SUCCESS ||
+        vkBindBufferMemory(device, staging.buffer, staging.memory, 0) != VK_SUCCESS ||
+        vkMapMemory(device, staging.memory, 0, size, 0, &mapped) != VK_SUCCESS)
+    {
+        vkDestroyBuffer(device, staging.buffer, VK_NULL_HANDLE);
+
+        if (staging.memory)
+            vkFreeMemory(device, staging.memory, VK_NULL_HANDLE);
+
+        return {};
+    }
+
+    memcpy(mapped, data, static_cast<size_t>(size));
+    vkUnmapMemory(device, staging.memory);
+
+    return staging;
+}
+
+
+static bool upload_per_buffer(const std::vector<DeviceBuffer>& buffers, const std::vector<uint8_t>& data, VkCommandPool pool, StagingRing&) noexcept
+{
+    const auto device = vkContext->get<VkDevice>();
+    const auto gpu    = vkContext->get<VkPhysicalDevice>();
+    const auto queue  = vkContext->get<VkQueue>();
+
+    for (const auto& buffer : buffers)
+    {
+        const StagingBuffer staging = create_staging_buffer(data.size(), data.data(), device, gpu);
+
+        if (!staging.buffer)
+            return false;
+
+        vktools::copy_buffer(staging.buffer, buffer.handle, data.size(), device, pool, queue);
+
+        vkDestroyBuffer(device, staging.buffer, VK_NULL_HANDLE);
+        vkFreeMemory(device, staging.memory, VK_NULL_HANDLE);
+    }
+
+    return true;
+}
+
+
+static bool upload_ring(const std::vector<DeviceBuffer>& buffers, const std::vector<uint8_t>& data, VkCommandPool, StagingRing& staging) noexcept
+{
+    for (const auto& buffer : buffers)
+        if (!staging.uploadBuffer(buffer.handle, data.data(), data.size()))
+            return false;
+
+    return staging.wait(staging.flush());
+}
+
+
+int main(int argc, char* argv[])
+{
+    const uint32_t     uploadCount = (argc > 1) ? static_cast<uint32_t>(std::stoul(argv[1])) : 500;
+    const VkDeviceSize uploadSize  = (argc > 2) ? std::stoull(argv[2]) * 1024 : 64 * 1024;
+    const uint32_t     passes      = (argc > 3) ? static_cast<uint32_t>(std::stoul(argv[3])) : 10;
+    const VkDeviceSize ringSize    = (argc > 4) ? std::stoull(argv[4]) * 1024 * 1024 : 32ull * 1024 * 1024;
+
+    if (uploadCount == 0 || uploadSize == 0 || passes == 0 || ringSize == 0)
+    {
+        spdlog::error("Usage: upload_benchmark [upload count] [upload size in KiB] [passes] [ring size in MiB]");
+
+        return EXIT_FAILURE;
+    }
+
+    VulkanContext context;
+    MemoryAllocator allocator;
+    StagingRing staging;
+
+    if (!context.create(true) || !allocator.create() || !staging.create(ringSize))
+    {
+        spdlog::error("Upload benchmark: failed to create the vulkan context");
+
+        return EXIT_FAILURE;
+    }
+
+    const auto device = context.get<VkDevice>();
+    VkCommandPool pool = VK_NULL_HANDLE;
+
+    const VkCommandPoolCreateInfo poolInfo =
+    {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext            = VK_NULL_HANDLE,
+        .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = context.getQueueFamilyIndex()
+    };
+
+    std::vector<DeviceBuffer> buffers(uploadCount);
+    bool ok = (vkCreateCommandPool(device, &poolInfo, VK_NULL_HANDLE, &pool) == VK_SUCCESS);
+
+    for (auto& buffer : buffers)
+    {
+        if (!ok)
+            break;
+
+        buffer.handle = vktools::create_buffer(uploadSize,
+                                               VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                               &buffer.allocation,
+                                               device);
+        ok = (buffer.handle != VK_NULL_HANDLE);
+    }
+
+//  the content does not matter, it only must not be a page of zeros a driver could skip
+    std::vector<uint8_t> data(static_cast<size_t>(uploadSize));
+
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<uint8_t>(i * 31 + 7);
+
+    struct Method
+    {
+        const char* name;
+        bool (*run)(const std::vector<DeviceBuffer>&, const std::vector<uint8_t>&, VkCommandPool, StagingRing&) noexcept;
+    };
+
+    const Method methods[] =
+    {
+        { "per upload", upload_per_buffer },
+        { "ring",       upload_ring }
+    };
+
+    if (ok)
+        spdlog::info("Upload benchmark: {} uploads of {} KiB, {} passes, ring of {} MiB", uploadCount, uploadSize / 1024, passes, ringSize / (1024 * 1024));
+    else
+        spdlog::error("Upload benchmark: failed to create {} buffers of {} KiB", uploadCount, uploadSize / 1024);
+
+    for (const auto& method : methods)
+    {
+        if (!ok)
+            break;
+
+//      the first pass warms the driver and the ring, it is not timed
+        std::vector<double> times;
+
+        for (uint32_t pass = 0; pass <= passes && ok; ++pass)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            ok = method.run(buffers, data, pool, staging);
+
+            if (pass)
+                times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        if (!ok)
+        {
+            spdlog::error("Upload benchmark: {} failed", method.name);
+            break;
+        }
+
+        std::sort(times.begin(), times.end());
+
+        const double median = times[times.size() / 2];
+        const double megabytes = double(uploadSize) * uploadCount / (1024.0 * 1024.0);
+
+        spdlog::info("Upload benchmark: {:<10} {:9.2f} ms median, {:9.2f} ms best, {:10.0f} uploads/s, {:8.1f} MiB/s",
+                     method.name, median, times.front(), uploadCount * 1000.0 / median, megabytes * 1000.0 / median);
+    }
+
+    vkDeviceWaitIdle(device);
+
+    for (auto& buffer : buffers)
+        vktools::destroy_buffer(buffer.handle, buffer.allocation, device);
+
+    if (pool)
+        vkDestroyCommandPool(device, pool, VK_NULL_HANDLE);
+
+    staging.destroy();
+    allocator.destroy();
+    context.destroy();
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
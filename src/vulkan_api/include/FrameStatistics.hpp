@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+
+// Figures of the last frame drawn, see VulkanApi::getFrameStatistics()
+struct FrameStatistics
+{
+    double   cpuTime;         // ms, the frame from the end of the fence wait to the present
+    double   waitTime;        // ms, blocked on the fence of the frame in flight
+    double   recordTime;      // ms, recording the draws, on the recording threads as well when there are any
+    double   gpuTime;         // ms, the latest frame whose timestamps were read back, 0 - not measured (yet)
+    uint32_t drawCalls;
+    uint64_t memoryReserved;  // bytes of device memory held by the allocator
+    uint64_t memoryAllocated; // bytes of it handed out to resources
+};
+
+
+// GPU time of a named range of a frame, see VulkanApi::getGpuTimings()
+struct GpuScopeTiming
+{
+    const char* name;  // a string literal of the code which opened the scope
+    uint32_t    depth; // 0 - a top level scope, the scopes of a frame are listed in the order they were opened
+    double      time;  // ms
+};
+
+
+// Counters of the scope measured with pipeline statistics, see VulkanApi::getPipelineStatistics()
+struct GpuPipelineStatistics
+{
+    uint64_t inputPrimitives;
+    uint64_t vertexInvocations;
+    uint64_t fragmentInvocations;
+};
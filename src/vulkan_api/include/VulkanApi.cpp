@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "engine/Engine.hpp"
 #include "VulkanApi.hpp"
 
@@ -26,14 +28,97 @@ bool VulkanApi::init() noexcept
 }
 
 
-bool VulkanApi::createContext() noexcept
+bool VulkanApi::createContext(bool headless) noexcept
 {
     if (!m_engine)
         return true;
 
     auto engine = std::static_pointer_cast<Engine>(m_engine);
 
-    return engine->createContext();
+    return engine->createContext(headless);
+}
+
+
+void VulkanApi::setFramesInFlight(uint32_t count) const noexcept
+{
+    if (auto engine = std::static_pointer_cast<Engine>(m_engine))
+    {
+        engine->setFramesInFlight(count);
+    }
+}
+
+
+void VulkanApi::setInstanceCount(uint32_t count) const noexcept
+{
+    if (auto engine = std::static_pointer_cast<Engine>(m_engine))
+    {
+        engine->setInstanceCount(count);
+    }
+}
+
+
+void VulkanApi::setRecordingThreads(uint32_t count) const noexcept
+{
+    if (auto engine = std::static_pointer_cast<Engine>(m_engine))
+    {
+        engine->setRecordingThreads(count);
+    }
+}
+
+
+void VulkanApi::setDrawPath(uint32_t path) const noexcept
+{
+    if (auto engine = std::static_pointer_cast<Engine>(m_engine))
+    {
+        engine->setDrawPath(static_cast<DrawPath>(std::min(path, static_cast<uint32_t>(DrawPath::UniformPerDraw))));
+    }
+}
+
+
+void VulkanApi::setShadingBenchmark(uint32_t iterations, bool detail, bool specialized) const noexcept
+{
+    if (auto engine = std::static_pointer_cast<Engine>(m_engine))
+    {
+        engine->setShadingBenchmark(iterations, detail, specialized);
+    }
+}
+
+
+void VulkanApi::setBindlessTextures(bool enabled) const noexcept
+{
+    if (auto engine = std::static_pointer_cast<Engine>(m_engine))
+    {
+        engine->setBindlessTextures(enabled);
+    }
+}
+
+
+void VulkanApi::setTextureDirectory(const char* directory) const noexcept
+{
+    if (auto engine = std::static_pointer_cast<Engine>(m_engine))
+    {
+        engine->setTextureDirectory(directory);
+    }
+}
+
+
+void VulkanApi::setPipelineStatistics(bool enabled) const noexcept
+{
+    if (auto engine = std::static_pointer_cast<Engine>(m_engine))
+    {
+        engine->setPipelineStatistics(enabled);
+    }
+}
+
+
+bool VulkanApi::setGpuProfilerLog(const char* path) const noexcept
+{
+    if (auto engine = std::static_pointer_cast<Engine>(m_engine))
+    {
+        return engine->setGpuProfilerLog(path ? path : "");
+    }
+
+    return false;
 }
 
 
@@ -51,6 +136,20 @@ bool VulkanApi::createMainView(uint64_t windowHandle) noexcept
 }
 
 
+bool VulkanApi::createOffscreenView(uint32_t width, uint32_t height) noexcept
+{
+    if (m_engine)
+    {
+        auto engine = std::static_pointer_cast<Engine>(m_engine);
+
+        if (engine->createOffscreenView(width, height))
+            return engine->createPipeline();
+    }
+
+    return false;
+}
+
+
 void VulkanApi::drawFrame() const noexcept
 {
     if (auto engine = std::static_pointer_cast<Engine>(m_engine))
@@ -60,6 +159,70 @@ void VulkanApi::drawFrame() const noexcept
 }
 
 
+bool VulkanApi::saveFrame(const char* path) const noexcept
+{
+    if (auto engine = std::static_pointer_cast<Engine>(m_engine))
+    {
+        return engine->saveFrame(path);
+    }
+
+    return false;
+}
+
+
+FrameStatistics VulkanApi::getFrameStatistics() const noexcept
+{
+    if (auto engine = std::static_pointer_cast<Engine>(m_engine))
+    {
+        return engine->getFrameStatistics();
+    }
+
+    return {};
+}
+
+
+std::span<const GpuScopeTiming> VulkanApi::getGpuTimings() const noexcept
+{
+    if (auto engine = std::static_pointer_cast<Engine>(m_engine))
+    {
+        return engine->getGpuTimings();
+    }
+
+    return {};
+}
+
+
+GpuPipelineStatistics VulkanApi::getPipelineStatistics() const noexcept
+{
+    if (auto engine = std::static_pointer_cast<Engine>(m_engine))
+    {
+        return engine->getPipelineStatistics();
+    }
+
+    return {};
+}
+
+
+bool VulkanApi::saveCpuTrace(const char* path) const noexcept
+{
+    if (auto engine = std::static_pointer_cast<Engine>(m_engine))
+    {
+        return engine->saveCpuTrace(path);
+    }
+
+    return false;
+}
+
+
+void VulkanApi::setCamera(float x, float y, float z, float yaw, float pitch) const noexcept
+{
+    if (auto engine = std::static_pointer_cast<Engine>(m_engine))
+    {
+        engine->camera.setPose({ x, y, z }, yaw, pitch);
+    }
+}
+
+
 void VulkanApi::processMouseMovement(float xpos, float ypos) const noexcept
 {
     if (auto engine = std::static_pointer_cast<Engine>(m_engine))
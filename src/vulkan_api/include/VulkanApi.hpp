@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <span>
 
 #include "Export.hpp"
+#include "FrameStatistics.hpp"
 
 
 class VK_API VulkanApi final
@@ -13,9 +16,27 @@ public:
 
     bool init() noexcept;
 
-    bool createContext() noexcept;
+    bool createContext(bool headless = false) noexcept; // headless - no window system, only createOffscreenView() can follow
+    void setFramesInFlight(uint32_t count) const noexcept; // must be called before createMainView
+    void setInstanceCount(uint32_t count)  const noexcept; // number of cubes in the scene, must be called before createMainView
+    void setRecordingThreads(uint32_t count) const noexcept; // 0 records on the calling thread only, must be called before createMainView
+    void setDrawPath(uint32_t path) const noexcept; // 0 - instanced, 1 - push constants per draw, 2 - uniform block per draw, must be called before createMainView
+    void setShadingBenchmark(uint32_t iterations, bool detail, bool specialized) const noexcept; // heavier fragment shader, its parameters as specialization constants or uniforms, must be called before createMainView
+    void setBindlessTextures(bool enabled) const noexcept; // one texture array indexed per draw when the device supports it, on by default, must be called before createMainView
+    void setTextureDirectory(const char* directory) const noexcept; // every image of the directory is streamed in, must be called before createMainView
+    void setPipelineStatistics(bool enabled) const noexcept; // primitives and shader invocations of the rendering when the device supports it, must be called before createMainView
+    bool setGpuProfilerLog(const char* path) const noexcept; // CSV of the GPU scopes of every frame, an empty path closes it
     bool createMainView(uint64_t windowHandle) noexcept;
+    bool createOffscreenView(uint32_t width, uint32_t height) noexcept; // instead of createMainView, frames are rendered into images of the engine and never presented
     void drawFrame() const noexcept;
+    bool saveFrame(const char* path) const noexcept; // offscreen view only, the last drawn frame as .png or as a binary .ppm otherwise
+
+    FrameStatistics getFrameStatistics() const noexcept; // the last frame drawn
+    std::span<const GpuScopeTiming> getGpuTimings() const noexcept; // a frame drawn frames in flight ago, valid until the next drawFrame
+    GpuPipelineStatistics getPipelineStatistics() const noexcept; // of the frame of getGpuTimings()
+    bool saveCpuTrace(const char* path) const noexcept; // Chrome trace JSON of the CPU scopes recorded so far, empty unless built with VULKAN_API_CPU_PROFILER
+
+    void setCamera(float x, float y, float z, float yaw, float pitch) const noexcept; // angles in degrees, places the camera directly for a replayed path
 
     void processMouseMovement(float xpos, float ypos) const noexcept;
     void processKeyboard(int direction, float deltaTime) const noexcept;
@@ -5,9 +5,8 @@ void BufferHolder::destroy() noexcept
 {
     const auto logicalDevice = vkContext->get<VkDevice>();
 
-    for(const auto& data : m_buffers)
-    {
-        vkDestroyBuffer(logicalDevice, data.handle, VK_NULL_HANDLE);
-        vkFreeMemory(logicalDevice, data.memory, VK_NULL_HANDLE);
-    }
+    for(auto& data : m_buffers)
+        vktools::destroy_buffer(data.handle, data.allocation, logicalDevice);
+
+    m_buffers.clear();
 }
\ No newline at end of file
@@ -5,82 +5,65 @@
 #include <span>
 
 #include "utils/Tools.hpp"
+#include "utils/CpuProfiler.hpp"
 #include "context/Context.hpp"
+#include "buffers/StagingRing.hpp"
 
 
 struct Buffer
 {
-    VkBuffer       handle = VK_NULL_HANDLE;
-    VkDeviceMemory memory = VK_NULL_HANDLE;
-    uint32_t       size;
+    VkBuffer   handle = VK_NULL_HANDLE;
+    Allocation allocation;
+    uint32_t   size;
 };
 
 
 struct BufferHolder
 {
+//  Device local buffers are filled through the staging ring, the copy is executed with the next StagingRing::flush().
+//  Uniform buffers are host visible and written directly.
     template<class T>
-    Buffer allocate(std::span<const T> rawData, VkBufferUsageFlagBits flag, VkCommandPool pool) noexcept
+    Buffer allocate(std::span<const T> rawData, VkBufferUsageFlagBits flag, StagingRing& staging) noexcept
     {
-        const auto context = vkContext;
-        const auto physicalDevice = context->get<VkPhysicalDevice>();
-        const auto logicalDevice = context->get<VkDevice>();
+        CPU_PROFILE_SCOPE("BufferHolder::allocate");
 
-        Buffer bufferData = { VK_NULL_HANDLE, VK_NULL_HANDLE, static_cast<uint32_t>(rawData.size()) };
-        VkDeviceSize bufferSize = sizeof(T) * rawData.size();
-
-        VkDeviceMemory stagingBufferMemory;
-        VkBuffer stagingBuffer = vktools::create_buffer(bufferSize, 
-                                                        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-                                                        &stagingBufferMemory, 
-                                                        logicalDevice, 
-                                                        physicalDevice);
-
-        if (!stagingBuffer)
-            return {};
+        const auto logicalDevice = vkContext->get<VkDevice>();
 
-        struct BufferMemoryDeleter
-        {
-            ~BufferMemoryDeleter() 
-            {
-                vkDestroyBuffer(device, buffer, VK_NULL_HANDLE);
-                vkFreeMemory(device, memory, VK_NULL_HANDLE);
-            }
-
-            VkDeviceMemory memory = VK_NULL_HANDLE;
-            VkBuffer buffer       = VK_NULL_HANDLE;
-            VkDevice device       = VK_NULL_HANDLE;
-        } guard = { stagingBufferMemory, stagingBuffer, logicalDevice }; 
-
-        if (void* ptr; vkMapMemory(logicalDevice, stagingBufferMemory, 0, bufferSize, 0, &ptr) == VK_SUCCESS)
-        {
-            memcpy(ptr, rawData.data(), static_cast<size_t>(bufferSize));
-            vkUnmapMemory(logicalDevice, stagingBufferMemory);
-        }
-        else return {};
+        Buffer bufferData = { VK_NULL_HANDLE, {}, static_cast<uint32_t>(rawData.size()) };
+        VkDeviceSize bufferSize = sizeof(T) * rawData.size();
 
         if (flag != VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
         {
             bufferData.handle = vktools::create_buffer(bufferSize, 
                                                        VK_BUFFER_USAGE_TRANSFER_DST_BIT | flag, 
                                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
-                                                       &bufferData.memory, 
-                                                       logicalDevice, 
-                                                       physicalDevice);
+                                                       &bufferData.allocation, 
+                                                       logicalDevice);
+
+            if (bufferData.handle && !staging.uploadBuffer(bufferData.handle, rawData.data(), bufferSize))
+            {
+//              the chunks recorded before the failure still copy into the buffer, they must complete before it is freed
+                staging.waitIdle();
+                vktools::destroy_buffer(bufferData.handle, bufferData.allocation, logicalDevice);
+
+                return {};
+            }
         }
         else
         {
             bufferData.handle = vktools::create_buffer(bufferSize, 
-                                                       VK_BUFFER_USAGE_TRANSFER_DST_BIT | flag, 
+                                                       flag, 
                                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-                                                       &bufferData.memory, 
-                                                       logicalDevice, 
-                                                       physicalDevice);
+                                                       &bufferData.allocation, 
+                                                       logicalDevice);
+
+//          host visible memory is persistently mapped by the allocator
+            if (bufferData.handle)
+                memcpy(bufferData.allocation.mapped, rawData.data(), static_cast<size_t>(bufferSize));
         }
 
         if (bufferData.handle)
         {
-            vktools::copy_buffer(stagingBuffer, bufferData.handle, bufferSize, logicalDevice, pool, context->get<VkQueue>());
             m_buffers.push_back(bufferData);
 
             return bufferData;
@@ -0,0 +1,345 @@
+#include <cstring>
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
+#include "utils/Tools.hpp"
+#include "utils/CpuProfiler.hpp"
+#include "context/Context.hpp"
+#include "buffers/StagingRing.hpp"
+
+
+static uint64_t align_up(uint64_t value, uint64_t alignment) noexcept
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+
+
+StagingRing::StagingRing() noexcept:
+    m_buffer(VK_NULL_HANDLE),
+    m_capacity(0),
+    m_head(0),
+    m_tail(0),
+    m_batchStart(0),
+    m_pool(VK_NULL_HANDLE),
+    m_current(0),
+    m_recording(false),
+    m_nextValue(1),
+    m_completedValue(0)
+{
+
+}
+
+
+bool StagingRing::create(VkDeviceSize capacity) noexcept
+{
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+    m_buffer = vktools::create_buffer(capacity,
+                                      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                      &m_allocation,
+                                      logicalDevice);
+
+    if (!m_buffer)
+        return false;
+
+    m_capacity = capacity;
+
+    const VkCommandPoolCreateInfo poolInfo =
+    {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext            = VK_NULL_HANDLE,
+        .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .queueFamilyIndex = vkContext->getQueueFamilyIndex()
+    };
+
+    if (vkCreateCommandPool(logicalDevice, &poolInfo, VK_NULL_HANDLE, &m_pool) != VK_SUCCESS)
+        return false;
+
+    std::array<VkCommandBuffer, std::tuple_size_v<decltype(m_batches)>> commandBuffers;
+
+    const VkCommandBufferAllocateInfo allocInfo =
+    {
+        .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext              = VK_NULL_HANDLE,
+        .commandPool        = m_pool,
+        .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = static_cast<uint32_t>(commandBuffers.size())
+    };
+
+    if (vkAllocateCommandBuffers(logicalDevice, &allocInfo, commandBuffers.data()) != VK_SUCCESS)
+        return false;
+
+    const VkFenceCreateInfo fenceInfo =
+    {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .pNext = VK_NULL_HANDLE,
+        .flags = 0
+    };
+
+    for (uint32_t i = 0; i < m_batches.size(); ++i)
+    {
+        m_batches[i].cmd = commandBuffers[i];
+
+        if (vkCreateFence(logicalDevice, &fenceInfo, VK_NULL_HANDLE, &m_batches[i].fence) != VK_SUCCESS)
+            return false;
+    }
+
+    spdlog::info("Staging ring: {} bytes, {} batches in flight", m_capacity, m_batches.size());
+
+    return true;
+}
+
+
+void StagingRing::destroy() noexcept
+{
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+    while (retireOldest());
+
+    for (auto& batch : m_batches)
+    {
+        if (batch.fence)
+            vkDestroyFence(logicalDevice, batch.fence, VK_NULL_HANDLE);
+
+        batch = {};
+    }
+
+    if (m_pool)
+        vkDestroyCommandPool(logicalDevice, m_pool, VK_NULL_HANDLE);
+
+    vktools::destroy_buffer(m_buffer, m_allocation, logicalDevice);
+
+    m_buffer    = VK_NULL_HANDLE;
+    m_pool      = VK_NULL_HANDLE;
+    m_recording = false;
+}
+
+
+bool StagingRing::uploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset) noexcept
+{
+//  larger uploads are split, a chunk of half the ring always fits once the ring has drained
+    const VkDeviceSize chunkSize = m_capacity / 2 / 16 * 16;
+
+    for (VkDeviceSize uploaded = 0; uploaded < size; )
+    {
+        const VkDeviceSize chunk = std::min(size - uploaded, chunkSize);
+        VkDeviceSize offset;
+
+//      reserve first, it may submit the batch being recorded to free some space
+        if (!reserve(chunk, 16, &offset))
+            return false;
+
+        if (!m_recording && !beginBatch())
+        {
+            m_head = m_batchStart;
+
+            return false;
+        }
+
+        memcpy(static_cast<uint8_t*>(m_allocation.mapped) + offset, static_cast<const uint8_t*>(data) + uploaded, static_cast<size_t>(chunk));
+
+        const VkBufferCopy copyRegion =
+        {
+            .srcOffset = offset,
+            .dstOffset = dstOffset + uploaded,
+            .size      = chunk
+        };
+
+        Batch& batch = m_batches[m_current];
+        vkCmdCopyBuffer(batch.cmd, m_buffer, dstBuffer, 1, &copyRegion);
+
+        batch.copyCount++;
+        batch.bytes += chunk;
+        uploaded    += chunk;
+    }
+
+    return true;
+}
+
+
+uint64_t StagingRing::flush() noexcept
+{
+    CPU_PROFILE_SCOPE("StagingRing::flush");
+
+    if (!m_recording)
+        return 0;
+
+    Batch& batch = m_batches[m_current];
+
+//  make the copies visible to every consumer recorded later in submission order
+    const VkMemoryBarrier barrier =
+    {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext         = VK_NULL_HANDLE,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT |
+                         VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT
+    };
+
+    vkCmdPipelineBarrier(batch.cmd,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0,
+                         1, &barrier,
+                         0, VK_NULL_HANDLE,
+                         0, VK_NULL_HANDLE);
+
+    m_recording = false;
+
+    const VkSubmitInfo submitInfo =
+    {
+        .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext                = VK_NULL_HANDLE,
+        .waitSemaphoreCount   = 0,
+        .pWaitSemaphores      = VK_NULL_HANDLE,
+        .pWaitDstStageMask    = VK_NULL_HANDLE,
+        .commandBufferCount   = 1,
+        .pCommandBuffers      = &batch.cmd,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores    = VK_NULL_HANDLE
+    };
+
+    if (vkEndCommandBuffer(batch.cmd) != VK_SUCCESS ||
+        vkQueueSubmit(vkContext->get<VkQueue>(), 1, &submitInfo, batch.fence) != VK_SUCCESS)
+    {
+        spdlog::error("Staging ring: failed to submit the upload batch, its {} copies of {} bytes are dropped", batch.copyCount, batch.bytes);
+
+//      the batch never reaches the queue, its range is free again and beginBatch() resets its command buffer
+        m_head = m_batchStart;
+
+        return 0;
+    }
+
+    batch.value       = m_nextValue++;
+    batch.endPosition = m_head;
+    batch.submitted   = true;
+    m_batchStart      = m_head;
+
+    spdlog::debug("Staging ring: batch {} submitted, {} copies, {} bytes", batch.value, batch.copyCount, batch.bytes);
+
+    m_current = (m_current + 1) % m_batches.size();
+
+    return batch.value;
+}
+
+
+bool StagingRing::wait(uint64_t value) noexcept
+{
+    while (m_completedValue < value)
+        if (!retireOldest())
+            return false;
+
+    return true;
+}
+
+
+bool StagingRing::waitIdle() noexcept
+{
+    flush();
+
+    while (retireOldest());
+
+    return std::none_of(m_batches.begin(), m_batches.end(), [](const Batch& batch) { return batch.submitted; });
+}
+
+
+uint64_t StagingRing::getCompletedValue() const noexcept
+{
+    return m_completedValue;
+}
+
+
+bool StagingRing::reserve(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* offset) noexcept
+{
+    for (;;)
+    {
+        uint64_t position = align_up(m_head, alignment);
+
+//      a range never wraps around the end of the buffer
+        if ((position % m_capacity) + size > m_capacity)
+            position = align_up(position, m_capacity);
+
+        if (position + size - m_tail <= m_capacity)
+        {
+            m_head  = position + size;
+            *offset = position % m_capacity;
+
+            return true;
+        }
+
+        if (m_recording && !flush())
+            return false;
+
+        if (!retireOldest())
+            return false;
+    }
+}
+
+
+bool StagingRing::beginBatch() noexcept
+{
+    const auto logicalDevice = vkContext->get<VkDevice>();
+    Batch& batch = m_batches[m_current];
+
+    if (batch.submitted)
+    {
+        if (vkWaitForFences(logicalDevice, 1, &batch.fence, VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+            return false;
+
+        retire(batch);
+    }
+
+    if (vkResetFences(logicalDevice, 1, &batch.fence) != VK_SUCCESS)
+        return false;
+
+    if (vkResetCommandBuffer(batch.cmd, 0) != VK_SUCCESS)
+        return false;
+
+    const VkCommandBufferBeginInfo beginInfo =
+    {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext            = VK_NULL_HANDLE,
+        .flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = VK_NULL_HANDLE
+    };
+
+    if (vkBeginCommandBuffer(batch.cmd, &beginInfo) != VK_SUCCESS)
+        return false;
+
+    batch.copyCount = 0;
+    batch.bytes     = 0;
+    m_recording     = true;
+
+    return true;
+}
+
+
+bool StagingRing::retireOldest() noexcept
+{
+    Batch* oldest = nullptr;
+
+    for (auto& batch : m_batches)
+        if (batch.submitted && (!oldest || batch.value < oldest->value))
+            oldest = &batch;
+
+    if (!oldest)
+        return false;
+
+    if (vkWaitForFences(vkContext->get<VkDevice>(), 1, &oldest->fence, VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+        return false;
+
+    retire(*oldest);
+
+    return true;
+}
+
+
+void StagingRing::retire(Batch& batch) noexcept
+{
+    m_tail           = std::max(m_tail, batch.endPosition);
+    m_completedValue = std::max(m_completedValue, batch.value);
+    batch.submitted  = false;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+
+#include "memory/MemoryAllocator.hpp"
+
+
+// Persistently mapped upload buffer used as a ring.
+// Copies are recorded into one command buffer per batch, flush() submits the batch with a fence
+// and the space is reclaimed once the fence of the batch has been signaled.
+// An upload larger than half of the ring is split into several copies.
+class StagingRing final
+{
+public:
+    StagingRing() noexcept;
+
+    bool create(VkDeviceSize capacity = 32ull * 1024 * 1024) noexcept;
+    void destroy() noexcept;
+
+    bool uploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0) noexcept;
+
+//  Submits the pending copies, returns the fence value of the batch (0 if there was nothing to submit or the submission
+//  failed, the copies of a failed batch are dropped)
+    uint64_t flush() noexcept;
+    bool wait(uint64_t value) noexcept;
+    bool waitIdle() noexcept; // flushes, then waits for every batch in flight
+
+    uint64_t getCompletedValue() const noexcept;
+
+private:
+    struct Batch
+    {
+        VkCommandBuffer cmd         = VK_NULL_HANDLE;
+        VkFence         fence       = VK_NULL_HANDLE;
+        uint64_t        value       = 0;
+        uint64_t        endPosition = 0;
+        uint32_t        copyCount   = 0;
+        VkDeviceSize    bytes       = 0;
+        bool            submitted   = false;
+    };
+
+    bool reserve(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* offset) noexcept;
+    bool beginBatch() noexcept;
+    bool retireOldest() noexcept;
+    void retire(Batch& batch) noexcept;
+
+    VkBuffer     m_buffer;
+    Allocation   m_allocation;
+    VkDeviceSize m_capacity;
+
+//  monotonic positions, the ring offset is position % capacity
+    uint64_t m_head;
+    uint64_t m_tail;
+    uint64_t m_batchStart; // m_head when the batch being recorded took its first range
+
+    VkCommandPool          m_pool;
+    std::array<Batch, 4>   m_batches;
+    uint32_t               m_current;
+    bool                   m_recording;
+    uint64_t               m_nextValue;
+    uint64_t               m_completedValue;
+};
@@ -0,0 +1,86 @@
+#include <cstring>
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
+#include "utils/Tools.hpp"
+#include "context/Context.hpp"
+#include "buffers/UniformArena.hpp"
+
+
+UniformArena::UniformArena() noexcept:
+    m_buffer(VK_NULL_HANDLE),
+    m_frameCapacity(0),
+    m_alignment(0),
+    m_frameOffset(0),
+    m_used(0)
+{
+
+}
+
+
+bool UniformArena::create(uint32_t frameCount, VkDeviceSize frameCapacity) noexcept
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(vkContext->get<VkPhysicalDevice>(), &properties);
+
+    m_alignment     = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 16);
+    m_frameCapacity = (frameCapacity + m_alignment - 1) / m_alignment * m_alignment;
+
+    m_buffer = vktools::create_buffer(m_frameCapacity * frameCount,
+                                      VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                      &m_allocation,
+                                      vkContext->get<VkDevice>());
+
+    if (!m_buffer)
+        return false;
+
+    spdlog::info("Uniform arena: {} frames x {} bytes, offset alignment {}", frameCount, m_frameCapacity, m_alignment);
+
+    return true;
+}
+
+
+void UniformArena::destroy() noexcept
+{
+    vktools::destroy_buffer(m_buffer, m_allocation, vkContext->get<VkDevice>());
+    m_buffer = VK_NULL_HANDLE;
+}
+
+
+void UniformArena::beginFrame(uint32_t frame) noexcept
+{
+    m_frameOffset = m_frameCapacity * frame;
+    m_used        = 0;
+}
+
+
+uint32_t UniformArena::push(const void* data, VkDeviceSize size) noexcept
+{
+    if (m_used + size > m_frameCapacity)
+    {
+        spdlog::error("Uniform arena: the frame region of {} bytes is full", m_frameCapacity);
+
+        return UINT32_MAX;
+    }
+
+    const VkDeviceSize offset = m_frameOffset + m_used;
+    memcpy(static_cast<uint8_t*>(m_allocation.mapped) + offset, data, static_cast<size_t>(size));
+
+    m_used += (size + m_alignment - 1) / m_alignment * m_alignment;
+
+    return static_cast<uint32_t>(offset);
+}
+
+
+VkBuffer UniformArena::getBuffer() const noexcept
+{
+    return m_buffer;
+}
+
+
+VkDeviceSize UniformArena::getAlignment() const noexcept
+{
+    return m_alignment;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "memory/MemoryAllocator.hpp"
+
+
+// Persistently mapped uniform buffer split into one linear region per frame in flight.
+// push() copies the data into the region of the current frame and returns the dynamic offset
+// for a VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC binding, so the descriptor sets are written only once.
+class UniformArena final
+{
+public:
+    UniformArena() noexcept;
+
+    bool create(uint32_t frameCount, VkDeviceSize frameCapacity = 1024 * 1024) noexcept;
+    void destroy() noexcept;
+
+//  The frame must not be in use by the GPU anymore
+    void beginFrame(uint32_t frame) noexcept;
+
+//  Returns UINT32_MAX when the region of the frame is full
+    uint32_t push(const void* data, VkDeviceSize size) noexcept;
+
+    template<class T>
+    uint32_t push(const T& data) noexcept
+    {
+        return push(&data, sizeof(T));
+    }
+
+    VkBuffer     getBuffer()    const noexcept;
+    VkDeviceSize getAlignment() const noexcept;
+
+private:
+    VkBuffer     m_buffer;
+    Allocation   m_allocation;
+    VkDeviceSize m_frameCapacity;
+    VkDeviceSize m_alignment;
+    VkDeviceSize m_frameOffset;
+    VkDeviceSize m_used;
+};
@@ -79,6 +79,16 @@ void Camera::processMouseMovement(float xoffset, float yoffset) noexcept
 }
 
 
+void Camera::setPose(vec3s newPosition, float newYaw, float newPitch) noexcept
+{
+    position = newPosition;
+    yaw      = newYaw;
+    pitch    = glm_clamp(newPitch, -89.f, 89.f);
+
+    update_camera_vectors(this);
+}
+
+
 mat4s Camera::getViewMatrix() noexcept
 {
     vec3s center = glms_vec3_add(position, front);
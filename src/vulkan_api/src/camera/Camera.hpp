@@ -19,6 +19,7 @@ struct Camera
 
     void processKeyboard(Camera::Direction direction, float deltaTime) noexcept;
     void processMouseMovement(float xoffset, float yoffset) noexcept;
+    void setPose(vec3s newPosition, float newYaw, float newPitch) noexcept;
     mat4s getViewMatrix() noexcept;
 
 //  camera Attributes
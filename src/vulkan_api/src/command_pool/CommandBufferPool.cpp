@@ -2,7 +2,7 @@
 #include "command_pool/CommandBufferPool.hpp"
 
 
-bool CommandBufferPool::create() noexcept
+bool CommandBufferPool::create(uint32_t bufferCount) noexcept
 {
     const auto logicalDevice = vkContext->get<VkDevice>();
 
@@ -17,6 +17,8 @@ bool CommandBufferPool::create() noexcept
     if (vkCreateCommandPool(logicalDevice, &poolInfo, VK_NULL_HANDLE, &handle) != VK_SUCCESS)
         return false;
 
+    commandBuffers.resize(bufferCount, VK_NULL_HANDLE);
+
     const VkCommandBufferAllocateInfo allocInfo = 
     {
         .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
@@ -34,4 +36,5 @@ void CommandBufferPool::destroy() noexcept
 {
     const auto logicalDevice = vkContext->get<VkDevice>();
     vkDestroyCommandPool(logicalDevice, handle, VK_NULL_HANDLE);
+    commandBuffers.clear();
 }
\ No newline at end of file
@@ -1,14 +1,14 @@
 #pragma once
 
-#include <array>
+#include <vector>
 
 #include <vulkan/vulkan.h>
 
 struct CommandBufferPool
 {
-    bool create() noexcept;
+    bool create(uint32_t bufferCount) noexcept;
     void destroy() noexcept;
 
     VkCommandPool handle = VK_NULL_HANDLE;
-    std::array<VkCommandBuffer, MAX_FRAMES_IN_FLIGHT> commandBuffers = { VK_NULL_HANDLE, VK_NULL_HANDLE };
-};
\ No newline at end of file
+    std::vector<VkCommandBuffer> commandBuffers;
+};
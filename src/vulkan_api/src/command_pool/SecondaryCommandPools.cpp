@@ -0,0 +1,72 @@
+#include "context/Context.hpp"
+#include "command_pool/SecondaryCommandPools.hpp"
+
+
+bool SecondaryCommandPools::create(uint32_t frameCount, uint32_t count) noexcept
+{
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+    sliceCount = count;
+    pools.resize(frameCount * sliceCount, VK_NULL_HANDLE);
+    commandBuffers.resize(frameCount * sliceCount, VK_NULL_HANDLE);
+
+    const VkCommandPoolCreateInfo poolInfo = 
+    {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext            = VK_NULL_HANDLE,
+        .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = vkContext->getQueueFamilyIndex()
+    };
+
+    for (size_t i = 0; i < pools.size(); ++i)
+    {
+        if (vkCreateCommandPool(logicalDevice, &poolInfo, VK_NULL_HANDLE, &pools[i]) != VK_SUCCESS)
+            return false;
+
+        const VkCommandBufferAllocateInfo allocInfo = 
+        {
+            .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .pNext              = VK_NULL_HANDLE,
+            .commandPool        = pools[i],
+            .level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+            .commandBufferCount = 1
+        };
+
+        if (vkAllocateCommandBuffers(logicalDevice, &allocInfo, &commandBuffers[i]) != VK_SUCCESS)
+            return false;
+    }
+
+    return true;
+}
+
+
+void SecondaryCommandPools::destroy() noexcept
+{
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+    for (auto pool : pools)
+        if (pool)
+            vkDestroyCommandPool(logicalDevice, pool, VK_NULL_HANDLE);
+
+    pools.clear();
+    commandBuffers.clear();
+    sliceCount = 0;
+}
+
+
+VkCommandBuffer SecondaryCommandPools::reset(uint32_t frame, uint32_t slice) noexcept
+{
+    const uint32_t index = frame * sliceCount + slice;
+
+//  resetting the whole pool is cheaper than resetting its command buffer
+    if (vkResetCommandPool(vkContext->get<VkDevice>(), pools[index], 0) != VK_SUCCESS)
+        return VK_NULL_HANDLE;
+
+    return commandBuffers[index];
+}
+
+
+const VkCommandBuffer* SecondaryCommandPools::getCommandBuffers(uint32_t frame) const noexcept
+{
+    return commandBuffers.data() + frame * sliceCount;
+}
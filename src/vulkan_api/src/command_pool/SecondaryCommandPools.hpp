@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// One transient pool per frame in flight and recording slice, each pool owns a single secondary command buffer.
+// A pool is only touched by the job recording its slice, so the slices are recorded without any locking.
+struct SecondaryCommandPools
+{
+    bool create(uint32_t frameCount, uint32_t sliceCount) noexcept;
+    void destroy() noexcept;
+
+//  Resets the pool of the slice and returns its command buffer, ready to be begun
+    VkCommandBuffer reset(uint32_t frame, uint32_t slice) noexcept;
+
+//  The secondary command buffers of a frame, sliceCount consecutive handles
+    const VkCommandBuffer* getCommandBuffers(uint32_t frame) const noexcept;
+
+    uint32_t sliceCount = 0;
+    std::vector<VkCommandPool>   pools;
+    std::vector<VkCommandBuffer> commandBuffers;
+};
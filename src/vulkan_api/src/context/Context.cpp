@@ -1,7 +1,9 @@
 #include <string>
 #include <cstring>
+#include <fstream>
 #include <cassert>
 #include <array>
+#include <algorithm>
 #include <vector>
 #include <unordered_set>
 
@@ -64,15 +66,26 @@ VulkanContext::VulkanContext() noexcept:
     m_physicalDevice(VK_NULL_HANDLE),
     m_logicalDevice(VK_NULL_HANDLE),
     m_queue(VK_NULL_HANDLE),
-    m_queueFamilyIndex(0)
+    m_queueFamilyIndex(0),
+    m_transferQueue(VK_NULL_HANDLE),
+    m_transferQueueFamilyIndex(0),
+    m_pipelineCache(VK_NULL_HANDLE),
+    m_pipelineCacheWarm(false),
+    m_bindlessTextureLimit(0),
+    m_timestampPeriod(0.f),
+    m_timestampValidBits(0),
+    m_pipelineStatistics(false),
+    m_headless(false)
 {
     assert(g_vulkanContext == nullptr);
     g_vulkanContext = this;
 }
 
 
-bool VulkanContext::create() noexcept
+bool VulkanContext::create(bool headless) noexcept
 {
+    m_headless = headless;
+
     if (!createInstance())
         return false;
 
@@ -82,12 +95,20 @@ bool VulkanContext::create() noexcept
     if (!createDevice())
         return false;
 
+    if (!createPipelineCache())
+        return false;
+
     return true;
 }
 
 
 void VulkanContext::destroy() noexcept
 {
+    if (m_pipelineCache)
+        vkDestroyPipelineCache(m_logicalDevice, m_pipelineCache, VK_NULL_HANDLE);
+
+    m_pipelineCache = VK_NULL_HANDLE;
+
     vkDestroyDevice(m_logicalDevice, VK_NULL_HANDLE);
 
     if (m_instance)
@@ -101,6 +122,103 @@ uint32_t VulkanContext::getQueueFamilyIndex() const noexcept
 }
 
 
+VkQueue VulkanContext::getTransferQueue() const noexcept
+{
+    return m_transferQueue;
+}
+
+
+uint32_t VulkanContext::getTransferQueueFamilyIndex() const noexcept
+{
+    return m_transferQueueFamilyIndex;
+}
+
+
+uint32_t VulkanContext::getBindlessTextureLimit() const noexcept
+{
+    return m_bindlessTextureLimit;
+}
+
+
+bool VulkanContext::savePipelineCache() const noexcept
+{
+    if (!m_pipelineCache)
+        return false;
+
+    size_t size = 0;
+
+    if (vkGetPipelineCacheData(m_logicalDevice, m_pipelineCache, &size, VK_NULL_HANDLE) != VK_SUCCESS || size == 0)
+        return false;
+
+    std::vector<char> data(size);
+
+    if (vkGetPipelineCacheData(m_logicalDevice, m_pipelineCache, &size, data.data()) != VK_SUCCESS)
+        return false;
+
+    const std::filesystem::path path = getPipelineCachePath();
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+
+//  written aside and renamed, a crash while saving never leaves a truncated cache behind
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+
+        if (!file.write(data.data(), static_cast<std::streamsize>(size)))
+        {
+            spdlog::error("Pipeline cache: failed to write {}", tempPath.string());
+
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, error);
+
+    if (error)
+    {
+        spdlog::error("Pipeline cache: failed to replace {}, {}", path.string(), error.message());
+
+        return false;
+    }
+
+    spdlog::info("Pipeline cache: saved {} bytes to {}", size, path.string());
+
+    return true;
+}
+
+
+bool VulkanContext::isPipelineCacheWarm() const noexcept
+{
+    return m_pipelineCacheWarm;
+}
+
+
+float VulkanContext::getTimestampPeriod() const noexcept
+{
+    return m_timestampPeriod;
+}
+
+
+uint32_t VulkanContext::getTimestampValidBits() const noexcept
+{
+    return m_timestampValidBits;
+}
+
+
+bool VulkanContext::isPipelineStatisticsSupported() const noexcept
+{
+    return m_pipelineStatistics;
+}
+
+
+bool VulkanContext::isHeadless() const noexcept
+{
+    return m_headless;
+}
+
+
 VulkanContext* VulkanContext::getContext() noexcept
 {
     return g_vulkanContext;
@@ -116,15 +234,21 @@ bool VulkanContext::createInstance() noexcept
         return false;
 #endif // !DEBUG
 
-    std::vector<const char*> requiredExtensions = { VK_KHR_SURFACE_EXTENSION_NAME };
+    std::vector<const char*> requiredExtensions;
+
+//  a headless box may have no window system integration at all
+    if (!m_headless)
+    {
+        requiredExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
 
 #ifdef _WIN32
-    requiredExtensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
+        requiredExtensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
 #endif
 
 #ifdef __linux__
-    requiredExtensions.push_back(VK_KHR_XCB_SURFACE_EXTENSION_NAME);
+        requiredExtensions.push_back(VK_KHR_XCB_SURFACE_EXTENSION_NAME);
 #endif
+    }
 
 #ifdef DEBUG
     requiredExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -254,8 +378,12 @@ bool VulkanContext::selectVideoCard() noexcept
             }
         }
 
+//      lavapipe and the other software rasterizers have neither type, the headless benchmarks run on them
+        if (!m_physicalDevice)
+            m_physicalDevice = devices[0];
+
         VkPhysicalDeviceProperties properties;
-        vkGetPhysicalDeviceProperties(devices[i], &properties);
+        vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
         spdlog::info("The physical device is selected: {}, type: {}", properties.deviceName, magic_enum::enum_name(properties.deviceType));
     }
 
@@ -274,6 +402,14 @@ bool VulkanContext::createDevice() noexcept
 
     enabledFeatures.samplerAnisotropy = supportedFeatures.samplerAnisotropy;
     enabledFeatures.fillModeNonSolid = supportedFeatures.fillModeNonSolid;
+    enabledFeatures.shaderSampledImageArrayDynamicIndexing = supportedFeatures.shaderSampledImageArrayDynamicIndexing;
+
+//  the draws of the recording threads run in secondary command buffers, the statistics are useless without them
+    m_pipelineStatistics = supportedFeatures.pipelineStatisticsQuery && supportedFeatures.inheritedQueries;
+    enabledFeatures.pipelineStatisticsQuery = m_pipelineStatistics;
+    enabledFeatures.inheritedQueries        = m_pipelineStatistics;
+
+    uint32_t timestampBits = 0;
 
     {// Find main queue family index
         uint32_t queueFamilyCount;
@@ -292,30 +428,63 @@ bool VulkanContext::createDevice() noexcept
                     magic_enum::enum_name(VK_QUEUE_GRAPHICS_BIT), magic_enum::enum_name(VK_QUEUE_TRANSFER_BIT));
 
                 m_queueFamilyIndex = i;
+                timestampBits = queueFamilies[i].timestampValidBits;
+                break;
+            }
+        }
+
+//      a family without graphics and compute is usually backed by the copy engines of the GPU
+        m_transferQueueFamilyIndex = m_queueFamilyIndex;
+
+        for (uint32_t i = 0; i < queueFamilyCount; ++i)
+        {
+            const VkQueueFlags flags = queueFamilies[i].queueFlags;
+
+            if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+            {
+                m_transferQueueFamilyIndex = i;
                 break;
             }
         }
+
+        if (m_transferQueueFamilyIndex != m_queueFamilyIndex)
+            spdlog::info("The dedicated transfer queue family index is selected: {}", m_transferQueueFamilyIndex);
+        else
+            spdlog::info("No dedicated transfer queue family, transfers use the main queue");
     }
 
     if (m_queueFamilyIndex != UINT32_MAX)
     {
         const float queuePriority = 1.0f;
 
-        const VkDeviceQueueCreateInfo queueInfo = 
+        const std::array<VkDeviceQueueCreateInfo, 2> queueInfos = 
         {
-            .sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-            .pNext            = VK_NULL_HANDLE,
-            .flags            = 0,
-            .queueFamilyIndex = m_queueFamilyIndex,
-            .queueCount       = 1,
-            .pQueuePriorities = &queuePriority
+            VkDeviceQueueCreateInfo
+            {
+                .sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                .pNext            = VK_NULL_HANDLE,
+                .flags            = 0,
+                .queueFamilyIndex = m_queueFamilyIndex,
+                .queueCount       = 1,
+                .pQueuePriorities = &queuePriority
+            },
+            VkDeviceQueueCreateInfo
+            {
+                .sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                .pNext            = VK_NULL_HANDLE,
+                .flags            = 0,
+                .queueFamilyIndex = m_transferQueueFamilyIndex,
+                .queueCount       = 1,
+                .pQueuePriorities = &queuePriority
+            }
         };
 
-        const std::array<const char*, 2> requiredExtensions = 
-        {
-            VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-            VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME
-        };
+        const uint32_t queueInfoCount = (m_transferQueueFamilyIndex != m_queueFamilyIndex) ? 2 : 1;
+
+        std::vector<const char*> requiredExtensions = { VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME };
+
+        if (!m_headless)
+            requiredExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 
         for (const char* ext : requiredExtensions)
             spdlog::info("Required device extension: {}", ext);
@@ -344,9 +513,57 @@ bool VulkanContext::createDevice() noexcept
             }
         }
 
-        const VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeature = 
+        std::vector<const char*> enabledExtensions(requiredExtensions.begin(), requiredExtensions.end());
+
+//      bindless textures, descriptor indexing is core since 1.2 and an extension before
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+
+        const bool indexingExtension = deviceExtensions.contains(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+
+        VkPhysicalDeviceDescriptorIndexingFeatures supportedIndexing = 
+        {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
+            .pNext = VK_NULL_HANDLE
+        };
+
+        if (properties.apiVersion >= VK_API_VERSION_1_2 || indexingExtension)
+        {
+            VkPhysicalDeviceFeatures2 features = 
+            {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                .pNext = &supportedIndexing
+            };
+
+            vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features);
+        }
+
+//      a texture slot is written once its texture is resident, meanwhile the frames in flight read the other slots
+        const bool bindless = supportedFeatures.shaderSampledImageArrayDynamicIndexing &&
+                              supportedIndexing.runtimeDescriptorArray &&
+                              supportedIndexing.descriptorBindingPartiallyBound &&
+                              supportedIndexing.descriptorBindingVariableDescriptorCount &&
+                              supportedIndexing.descriptorBindingSampledImageUpdateAfterBind &&
+                              supportedIndexing.descriptorBindingUpdateUnusedWhilePending;
+
+        VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = 
+        {
+            .sType                                        = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
+            .pNext                                        = VK_NULL_HANDLE,
+            .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+            .descriptorBindingUpdateUnusedWhilePending    = VK_TRUE,
+            .descriptorBindingPartiallyBound              = VK_TRUE,
+            .descriptorBindingVariableDescriptorCount     = VK_TRUE,
+            .runtimeDescriptorArray                       = VK_TRUE
+        };
+
+        if (bindless && properties.apiVersion < VK_API_VERSION_1_2)
+            enabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+
+        VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeature = 
         {
             .sType            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR,
+            .pNext            = bindless ? &indexingFeatures : VK_NULL_HANDLE,
             .dynamicRendering = VK_TRUE
         };
 
@@ -355,12 +572,12 @@ bool VulkanContext::createDevice() noexcept
             .sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
             .pNext                   = &dynamicRenderingFeature,
             .flags                   = 0,
-            .queueCreateInfoCount    = 1,
-            .pQueueCreateInfos       = &queueInfo,
+            .queueCreateInfoCount    = queueInfoCount,
+            .pQueueCreateInfos       = queueInfos.data(),
             .enabledLayerCount       = 0,
             .ppEnabledLayerNames     = VK_NULL_HANDLE,
-            .enabledExtensionCount   = static_cast<uint32_t>(requiredExtensions.size()),
-            .ppEnabledExtensionNames = requiredExtensions.data(),
+            .enabledExtensionCount   = static_cast<uint32_t>(enabledExtensions.size()),
+            .ppEnabledExtensionNames = enabledExtensions.data(),
             .pEnabledFeatures        = &enabledFeatures
         };
 #ifdef DEBUG
@@ -374,6 +591,39 @@ bool VulkanContext::createDevice() noexcept
         {
             spdlog::info("Initialization of the device has been completed with the result: {}", magic_enum::enum_name(result));
             vkGetDeviceQueue(m_logicalDevice, m_queueFamilyIndex, 0, &m_queue);
+            vkGetDeviceQueue(m_logicalDevice, m_transferQueueFamilyIndex, 0, &m_transferQueue);
+
+            m_timestampPeriod    = timestampBits ? properties.limits.timestampPeriod : 0.f;
+            m_timestampValidBits = timestampBits;
+            spdlog::info("Timestamps on the main queue: {}", m_timestampPeriod ? "supported" : "not supported");
+            spdlog::info("Pipeline statistics queries: {}", m_pipelineStatistics ? "supported" : "not supported");
+
+            if (bindless)
+            {
+                VkPhysicalDeviceDescriptorIndexingProperties indexingProperties = 
+                {
+                    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES,
+                    .pNext = VK_NULL_HANDLE
+                };
+
+                VkPhysicalDeviceProperties2 properties2 = 
+                {
+                    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                    .pNext = &indexingProperties
+                };
+
+                vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties2);
+
+                m_bindlessTextureLimit = std::min({ indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                                                    indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+                                                    indexingProperties.maxPerStageUpdateAfterBindResources });
+
+                spdlog::info("Descriptor indexing is enabled, up to {} textures in a bindless array", m_bindlessTextureLimit);
+            }
+            else
+            {
+                spdlog::info("Descriptor indexing is not supported, textures are bound per descriptor set");
+            }
 
             return static_cast<void*>(m_logicalDevice);
         }
@@ -386,4 +636,93 @@ bool VulkanContext::createDevice() noexcept
     spdlog::error("A suitable graphics queue was not found.");
 
     return false;
+}
+
+
+bool VulkanContext::createPipelineCache() noexcept
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+
+    const std::filesystem::path path = getPipelineCachePath();
+    std::vector<char> data;
+
+    if (std::ifstream file(path, std::ios::binary | std::ios::ate); file)
+    {
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+
+        if (!file.read(data.data(), static_cast<std::streamsize>(data.size())))
+            data.clear();
+    }
+
+//  the driver is allowed to crash on foreign data, so the header is checked before the data is handed over
+    if (!data.empty())
+    {
+        VkPipelineCacheHeaderVersionOne header = {};
+
+        if (data.size() >= sizeof(header))
+            memcpy(&header, data.data(), sizeof(header));
+
+        const bool valid = header.headerSize >= sizeof(header) &&
+                           header.headerSize <= data.size() &&
+                           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                           header.vendorID == properties.vendorID &&
+                           header.deviceID == properties.deviceID &&
+                           memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+
+        if (!valid)
+        {
+            spdlog::warn("Pipeline cache: {} does not match the device or the driver, it is discarded", path.string());
+            data.clear();
+        }
+    }
+
+    VkPipelineCacheCreateInfo cacheInfo = 
+    {
+        .sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext           = VK_NULL_HANDLE,
+        .flags           = 0,
+        .initialDataSize = data.size(),
+        .pInitialData    = data.empty() ? VK_NULL_HANDLE : data.data()
+    };
+
+    VkResult result = vkCreatePipelineCache(m_logicalDevice, &cacheInfo, VK_NULL_HANDLE, &m_pipelineCache);
+
+//  the driver may still reject the data, an empty cache is always accepted
+    if (result != VK_SUCCESS && !data.empty())
+    {
+        data.clear();
+
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData    = VK_NULL_HANDLE;
+
+        result = vkCreatePipelineCache(m_logicalDevice, &cacheInfo, VK_NULL_HANDLE, &m_pipelineCache);
+    }
+
+    if (result != VK_SUCCESS)
+    {
+        spdlog::error("Pipeline cache: creation failed with the result: {}", magic_enum::enum_name(result));
+
+        return false;
+    }
+
+    m_pipelineCacheWarm = !data.empty();
+    spdlog::info("Pipeline cache: {}, {} bytes loaded from {}", m_pipelineCacheWarm ? "warm" : "cold", data.size(), path.string());
+
+    return true;
+}
+
+
+std::filesystem::path VulkanContext::getPipelineCachePath() const noexcept
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+
+    std::string uuid;
+
+    for (uint8_t byte : properties.pipelineCacheUUID)
+        uuid += fmt::format("{:02x}", byte);
+
+    return std::filesystem::path("cache") / fmt::format("pipeline_{:04x}_{:04x}_{}.bin", properties.vendorID, properties.deviceID, uuid);
 }
\ No newline at end of file
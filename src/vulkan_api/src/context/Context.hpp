@@ -1,6 +1,7 @@
 #pragma once
 
 #include <type_traits>
+#include <filesystem>
 
 #include <vulkan/vulkan.h>
 
@@ -9,7 +10,8 @@ class VulkanContext final
 public:
     VulkanContext() noexcept;
 
-    bool create() noexcept;
+//  Headless - no surface extensions, the views can only be offscreen
+    bool create(bool headless = false) noexcept;
     void destroy() noexcept;
 
     template<class T> 
@@ -27,23 +29,58 @@ public:
         if constexpr (std::is_same_v<T, VkQueue>)
 		    return m_queue;
 
+        if constexpr (std::is_same_v<T, VkPipelineCache>)
+		    return m_pipelineCache;
+
         return {};
     }
 
     uint32_t getQueueFamilyIndex() const noexcept;
 
+//  A queue of a transfer only family if the device has one, the main queue otherwise
+    VkQueue  getTransferQueue()            const noexcept;
+    uint32_t getTransferQueueFamilyIndex() const noexcept;
+
+//  Size limit of a bindless texture array, 0 - descriptor indexing is not enabled on the device
+    uint32_t getBindlessTextureLimit() const noexcept;
+
+//  Nanoseconds per timestamp tick, 0 - the main queue does not write timestamps
+    float getTimestampPeriod() const noexcept;
+    uint32_t getTimestampValidBits() const noexcept; // of the main queue, the ticks wrap past them
+
+//  Pipeline statistics queries, also active across the secondary command buffers executed while they run
+    bool isPipelineStatisticsSupported() const noexcept;
+
+//  Writes the pipeline cache next to the logs, the next launch of the same device and driver starts warm
+    bool savePipelineCache() const noexcept;
+    bool isPipelineCacheWarm() const noexcept;
+
+    bool isHeadless() const noexcept;
+
     static VulkanContext* getContext() noexcept;
 
 private:
     bool createInstance()  noexcept;
     bool selectVideoCard() noexcept;
     bool createDevice()    noexcept;
+    bool createPipelineCache() noexcept;
+
+    std::filesystem::path getPipelineCachePath() const noexcept;
 
     VkInstance       m_instance;
     VkPhysicalDevice m_physicalDevice;
     VkDevice         m_logicalDevice;
     VkQueue          m_queue;
     uint32_t         m_queueFamilyIndex;
+    VkQueue          m_transferQueue;
+    uint32_t         m_transferQueueFamilyIndex;
+    VkPipelineCache  m_pipelineCache;
+    bool             m_pipelineCacheWarm;
+    uint32_t         m_bindlessTextureLimit;
+    float            m_timestampPeriod;
+    uint32_t         m_timestampValidBits;
+    bool             m_pipelineStatistics;
+    bool             m_headless;
 };
 
 #define vkContext VulkanContext::getContext()
\ No newline at end of file
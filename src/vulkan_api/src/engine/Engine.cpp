@@ -1,15 +1,50 @@
 #include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 
 #include <cglm/struct/affine-pre.h>
 #include "spdlog/spdlog.h"
 #include <spdlog/sinks/basic_file_sink.h>
 
+#include "files/StbImage.hpp"
+#include "utils/CpuProfiler.hpp"
 #include "view/swapchain/Swapchain.hpp"
-#include "pipeline/descriptors/DescriptorSetLayout.hpp"
 #include "pipeline/state/PipelineState.hpp"
 #include "engine/Engine.hpp"
 
 
+// layout of the uniform block of the shaders, the vertex shader only declares viewProjection
+struct SceneUniforms
+{
+    mat4s    viewProjection;
+    uint32_t shading[4]; // iterations and detail of the generic benchmark_shading pipeline
+};
+
+
+// push constant block of vertex_push_constants.vert
+struct DrawConstants
+{
+    mat4s    model;
+    uint32_t material;
+};
+
+// the tail padding of the struct is not part of the block
+static constexpr uint32_t draw_constants_size = offsetof(DrawConstants, material) + sizeof(uint32_t);
+
+
+// uniform block of vertex_uniform_per_draw.vert, written once per draw
+struct DrawUniforms
+{
+    SceneUniforms scene;
+    DrawConstants draw;
+};
+
+
+// slots of the bindless texture array, the array is partially bound and only the written slots cost memory
+static constexpr uint32_t bindless_texture_capacity = 4096;
+
+
 // world space positions of our cubes
 static const vec3s cubePositions[10] = 
 {
@@ -26,20 +61,72 @@ static const vec3s cubePositions[10] =
 };
 
 
-Engine::Engine() noexcept
+static std::vector<mat4s> create_instance_transforms(uint32_t count) noexcept
 {
+    std::vector<mat4s> transforms(count);
+    const vec3s axis = { 1.0f, 0.3f, 0.5f };
+
+//  the first cubes keep their hand placed positions, the rest fill a cube shaped grid behind them
+    const uint32_t side = static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<float>(count))));
+    const float spacing = 2.f;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        vec3s position;
 
+        if (i < std::size(cubePositions))
+        {
+            position = cubePositions[i];
+        }
+        else
+        {
+            position.x = (static_cast<float>(i % side) - side * 0.5f) * spacing;
+            position.y = (static_cast<float>((i / side) % side) - side * 0.5f) * spacing;
+            position.z = -20.f - static_cast<float>(i / (side * side)) * spacing;
+        }
+
+        const mat4s model = glms_translate(glms_mat4_identity(), position);
+        transforms[i] = glms_rotate(model, glm_rad(20.f * i), axis);
+    }
+
+    return transforms;
 }
 
 
-bool Engine::createContext() noexcept
+Engine::Engine() noexcept:
+    m_cubeTexture(0),
+    m_bindless(true),
+    m_drawPath(DrawPath::Instanced),
+    m_gpuStatistics(false),
+    m_framebufferResized(false),
+    m_width(0),
+    m_height(0),
+    m_framesInFlight(2),
+    m_instanceCount(static_cast<uint32_t>(std::size(cubePositions))),
+    m_recordingThreads(0),
+    m_lastFrameStats{},
+    m_presentedFrames(0),
+    m_lastFrame(0)
 {
+
+}
+
+
+bool Engine::createContext(bool headless) noexcept
+{
+    CPU_PROFILE_THREAD("main");
+
+    m_startTime = std::chrono::steady_clock::now();
+
     auto logger = spdlog::basic_logger_mt("logger", "logs/log.txt", true);
     logger->set_level(spdlog::level::debug);
     spdlog::set_default_logger(logger);
     spdlog::info("Start logging messages");
 
-    if (!m_context.create())
+    if (!m_context.create(headless))
+        return false;
+
+    if (!m_allocator.create())
         return false;
 
     return true;
@@ -48,129 +135,184 @@ bool Engine::createContext() noexcept
 
 bool Engine::createMainView(uint64_t windowHandle) noexcept
 {
+    if (m_context.isHeadless())
+    {
+        spdlog::error("A headless context has no surface extensions, only an offscreen view can be created");
+
+        return false;
+    }
+
     if (!m_view.create(windowHandle))
         return false;
 
-    if (!m_sync.create())
-		return false;
+    return createFrameResources();
+}
 
-    return true;
+
+bool Engine::createOffscreenView(uint32_t width, uint32_t height) noexcept
+{
+    if (width == 0 || height == 0)
+        return false;
+
+//  an image per frame in flight, a frame never waits for an image the presentation engine holds
+    if (!m_view.createOffscreen({ width, height }, m_framesInFlight))
+        return false;
+
+    m_width  = static_cast<int32_t>(width);
+    m_height = static_cast<int32_t>(height);
+
+    spdlog::info("Offscreen view: {}x{}, {} images", width, height, m_framesInFlight);
+
+    return createFrameResources();
 }
 
 
-bool Engine::createPipeline() noexcept
+bool Engine::createFrameResources() noexcept
 {
-	VkDevice device = m_context.get<VkDevice>();
+    if (!m_sync.create(m_framesInFlight, static_cast<uint32_t>(m_view.getSwapchain()->getImageCount())))
+		return false;
 
-	{// Pipeline
-		std::array<Shader, 2> shaders = { Shader(device), Shader(device) };
+    spdlog::info("Frames in flight: {}", m_framesInFlight);
+
+    if (m_recordingThreads)
+    {
+//      one slice of the draw list per thread, the main thread records a slice too
+        if (!m_jobs.create(m_recordingThreads))
+            return false;
 
-        const auto vertPath = m_fileProvider.findPathToFile("vertex_shader.spv");
-        const auto fragPath = m_fileProvider.findPathToFile("fragment_shader.spv");
+        if (!m_secondaryCommands.create(m_framesInFlight, m_jobs.getThreadCount()))
+            return false;
+    }
 
-		if (!shaders[0].loadFromFile(vertPath, VK_SHADER_STAGE_VERTEX_BIT))
-			return false;
+    spdlog::info("Command recording threads: {}", m_recordingThreads ? m_jobs.getThreadCount() : 0);
 
-		if (!shaders[1].loadFromFile(fragPath, VK_SHADER_STAGE_FRAGMENT_BIT))
-			return false;
+    if (!m_gpuProfiler.create(m_framesInFlight, m_gpuStatistics))
+        return false;
 
-        std::array<const VertexInputState::AttributeType, 2> attributes =
+    m_renderer.profiler = &m_gpuProfiler;
+
+    return true;
+}
+
+
+bool Engine::createPipeline() noexcept
+{
+	{// Pipeline
+        constexpr std::array<const char*, 3> vertexShaders =
+        {
+            "shaders/vertex_shader.spv",
+            "shaders/vertex_push_constants.spv",
+            "shaders/vertex_uniform_per_draw.spv"
+        };
+
+        std::array<ShaderReloader::Stage, 2> stages =
         {
-            VertexInputState::Float3,
-            VertexInputState::Float2
+            ShaderReloader::Stage { vertexShaders[static_cast<uint32_t>(m_drawPath)], VK_SHADER_STAGE_VERTEX_BIT },
+            ShaderReloader::Stage { "shaders/fragment_shader.spv",                    VK_SHADER_STAGE_FRAGMENT_BIT }
         };
 
-        DescriptorSetLayout uniformDescriptors;
-        uniformDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT);
-        uniformDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+//      the descriptor set layout and the vertex input are reflected from the shaders
+        PipelineInterface interface;
+        interface.instanceLocation      = 2;    // inModel, read from m_instanceBuffer
+        interface.dynamicUniformBuffers = true; // bound at their offset in m_uniforms
 
         PipelineState pipelineState;
-        pipelineState.setupShaderStages(shaders, attributes);
         pipelineState.setupInputAssembler(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
         pipelineState.setupViewport();
         pipelineState.setupRasterization(VK_POLYGON_MODE_FILL);
         pipelineState.setupMultisampling();
         pipelineState.setupColorBlending(VK_FALSE);
-        pipelineState.layoutInfo = uniformDescriptors.getInfo();
-            
-		if (!m_pipeline.create(pipelineState))
-			return false;
-	}
+        pipelineState.setupAttachmentFormats(m_view.getSwapchain()->getColorAttachment(0).format, m_view.getSwapchain()->getDepthAttachment().format);
 
-	{// Descriptors
-		const std::array<VkDescriptorPoolSize, 2> poolSizes = 
-		{
-			VkDescriptorPoolSize
-			{
-				.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-				.descriptorCount = MAX_FRAMES_IN_FLIGHT
-			},
-            VkDescriptorPoolSize
-			{
-				.type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-				.descriptorCount = MAX_FRAMES_IN_FLIGHT
-			}
-		};
-
-		if (!m_descriptorPool.create(poolSizes))
-			return false;
+        if (m_shadingBenchmark.iterations)
+        {
+            stages[1].path = "shaders/benchmark_shading.spv";
+
+//          left unset the shader falls back to the parameters of the uniform buffer
+            if (m_shadingBenchmark.specialized)
+            {
+                pipelineState.specialization.set(0, m_shadingBenchmark.iterations);
+                pipelineState.specialization.set(1, m_shadingBenchmark.detail);
+            }
 
-		VkDescriptorSetLayout layouts[MAX_FRAMES_IN_FLIGHT] = 
-		{ 
-			m_pipeline.descriptorSetLayout, 
-			m_pipeline.descriptorSetLayout 
-		};
+            spdlog::info("Shading benchmark: {} iterations, detail {}, {} pipeline",
+                         m_shadingBenchmark.iterations, m_shadingBenchmark.detail ? "on" : "off", m_shadingBenchmark.specialized ? "specialized" : "generic");
+        }
+
+        if (m_bindless && m_shadingBenchmark.iterations)
+        {
+            spdlog::info("Bindless textures: not used by the shading benchmark, its shader samples the texture of set 0");
+            m_bindless = false;
+        }
+
+        if (m_bindless && !vkContext->getBindlessTextureLimit())
+        {
+            spdlog::info("Bindless textures: the device does not support descriptor indexing, the texture is bound per frame instead");
+            m_bindless = false;
+        }
+
+//      set 1 holds every texture, the fragment shader picks one with the material of the draw
+        if (m_bindless)
+        {
+            if (!m_bindlessTextures.create(bindless_texture_capacity))
+                return false;
 
-		if (!m_descriptorPool.allocateDescriptorSets(m_descriptorSets, layouts))
-			return false;	
+            stages[1].path = "shaders/fragment_bindless.spv";
+            interface.bindlessTextures = true;
+            pipelineState.textureSetLayout = m_bindlessTextures.layout;
+        }
+
+        if (!m_pipelineLibrary.create())
+            return false;
+
+        if (!m_shaderReloader.create(&m_pipelineLibrary, m_framesInFlight))
+            return false;
+
+//      the shader stages are loaded and kept up to date by the reloader
+		if (!m_shaderReloader.add(stages, pipelineState, interface, &m_pipeline))
+			return false;
 	}
 
-	if (!m_commandPool.create())
+//  the sets are allocated and written on first use, a set with the same contents is shared by every frame
+    if (!m_descriptors.create(m_framesInFlight))
         return false;
 
-    {
-        m_uniformBuffers.resize(vkView->getSwapchain()->getImageCount());
-        std::array<mat4s, 1> identity = { glms_mat4_identity() };
+	if (!m_commandPool.create(m_framesInFlight))
+        return false;
 
-        for (size_t i = 0; i < m_uniformBuffers.size(); ++i) 
-            m_uniformBuffers[i] = m_bufferHolder.allocate<mat4s>(identity,
-                                                                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
-                                                                 m_commandPool.handle);
-    }
+    if (!m_staging.create())
+        return false;
 
-	{
-        const auto imagePath = FileProvider::findPathToFile("container.jpg");
+//  a block per draw and the scene block, minUniformBufferOffsetAlignment is at most 256
+    const VkDeviceSize drawBlockSize   = (sizeof(DrawUniforms) + 255) / 256 * 256;
+    const VkDeviceSize uniformCapacity = (m_drawPath == DrawPath::UniformPerDraw) ? (m_instanceCount + 1) * drawBlockSize : 0;
 
-        if(!m_texture.loadFromFile(imagePath, m_commandPool.handle))
+    if (!m_uniforms.create(m_framesInFlight, std::max<VkDeviceSize>(uniformCapacity, 1024 * 1024)))
+        return false;
+
+	{
+        if (!m_textures.create())
             return false;
 
-        const std::array<VkDescriptorBufferInfo, 2> bufferInfos = 
-        {
-            VkDescriptorBufferInfo
-            {
-                .buffer = m_uniformBuffers[0].handle,
-                .offset = 0,
-                .range = sizeof(mat4s)
-            },
-            VkDescriptorBufferInfo
-            {
-                .buffer = m_uniformBuffers[1].handle,
-                .offset = 0,
-                .range = sizeof(mat4s)
-            }
-        };
-                
-        const VkDescriptorImageInfo imageInfo = 
+//      the cooked texture is preferred, the source image is the fallback when the cooker did not run
+        auto imagePath = FileProvider::findPathToFile("textures/container.ctex");
+
+        if (imagePath.empty())
+            imagePath = FileProvider::findPathToFile("textures/container.jpg");
+
+        m_cubeTexture = m_textures.load(imagePath);
+
+        if (!m_textureDirectory.empty())
+            m_textures.loadDirectory(m_textureDirectory);
+
+        if (m_bindless)
         {
-            .sampler     = m_texture.sampler,
-            .imageView   = m_texture.imageView,
-            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-        };
+//          nothing is resident before the first update(), get() returns the placeholder
+            const Texture2D& placeholder = m_textures.get(m_cubeTexture);
 
-		m_descriptorPool.writeBufferInfo(bufferInfos.data(), m_descriptorSets[0], 0);
-		m_descriptorPool.writeBufferInfo(bufferInfos.data() + 1, m_descriptorSets[1], 0);
-		m_descriptorPool.writeCombinedImageSampler(&imageInfo, m_descriptorSets[0], 1);
-		m_descriptorPool.writeCombinedImageSampler(&imageInfo, m_descriptorSets[1], 1);
+            m_bindlessTextures.write(m_descriptorWriter, BindlessTextures::placeholder_slot, { placeholder.sampler, placeholder.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+            m_descriptorWriter.flush();
+        }
     }
 
 	{
@@ -217,8 +359,8 @@ bool Engine::createPipeline() noexcept
             20, 21, 22, 22, 23, 20   // bottom
         };
 
-		m_vertexBuffer = m_bufferHolder.allocate<float>(vertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, m_commandPool.handle);
-		m_indexBuffer = m_bufferHolder.allocate<uint32_t>(indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, m_commandPool.handle);
+		m_vertexBuffer = m_bufferHolder.allocate<float>(vertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, m_staging);
+		m_indexBuffer = m_bufferHolder.allocate<uint32_t>(indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, m_staging);
 
 		if (!m_vertexBuffer.handle)
 			return false;
@@ -227,12 +369,27 @@ bool Engine::createPipeline() noexcept
 			return false;
 	}
 
+    {// Instances
+        m_transforms = create_instance_transforms(m_instanceCount);
+        m_instanceBuffer = m_bufferHolder.allocate<mat4s>(m_transforms, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, m_staging);
+
+        if (!m_instanceBuffer.handle)
+            return false;
+
+        constexpr std::array<const char*, 3> drawPaths = { "instanced", "push constants per draw", "uniform block per draw" };
+        spdlog::info("Scene instances: {}, drawn {}", m_instanceCount, drawPaths[static_cast<uint32_t>(m_drawPath)]);
+    }
+
+    m_staging.flush();
+
 	return true;
 }
 
 
 void Engine::drawFrame() noexcept
 {
+    CPU_PROFILE_SCOPE("Engine::drawFrame");
+
     if ( ! (m_width && m_height) )
         return;
 
@@ -240,7 +397,10 @@ void Engine::drawFrame() noexcept
     const auto logicalDevice = vkContext->get<VkDevice>();
     const auto queue = vkContext->get<VkQueue>();
 
+//  the CPU only blocks here when it is a whole ring of frames ahead of the GPU
+    const auto waitStart = std::chrono::steady_clock::now();
     VkResult result = vkWaitForFences(logicalDevice, 1, &m_sync.inFlightFences[frame], VK_TRUE, UINT64_MAX);
+    const auto frameStart = std::chrono::steady_clock::now();
 
 	if (result != VK_SUCCESS)
     {
@@ -250,24 +410,128 @@ void Engine::drawFrame() noexcept
 		return;
     }
 
-    uint32_t imageIndex;
-    result = vkAcquireNextImageKHR(logicalDevice, m_view.getSwapchain()->getHandle(), UINT64_MAX, m_sync.imageAvailableSemaphores[frame], VK_NULL_HANDLE, &imageIndex);
+//  the transient descriptor sets of this frame are idle now, a rebuilt pipeline can be swapped in
+//  done before the acquire, a failure leaves no image acquired and no semaphore signaled
+    m_fileProvider.update();
+    m_shaderReloader.update(m_fileProvider.getChangedFiles());
+    m_textures.update();
+    m_descriptors.beginFrame(frame);
+
+    if (m_bindless)
+        publishTextures();
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR)
+//  a texture which became resident selects another cached set, the sets in use by the frames in flight are left as they are
+    VkDescriptorSet descriptorSet = getDescriptorSet();
+
+    if (!descriptorSet)
     {
-        vkDeviceWaitIdle(logicalDevice);
-		m_view.resize();
+#ifdef DEBUG
+        printf("failed to allocate a descriptor set!\n");
+#endif
+		return;
+    }
+
+    mat4s projection = glms_perspective(glm_rad(60.f), m_width / (float)m_height, 0.1f, 1000.f);
+    mat4s viewMatrix  = camera.getViewMatrix();
+
+//  update matrices, the model matrices are per instance attributes
+    const SceneUniforms uniforms =
+    {
+        .viewProjection = glms_mat4_mul(projection, viewMatrix),
+        .shading        = { m_shadingBenchmark.iterations, m_shadingBenchmark.detail ? 1u : 0u, 0, 0 }
+    };
 
+    m_uniforms.beginFrame(frame);
+    const uint32_t uniformOffset = m_uniforms.push(uniforms);
+
+//  the blocks of every draw are written before the recording threads start, the arena is not thread safe
+    bool uniformsWritten = (uniformOffset != UINT32_MAX);
+
+    if (m_drawPath == DrawPath::UniformPerDraw)
+    {
+        m_drawOffsets.resize(m_transforms.size());
+
+        for (size_t i = 0; i < m_transforms.size() && uniformsWritten; ++i)
+        {
+            m_drawOffsets[i] = m_uniforms.push(DrawUniforms{ uniforms, { m_transforms[i], getMaterial(i) } });
+            uniformsWritten  = (m_drawOffsets[i] != UINT32_MAX);
+        }
+    }
+
+//  a full arena would leave offsets out of the buffer range, the frame is skipped before the acquire and the fence reset
+    if (!uniformsWritten)
         return;
+
+    const uint32_t sliceCount = m_secondaryCommands.sliceCount;
+
+//  the secondaries inherit the formats, not the image, they are recorded before the acquire and the fence reset so a
+//  failure leaves neither an acquired image nor a fence which is never signaled again
+    if (sliceCount)
+    {
+        const auto recordStart = std::chrono::steady_clock::now();
+        std::atomic<bool> recorded = true;
+
+//      every slice draws its own range of instances into the secondary command buffer of its pool
+        m_jobs.dispatch(sliceCount, [&](uint32_t slice)
+        {
+            const uint32_t firstInstance = static_cast<uint32_t>(uint64_t(m_instanceBuffer.size) * slice / sliceCount);
+            const uint32_t lastInstance  = static_cast<uint32_t>(uint64_t(m_instanceBuffer.size) * (slice + 1) / sliceCount);
+
+            VkCommandBuffer secondary = m_secondaryCommands.reset(frame, slice);
+
+            if (!secondary || !m_renderer.beginSecondary(secondary))
+            {
+                recorded = false;
+                return;
+            }
+
+            recordDraws(secondary, descriptorSet, uniformOffset, firstInstance, lastInstance - firstInstance);
+
+            if (vkEndCommandBuffer(secondary) != VK_SUCCESS)
+                recorded = false;
+        });
+
+        if (!recorded)
+        {
+#ifdef DEBUG
+            printf("failed to record secondary command buffers!\n");
+#endif
+            return;
+        }
+
+        m_lastFrameStats.recordTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
     }
-    else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+
+    const bool offscreen = m_view.getSwapchain()->isOffscreen();
+
+//  the offscreen images belong to the frames in flight, the fence above guards the image as well
+    uint32_t imageIndex = frame;
+
+    if (!offscreen)
     {
+        result = vkAcquireNextImageKHR(logicalDevice, m_view.getSwapchain()->getHandle(), UINT64_MAX, m_sync.imageAvailableSemaphores[frame], VK_NULL_HANDLE, &imageIndex);
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            recreateSwapchain();
+
+            return;
+        }
+        else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+        {
 #ifdef DEBUG
-        printf("failed to acquire swap chain image!\n");
+            printf("failed to acquire swap chain image!\n");
 #endif
-		return;
+            return;
+        }
     }
 
+//  a swapchain image may still be rendered by a frame in flight other than this one
+    if (VkFence imageFence = m_sync.imagesInFlight[imageIndex]; imageFence && imageFence != m_sync.inFlightFences[frame])
+        vkWaitForFences(logicalDevice, 1, &imageFence, VK_TRUE, UINT64_MAX);
+
+    m_sync.imagesInFlight[imageIndex] = m_sync.inFlightFences[frame];
+
     result = vkResetFences(logicalDevice, 1, &m_sync.inFlightFences[frame]);
 
 	if (result != VK_SUCCESS)
@@ -279,52 +543,42 @@ void Engine::drawFrame() noexcept
     }
 
     VkCommandBuffer commandBuffer = m_commandPool.commandBuffers[frame];
-    VkDescriptorSet descriptorSet = m_descriptorSets[frame];
 
-    if (!m_renderer.begin(commandBuffer, imageIndex))
+    if (!m_renderer.begin(commandBuffer, frame, imageIndex, sliceCount ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0))
         return;
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.handle);
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.layout, 0, 1, &descriptorSet, 0, VK_NULL_HANDLE);
-
-    mat4s projection = glms_perspective(glm_rad(60.f), m_width / (float)m_height, 0.1f, 100.f);
-    mat4s viewMatrix  = camera.getViewMatrix();
-    vec3s axis = { 1.0f, 0.3f, 0.5f };
-
-//  update matrices
-    mat4s model = glms_translate(glms_mat4_identity(), cubePositions[0]);
-    model       = glms_rotate(model, glm_rad(0), axis);
-    mat4s modelViewProjection = glms_mat4_mul(glms_mat4_mul(projection, viewMatrix), model);
-
-    void* data;
-    vkMapMemory(logicalDevice, m_uniformBuffers[imageIndex].memory, 0, sizeof(mat4s), 0, &data);
-    memcpy(data, &modelViewProjection, sizeof(mat4s));
-    vkUnmapMemory(logicalDevice, m_uniformBuffers[imageIndex].memory);
-
 //  write command buffer
-    VkDeviceSize offsets[] = {0};
-    VkBuffer vertexBuffers[] = { m_vertexBuffer.handle };
+    if (sliceCount == 0)
+    {
+        const auto recordStart = std::chrono::steady_clock::now();
 
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-    vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer.handle, 0, VK_INDEX_TYPE_UINT32);
-    vkCmdDrawIndexed(commandBuffer, m_indexBuffer.size, 1, 0, 0, 0);
+        recordDraws(commandBuffer, descriptorSet, uniformOffset, 0, m_instanceBuffer.size);
+        m_lastFrameStats.recordTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
+    }
+    else
+    {
+        vkCmdExecuteCommands(commandBuffer, sliceCount, m_secondaryCommands.getCommandBuffers(frame));
+    }
 
     if (!m_renderer.end(commandBuffer, imageIndex))
         return;
 
+//  uploads requested since the last frame go to the queue before the frame that uses them
+    m_staging.flush();
+
     VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 	
     const VkSubmitInfo submitInfo = 
 	{
 		.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
 		.pNext                = VK_NULL_HANDLE,
-		.waitSemaphoreCount   = 1,
+		.waitSemaphoreCount   = offscreen ? 0u : 1u,
 		.pWaitSemaphores      = m_sync.imageAvailableSemaphores.data() + frame,
 		.pWaitDstStageMask    = waitStages,
 		.commandBufferCount   = 1,
 		.pCommandBuffers      = &m_commandPool.commandBuffers[frame],
-		.signalSemaphoreCount = 1,
-		.pSignalSemaphores    = &m_sync.renderFinishedSemaphores[frame]
+		.signalSemaphoreCount = offscreen ? 0u : 1u,
+		.pSignalSemaphores    = &m_sync.renderFinishedSemaphores[imageIndex]
 	};
 
 	result = vkQueueSubmit(queue, 1, &submitInfo, m_sync.inFlightFences[frame]);
@@ -337,25 +591,35 @@ void Engine::drawFrame() noexcept
 		return;
     }
 
-    const VkPresentInfoKHR presentInfo = 
-	{
-		.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-		.pNext              = VK_NULL_HANDLE,
-		.waitSemaphoreCount = 1,
-		.pWaitSemaphores    = &m_sync.renderFinishedSemaphores[frame],
-		.swapchainCount     = 1,
-		.pSwapchains        = &vkView->getSwapchain()->getHandle(),
-		.pImageIndices      = &imageIndex,
-		.pResults           = VK_NULL_HANDLE
-	};
+    m_lastFrame = frame;
+
+    if (!offscreen)
+    {
+        const VkPresentInfoKHR presentInfo = 
+        {
+            .sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+            .pNext              = VK_NULL_HANDLE,
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores    = &m_sync.renderFinishedSemaphores[imageIndex],
+            .swapchainCount     = 1,
+            .pSwapchains        = &vkView->getSwapchain()->getHandle(),
+            .pImageIndices      = &imageIndex,
+            .pResults           = VK_NULL_HANDLE
+        };
+
+        result = vkQueuePresentKHR(queue, &presentInfo);
+    }
+
+    m_sync.currentFrame = (frame + 1) % m_sync.framesInFlight;
+    updateFrameStatistics(waitStart, frameStart);
 
-    result = vkQueuePresentKHR(queue, &presentInfo);
+    if (m_presentedFrames++ == 0)
+        spdlog::info("Time to first frame: {:.3f} ms", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count());
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebufferResized)
     {
         m_framebufferResized = false;
-        vkDeviceWaitIdle(logicalDevice);
-		m_view.resize();
+        recreateSwapchain();
     }
     else if (result != VK_SUCCESS)
     {
@@ -364,10 +628,166 @@ void Engine::drawFrame() noexcept
 #endif
 		return;
     }
+}
 
-    m_sync.currentFrame = (frame + 1) % MAX_FRAMES_IN_FLIGHT;
 
-	vkDeviceWaitIdle(logicalDevice);
+bool Engine::saveFrame(const std::filesystem::path& path) noexcept
+{
+    const Swapchain* swapchain = m_view.getSwapchain();
+
+    if (!swapchain || !swapchain->isOffscreen() || m_presentedFrames == 0)
+    {
+        spdlog::error("Frame readback: only a frame drawn into the offscreen view can be saved");
+
+        return false;
+    }
+
+    const auto logicalDevice = vkContext->get<VkDevice>();
+    const VkExtent2D extent  = swapchain->getSize();
+    const VkDeviceSize size  = VkDeviceSize(extent.width) * extent.height * 4;
+
+//  the image is in TRANSFER_SRC_OPTIMAL once its frame has completed, see Renderer::end()
+    if (vkWaitForFences(logicalDevice, 1, &m_sync.inFlightFences[m_lastFrame], VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+        return false;
+
+    Allocation allocation;
+    VkBuffer buffer = vktools::create_buffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &allocation, logicalDevice);
+
+    if (!buffer)
+        return false;
+
+    if (VkCommandBuffer cmd = vktools::begin_single_time_commands(logicalDevice, m_commandPool.handle))
+    {
+        const VkBufferImageCopy region =
+        {
+            .bufferOffset      = 0,
+            .bufferRowLength   = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource  = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+            .imageOffset       = { 0, 0, 0 },
+            .imageExtent       = { extent.width, extent.height, 1 }
+        };
+
+        vkCmdCopyImageToBuffer(cmd, swapchain->getColorAttachment(m_lastFrame).image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &region);
+        vktools::end_single_time_commands(cmd, logicalDevice, m_commandPool.handle, vkContext->get<VkQueue>());
+    }
+
+//  the offscreen format is R8G8B8A8, the bytes are written as they are
+    const bool saved = allocation.mapped && StbImage::saveToFile(path, extent.width, extent.height, { static_cast<const uint8_t*>(allocation.mapped), size });
+
+    vktools::destroy_buffer(buffer, allocation, logicalDevice);
+
+    if (!saved)
+    {
+        spdlog::error("Frame readback: failed to write {}", path.string());
+
+        return false;
+    }
+
+    spdlog::info("Frame readback: {}x{} saved to {}", extent.width, extent.height, path.string());
+
+    return true;
+}
+
+
+void Engine::recordDraws(VkCommandBuffer cmd, VkDescriptorSet descriptorSet, uint32_t uniformOffset, uint32_t firstInstance, uint32_t instanceCount) const noexcept
+{
+    CPU_PROFILE_SCOPE("Engine::recordDraws");
+
+    if (instanceCount == 0)
+        return;
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.handle);
+    vkCmdBindIndexBuffer(cmd, m_indexBuffer.handle, 0, VK_INDEX_TYPE_UINT32);
+
+    VkDeviceSize offsets[] = { 0, 0 };
+    VkBuffer vertexBuffers[] = { m_vertexBuffer.handle, m_instanceBuffer.handle };
+
+//  bound once for every draw of the command buffer, rebinding set 0 keeps it
+    if (m_bindless)
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.layout, 1, 1, &m_bindlessTextures.set, 0, VK_NULL_HANDLE);
+
+    switch (m_drawPath)
+    {
+        case DrawPath::Instanced:
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.layout, 0, 1, &descriptorSet, 1, &uniformOffset);
+            vkCmdBindVertexBuffers(cmd, 0, 2, vertexBuffers, offsets);
+
+//          the instances of a draw share the material, the cube texture
+            if (m_bindless)
+            {
+                const uint32_t material = m_materials[m_cubeTexture];
+
+                m_pipeline.pushConstants(cmd, &material, sizeof(material), offsetof(DrawConstants, material));
+            }
+
+            vkCmdDrawIndexed(cmd, m_indexBuffer.size, instanceCount, 0, 0, firstInstance);
+            break;
+
+//      nothing is written to memory, the block travels in the command buffer
+        case DrawPath::PushConstants:
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.layout, 0, 1, &descriptorSet, 1, &uniformOffset);
+            vkCmdBindVertexBuffers(cmd, 0, 1, vertexBuffers, offsets);
+
+            for (uint32_t i = firstInstance; i < firstInstance + instanceCount; ++i)
+            {
+                const DrawConstants constants = { m_transforms[i], getMaterial(i) };
+
+                m_pipeline.pushConstants(cmd, &constants, draw_constants_size);
+                vkCmdDrawIndexed(cmd, m_indexBuffer.size, 1, 0, 0, 0);
+            }
+            break;
+
+        case DrawPath::UniformPerDraw:
+            vkCmdBindVertexBuffers(cmd, 0, 1, vertexBuffers, offsets);
+
+            for (uint32_t i = firstInstance; i < firstInstance + instanceCount; ++i)
+            {
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.layout, 0, 1, &descriptorSet, 1, &m_drawOffsets[i]);
+
+//              the fragment shader reads the material from the push constants only
+                if (m_bindless)
+                {
+                    const uint32_t material = getMaterial(i);
+
+                    m_pipeline.pushConstants(cmd, &material, sizeof(material), offsetof(DrawConstants, material));
+                }
+
+                vkCmdDrawIndexed(cmd, m_indexBuffer.size, 1, 0, 0, 0);
+            }
+            break;
+    }
+}
+
+
+FrameStatistics Engine::getFrameStatistics() const noexcept
+{
+    const auto memory = m_allocator.getStatistics();
+
+    FrameStatistics statistics = m_lastFrameStats;
+    statistics.gpuTime         = m_gpuProfiler.getFrameTime();
+    statistics.memoryReserved  = memory.bytesReserved;
+    statistics.memoryAllocated = memory.bytesAllocated;
+
+    return statistics;
+}
+
+
+std::span<const GpuScopeTiming> Engine::getGpuTimings() const noexcept
+{
+    return m_gpuProfiler.getTimings();
+}
+
+
+const GpuPipelineStatistics& Engine::getPipelineStatistics() const noexcept
+{
+    return m_gpuProfiler.getPipelineStatistics();
+}
+
+
+bool Engine::saveCpuTrace(const std::filesystem::path& path) const noexcept
+{
+    return CpuProfiler::exportTrace(path);
 }
 
 
@@ -375,20 +795,262 @@ void Engine::destroy() noexcept
 {
 	const auto logicalDevice = vkContext->get<VkDevice>();
 
+	vkDeviceWaitIdle(logicalDevice);
+
+	m_jobs.destroy();
+	m_secondaryCommands.destroy();
 	m_bufferHolder.destroy();
-	m_texture.destroy();
+	m_uniforms.destroy();
+	m_staging.destroy();
+	m_textures.destroy();
 	m_sync.destroy();
+	m_gpuProfiler.destroy();
 	m_commandPool.destroy();
-	m_descriptorPool.destroy();
-	m_pipeline.destroy();
+	m_descriptors.destroy();
+	m_bindlessTextures.destroy();
+	m_shaderReloader.destroy();
+	m_pipelineLibrary.destroy();
 	m_view.destroy();
+    m_allocator.destroy();
+    m_context.savePipelineCache();
     m_context.destroy();
+
+//  the worker threads have stopped, their events are complete
+    CpuProfiler::logStatistics();
 }
 
 
 void Engine::resize(int width, int height) noexcept
 {
+    if (m_view.getSwapchain() && m_view.getSwapchain()->isOffscreen())
+    {
+        spdlog::warn("The offscreen view keeps the size it was created with");
+
+        return;
+    }
+
 	m_width = width;
 	m_height = height;
 	m_framebufferResized = true;
+}
+
+
+void Engine::setFramesInFlight(uint32_t count) noexcept
+{
+//  the per frame resources are created with the main view
+    if (m_sync.framesInFlight)
+    {
+        spdlog::warn("Frames in flight can only be changed before the main view is created");
+
+        return;
+    }
+
+    m_framesInFlight = std::max(count, 1u);
+}
+
+
+void Engine::setInstanceCount(uint32_t count) noexcept
+{
+    if (m_instanceBuffer.handle)
+    {
+        spdlog::warn("The instance count can only be changed before the pipeline is created");
+
+        return;
+    }
+
+    m_instanceCount = count;
+}
+
+
+void Engine::setRecordingThreads(uint32_t count) noexcept
+{
+    if (m_sync.framesInFlight)
+    {
+        spdlog::warn("Recording threads can only be changed before the main view is created");
+
+        return;
+    }
+
+    m_recordingThreads = count;
+}
+
+
+void Engine::setDrawPath(DrawPath path) noexcept
+{
+    if (m_pipeline.handle)
+    {
+        spdlog::warn("The draw path can only be selected before the pipeline is created");
+
+        return;
+    }
+
+    m_drawPath = path;
+}
+
+
+void Engine::setShadingBenchmark(uint32_t iterations, bool detail, bool specialized) noexcept
+{
+    if (m_pipeline.handle)
+    {
+        spdlog::warn("The shading benchmark can only be selected before the pipeline is created");
+
+        return;
+    }
+
+    m_shadingBenchmark = { iterations, detail, specialized };
+}
+
+
+void Engine::setBindlessTextures(bool enabled) noexcept
+{
+    if (m_pipeline.handle)
+    {
+        spdlog::warn("Bindless textures can only be toggled before the pipeline is created");
+
+        return;
+    }
+
+    m_bindless = enabled;
+}
+
+
+void Engine::setTextureDirectory(const std::filesystem::path& directory) noexcept
+{
+    m_textureDirectory = directory;
+}
+
+
+void Engine::setPipelineStatistics(bool enabled) noexcept
+{
+//  the queries are created with the per frame resources
+    if (m_sync.framesInFlight)
+    {
+        spdlog::warn("Pipeline statistics can only be toggled before the main view is created");
+
+        return;
+    }
+
+    m_gpuStatistics = enabled;
+}
+
+
+bool Engine::setGpuProfilerLog(const std::filesystem::path& path) noexcept
+{
+    return m_gpuProfiler.setLog(path);
+}
+
+
+VkDescriptorSet Engine::getDescriptorSet() noexcept
+{
+    CPU_PROFILE_SCOPE("Engine::getDescriptorSet");
+
+    const Texture2D& texture = m_textures.get(m_cubeTexture);
+
+//  the frame and the object are selected by the dynamic offset at bind time
+    const std::array<DescriptorAllocator::Write, 2> writes = 
+    {
+        DescriptorAllocator::Write
+        {
+            .binding = 0,
+            .type    = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            .buffer  = { m_uniforms.getBuffer(), 0, (m_drawPath == DrawPath::UniformPerDraw) ? sizeof(DrawUniforms) : sizeof(SceneUniforms) }
+        },
+        DescriptorAllocator::Write
+        {
+            .binding = 1,
+            .type    = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .image   = { texture.sampler, texture.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }
+        }
+    };
+
+//  the bindless textures are in set 1
+    return m_descriptors.getSet(m_pipeline.descriptorSetLayout, std::span(writes).first(m_bindless ? 1 : 2));
+}
+
+
+void Engine::publishTextures() noexcept
+{
+    CPU_PROFILE_SCOPE("Engine::publishTextures");
+
+    m_materials.resize(m_textures.getTextureCount(), BindlessTextures::placeholder_slot);
+
+//  a slot is written once, no frame in flight has read it before
+    for (uint32_t texture : m_textures.getPublished())
+    {
+        const uint32_t slot = texture + 1;
+
+        if (slot >= m_bindlessTextures.capacity)
+        {
+            spdlog::warn("Bindless textures: no slot left for texture {}, it keeps the placeholder", texture);
+
+            continue;
+        }
+
+        const Texture2D& image = m_textures.get(texture);
+
+        m_bindlessTextures.write(m_descriptorWriter, slot, { image.sampler, image.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+        m_materials[texture] = slot;
+    }
+
+//  the textures of a frame are published with one update, a streamed batch lands in consecutive slots as one write
+    m_descriptorWriter.flush();
+}
+
+
+uint32_t Engine::getMaterial(uint32_t cube) const noexcept
+{
+//  the descriptor set of the frame holds the cube texture only
+    if (!m_bindless)
+        return m_cubeTexture;
+
+//  the streamed textures are spread over the cubes, switching texture between draws only changes the index
+    return m_materials[cube % m_materials.size()];
+}
+
+
+void Engine::recreateSwapchain() noexcept
+{
+    vkDeviceWaitIdle(vkContext->get<VkDevice>());
+    m_view.resize();
+    m_sync.createImageSemaphores(static_cast<uint32_t>(m_view.getSwapchain()->getImageCount()));
+}
+
+
+void Engine::updateFrameStatistics(std::chrono::steady_clock::time_point waitStart, std::chrono::steady_clock::time_point frameStart) noexcept
+{
+    using namespace std::chrono;
+
+    constexpr uint32_t reportInterval = 500;
+    const auto frameEnd = steady_clock::now();
+
+    m_lastFrameStats.waitTime  = duration<double, std::milli>(frameStart - waitStart).count();
+    m_lastFrameStats.cpuTime   = duration<double, std::milli>(frameEnd - frameStart).count();
+    m_lastFrameStats.drawCalls = (m_drawPath == DrawPath::Instanced) ? std::max(m_secondaryCommands.sliceCount, 1u) : m_instanceCount;
+
+    m_frameStats.waitTime   += m_lastFrameStats.waitTime;
+    m_frameStats.cpuTime    += m_lastFrameStats.cpuTime;
+    m_frameStats.recordTime += m_lastFrameStats.recordTime;
+    m_frameStats.drawCount  += m_lastFrameStats.drawCalls;
+
+    if (m_frameStats.frameCount == 0)
+        m_frameStats.intervalStart = waitStart;
+
+    if (++m_frameStats.frameCount == reportInterval)
+    {
+        const double seconds = duration<double>(frameEnd - m_frameStats.intervalStart).count();
+        const auto descriptors = m_descriptors.getStatistics();
+
+        spdlog::debug("Frame pacing: {} frames in flight, {} recording slices, CPU {:.3f} ms/frame, recording {:.3f} ms/frame, fence wait {:.3f} ms/frame, {:.1f} frames/s, {:.0f} draws/s, {:.2f} descriptor sets allocated/frame",
+                      m_sync.framesInFlight,
+                      m_secondaryCommands.sliceCount,
+                      m_frameStats.cpuTime / reportInterval,
+                      m_frameStats.recordTime / reportInterval,
+                      m_frameStats.waitTime / reportInterval,
+                      reportInterval / seconds,
+                      m_frameStats.drawCount / seconds,
+                      double(descriptors.allocatedSets - m_frameStats.allocatedSets) / reportInterval);
+
+        m_frameStats = {};
+        m_frameStats.allocatedSets = descriptors.allocatedSets;
+    }
 }
\ No newline at end of file
@@ -1,53 +1,143 @@
 #pragma once
 
+#include <chrono>
+
+#include "FrameStatistics.hpp"
 #include "files/FileProvider.hpp"
+#include "memory/MemoryAllocator.hpp"
 #include "view/View.hpp"
-#include "pipeline/descriptors/DescriptorPool.hpp"
+#include "pipeline/descriptors/DescriptorAllocator.hpp"
+#include "pipeline/descriptors/BindlessTextures.hpp"
 #include "pipeline/GraphicsPipeline.hpp"
+#include "pipeline/PipelineLibrary.hpp"
+#include "pipeline/ShaderReloader.hpp"
 #include "command_pool/CommandBufferPool.hpp"
+#include "command_pool/SecondaryCommandPools.hpp"
+#include "jobs/JobSystem.hpp"
 #include "sync/SyncManager.hpp"
-#include "texture/Texture2D.hpp"
+#include "texture/TextureStreamer.hpp"
 #include "buffers/BufferHolder.hpp"
+#include "buffers/UniformArena.hpp"
 #include "render/Renderer.hpp"
+#include "render/GpuProfiler.hpp"
 #include "camera/Camera.hpp"
 
 
+// How the cubes are submitted, selected with setDrawPath() to compare the cost of per draw data
+enum class DrawPath : uint32_t
+{
+    Instanced,      // one instanced draw per recording slice, the model matrices are instance attributes
+    PushConstants,  // one draw per cube, its model matrix pushed before the draw
+    UniformPerDraw  // one draw per cube, its block written to the uniform arena and bound with a dynamic offset
+};
+
+
 class Engine
 {
 public:
     Engine() noexcept;
 
-    bool createContext()                       noexcept;
+    bool createContext(bool headless = false)  noexcept;
     bool createMainView(uint64_t windowHandle) noexcept;
+    bool createOffscreenView(uint32_t width, uint32_t height) noexcept; // images owned by the engine, nothing is presented
 
     bool createPipeline() noexcept;
     void drawFrame() noexcept;
+    bool saveFrame(const std::filesystem::path& path) noexcept; // the last frame drawn into the offscreen view, see StbImage::saveToFile()
+    FrameStatistics getFrameStatistics() const noexcept;
+    std::span<const GpuScopeTiming> getGpuTimings() const noexcept; // resolved frames in flight later, see GpuProfiler
+    const GpuPipelineStatistics& getPipelineStatistics() const noexcept;
+    bool saveCpuTrace(const std::filesystem::path& path) const noexcept; // Chrome trace JSON of the CPU scopes, see CpuProfiler
     void destroy() noexcept;
     void resize(int width, int height) noexcept;
+    void setFramesInFlight(uint32_t count) noexcept;
+    void setInstanceCount(uint32_t count) noexcept;
+    void setRecordingThreads(uint32_t count) noexcept;
+    void setDrawPath(DrawPath path) noexcept;
+    void setShadingBenchmark(uint32_t iterations, bool detail, bool specialized) noexcept;
+    void setBindlessTextures(bool enabled) noexcept;
+    void setTextureDirectory(const std::filesystem::path& directory) noexcept;
+    void setPipelineStatistics(bool enabled) noexcept;
+    bool setGpuProfilerLog(const std::filesystem::path& path) noexcept; // CSV, an empty path closes it
+
+    bool createFrameResources() noexcept;
+    void recordDraws(VkCommandBuffer cmd, VkDescriptorSet descriptorSet, uint32_t uniformOffset, uint32_t firstInstance, uint32_t instanceCount) const noexcept;
+    VkDescriptorSet getDescriptorSet() noexcept;
+    void publishTextures() noexcept;
+    uint32_t getMaterial(uint32_t cube) const noexcept;
+    void recreateSwapchain() noexcept;
+    void updateFrameStatistics(std::chrono::steady_clock::time_point waitStart, std::chrono::steady_clock::time_point frameStart) noexcept;
 
     VulkanContext    m_context;
+    MemoryAllocator  m_allocator;
     View             m_view;
-    GraphicsPipeline m_pipeline;
+    PipelineLibrary  m_pipelineLibrary;
+    ShaderReloader   m_shaderReloader;
+    GraphicsPipeline m_pipeline; // replaced by m_shaderReloader when a shader changes
 
-    std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> m_descriptorSets;
-    DescriptorPool m_descriptorPool;
+    DescriptorAllocator m_descriptors;
+    DescriptorWriter    m_descriptorWriter; // batches the bindless slots published in a frame
 
     CommandBufferPool m_commandPool;
     SyncManager m_sync;
 
-    Texture2D m_texture;
+    JobSystem             m_jobs;
+    SecondaryCommandPools m_secondaryCommands;
+
+    TextureStreamer          m_textures;
+    uint32_t                 m_cubeTexture;
+    std::filesystem::path    m_textureDirectory;
 
-    std::vector<Buffer> m_uniformBuffers;
+    BindlessTextures      m_bindlessTextures;
+    std::vector<uint32_t> m_materials; // bindless slot of every texture, BindlessTextures::placeholder_slot until it is resident
+    bool                  m_bindless;  // requested with setBindlessTextures(), cleared by createPipeline() when the device lacks descriptor indexing
 
+    UniformArena m_uniforms;
+
+    StagingRing  m_staging;
     BufferHolder m_bufferHolder;
     Buffer m_vertexBuffer;
     Buffer m_indexBuffer;
+    Buffer m_instanceBuffer;
+
+    DrawPath              m_drawPath;
+    std::vector<mat4s>    m_transforms;  // the per draw paths read the model matrices on the CPU
+    std::vector<uint32_t> m_drawOffsets; // DrawPath::UniformPerDraw, uniform arena offset of every cube in the current frame
+
+    Renderer      m_renderer;
+    GpuProfiler   m_gpuProfiler;
+    bool          m_gpuStatistics; // pipeline statistics of the rendering, requested with setPipelineStatistics()
+
+    bool     m_framebufferResized;
+    int32_t  m_width;
+    int32_t  m_height;
+    uint32_t m_framesInFlight;
+    uint32_t m_instanceCount;
+    uint32_t m_recordingThreads; // 0 - draws are recorded on the main thread directly into the primary command buffer
+
+    struct
+    {
+        uint32_t iterations  = 0; // 0 - the regular fragment shader
+        bool     detail      = false;
+        bool     specialized = false;
+    } m_shadingBenchmark;
+
+    struct
+    {
+        std::chrono::steady_clock::time_point intervalStart;
+        double   cpuTime       = 0.0;
+        double   waitTime      = 0.0;
+        double   recordTime    = 0.0;
+        uint32_t frameCount    = 0;
+        uint64_t drawCount     = 0;
+        uint64_t allocatedSets = 0; // DescriptorAllocator::Statistics::allocatedSets when the interval started
+    } m_frameStats;
 
-    Renderer m_renderer;
+    FrameStatistics m_lastFrameStats; // the memory and the GPU time are filled by getFrameStatistics()
 
-    bool    m_framebufferResized;
-    int32_t m_width;
-    int32_t m_height;
+    std::chrono::steady_clock::time_point m_startTime;
+    uint64_t m_presentedFrames;
+    uint32_t m_lastFrame; // frame in flight of the last submission, also its image in the offscreen view
 
     Camera camera;
 
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "spdlog/spdlog.h"
+
+#include "utils/Tools.hpp"
+#include "utils/CpuProfiler.hpp"
+#include "files/CookedTexture.hpp"
+#include "files/FileProvider.hpp"
+#include "files/CookedImage.hpp"
+
+
+
+bool CookedImage::loadFromFile(const std::filesystem::path& filepath, VkPhysicalDevice gpu) noexcept
+{
+    CPU_PROFILE_SCOPE("CookedImage::loadFromFile");
+
+    if (!FileProvider::readFile(filepath, &file))
+        return false;
+
+    const auto bytes = file.data;
+
+//  the tables are read in place, mappings and pack entries are aligned and the cooker keeps the tables 8 byte aligned,
+//  a chain longer than the levels down to 1x1 would size the payload and the image past what the device accepts
+    const auto* header = reinterpret_cast<const CookedTextureHeader*>(bytes.data());
+
+    if (bytes.size() < sizeof(CookedTextureHeader) ||
+        memcmp(header->magic, cooked_texture_magic, sizeof(header->magic)) != 0 ||
+        header->version != cooked_texture_version ||
+        header->width == 0 || header->height == 0 || header->levelCount == 0 || header->payloadCount == 0 ||
+        header->levelCount > std::bit_width(std::max(header->width, header->height)) ||
+        bytes.size() < sizeof(CookedTextureHeader) + sizeof(CookedTexturePayload) * header->payloadCount)
+    {
+        spdlog::error("Cooked texture: {} is not a version {} container", filepath.string(), cooked_texture_version);
+        file = {};
+
+        return false;
+    }
+
+    const std::span<const CookedTexturePayload> payloads(reinterpret_cast<const CookedTexturePayload*>(bytes.data() + sizeof(CookedTextureHeader)), header->payloadCount);
+
+    std::vector<VkFormat> formats;
+
+    for (const auto& payload : payloads)
+        formats.push_back(payload.format);
+
+    format = vktools::find_supported_format(formats,
+                                            VK_IMAGE_TILING_OPTIMAL,
+                                            VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT,
+                                            gpu);
+
+    if (format == VK_FORMAT_UNDEFINED)
+    {
+        spdlog::error("Cooked texture: the device samples none of the formats of {}", filepath.string());
+        file = {};
+
+        return false;
+    }
+
+    const auto& payload = *std::find_if(payloads.begin(), payloads.end(), [this](const CookedTexturePayload& candidate) { return candidate.format == format; });
+
+    if (payload.byteLength != get_mip_chain_size(format, header->width, header->height, header->levelCount) ||
+        payload.byteOffset > bytes.size() || payload.byteLength > bytes.size() - payload.byteOffset)
+    {
+        spdlog::error("Cooked texture: {} has a truncated payload", filepath.string());
+        file = {};
+
+        return false;
+    }
+
+    data       = bytes.subspan(payload.byteOffset, payload.byteLength);
+    width      = header->width;
+    height     = header->height;
+    levelCount = header->levelCount;
+
+    return true;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+#include <vulkan/vulkan.h>
+
+#include "files/PackFile.hpp"
+
+// Reader of the precooked texture container (files/CookedTexture.hpp).
+// The file is read through FileProvider, the first payload the device can sample is copied to the staging buffer from the mapping.
+struct CookedImage
+{
+    bool loadFromFile(const std::filesystem::path& filepath, VkPhysicalDevice gpu) noexcept;
+
+    FileData                 file;
+    std::span<const uint8_t> data; // every level of the chosen payload, points into file
+    VkFormat format     = VK_FORMAT_UNDEFINED;
+    uint32_t width      = 0;
+    uint32_t height     = 0;
+    uint32_t levelCount = 0;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+
+// Precooked texture container written by the texture_cooker tool, a trimmed down KTX2.
+// A file holds the same image in several formats ordered by preference, each one with its whole mip chain:
+//     CookedTextureHeader
+//     CookedTexturePayload[payloadCount]
+//     texel data, the levels of a payload are contiguous and start with the largest one
+// Shared between the engine and the cooker, keep it header only.
+
+constexpr char     cooked_texture_magic[4] = { 'C', 'T', 'E', 'X' };
+constexpr uint32_t cooked_texture_version  = 1;
+
+struct CookedTextureHeader
+{
+    char     magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint32_t payloadCount;
+};
+
+struct CookedTexturePayload
+{
+    VkFormat format;
+    uint32_t reserved;
+    uint64_t byteOffset; // from the start of the file
+    uint64_t byteLength; // every level
+};
+
+
+//  Size of one mip level, block compressed formats round the extent up to whole 4x4 blocks
+inline uint64_t get_texel_data_size(VkFormat format, uint32_t width, uint32_t height) noexcept
+{
+    const uint64_t blocks = uint64_t((width + 3) / 4) * ((height + 3) / 4);
+
+    switch (format)
+    {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            return blocks * 8;
+
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return blocks * 16;
+
+        default:
+            return uint64_t(width) * height * 4;
+    }
+}
+
+
+//  Size of levelCount levels starting with a width x height one
+inline uint64_t get_mip_chain_size(VkFormat format, uint32_t width, uint32_t height, uint32_t levelCount) noexcept
+{
+    uint64_t size = 0;
+
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        const uint32_t levelWidth  = (width >> level) ? (width >> level) : 1;
+        const uint32_t levelHeight = (height >> level) ? (height >> level) : 1;
+
+        size += get_texel_data_size(format, levelWidth, levelHeight);
+    }
+
+    return size;
+}
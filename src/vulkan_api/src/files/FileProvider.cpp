@@ -1,4 +1,8 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <fstream>
+#include <unordered_set>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -6,13 +10,18 @@
 
 #ifdef __linux__
 #include <unistd.h>
+#include <sys/inotify.h>
 #endif
 
+#include "spdlog/spdlog.h"
+
 #include "files/FileProvider.hpp"
 
 
 static FileProvider* s_instance;
 
+static constexpr const char* manifest_name = "resources.manifest";
+
 
 static std::filesystem::path get_root_path() noexcept
 {
@@ -62,31 +71,354 @@ static std::filesystem::path get_root_path() noexcept
 }
 
 
-FileProvider::FileProvider() noexcept
+FileProvider::FileProvider(const std::filesystem::path& resourceDir) noexcept:
+    m_resourceDir(resourceDir),
+    m_indexed(false),
+    m_inotify(-1),
+    m_watchFailed(false)
 {
     assert(s_instance == nullptr);
     s_instance = this;
 }
 
 
+FileProvider::~FileProvider()
+{
+#ifdef __linux__
+    if (m_inotify != -1)
+        close(m_inotify);
+#endif
+
+    s_instance = nullptr;
+}
+
+
 std::filesystem::path FileProvider::findPathToFile(const std::string& filename) noexcept
+{
+    if (!s_instance)
+        return std::filesystem::path();
+
+    std::lock_guard lock(s_instance->m_mutex);
+
+    if (!s_instance->m_indexed)
+        s_instance->buildIndex();
+
+    if (const PackFile& pack = s_instance->m_pack; pack.isOpen())
+    {
+        const PackEntry* entry = (filename.find('/') != std::string::npos) ? pack.find(filename) : pack.findByName(filename);
+
+        return entry ? s_instance->m_resourceDir / std::filesystem::path(pack.getPath(*entry)) : std::filesystem::path();
+    }
+
+    if (filename.find('/') != std::string::npos)
+    {
+        if (auto it = s_instance->m_files.find(filename); it != s_instance->m_files.end())
+            return it->second;
+
+        return std::filesystem::path();
+    }
+
+    if (auto it = s_instance->m_names.find(filename); it != s_instance->m_names.end() && !it->second.empty())
+        return it->second.front();
+
+    return std::filesystem::path();
+}
+
+
+bool FileProvider::readFile(const std::filesystem::path& filepath, FileData* file) noexcept
 {
     if (s_instance)
     {
-        auto& exeDir = s_instance->m_exeDir;
+        {
+            std::lock_guard lock(s_instance->m_mutex);
+
+            if (!s_instance->m_indexed)
+                s_instance->buildIndex();
+        }
+
+//      the pack does not change once opened, reads need no lock
+        if (const PackFile& pack = s_instance->m_pack; pack.isOpen())
+        {
+            if (const PackEntry* entry = pack.find(s_instance->getVirtualPath(filepath)))
+                return pack.read(*entry, file);
+        }
+    }
+
+    if (!file->mapping.open(filepath))
+        return false;
+
+    file->data = file->mapping.getData();
+
+    return true;
+}
+
 
-        if (exeDir.empty())
-            exeDir = get_root_path();
+bool FileProvider::isPacked() noexcept
+{
+    if (!s_instance)
+        return false;
+
+    std::lock_guard lock(s_instance->m_mutex);
+
+    if (!s_instance->m_indexed)
+        s_instance->buildIndex();
+
+    return s_instance->m_pack.isOpen();
+}
 
-        const std::filesystem::path resFolder = exeDir / "res";
 
-        if (std::filesystem::exists(resFolder))
+std::span<const std::string> FileProvider::getChangedFiles() const noexcept
+{
+    return m_changedFiles;
+}
+
+
+void FileProvider::update() noexcept
+{
+    m_changedFiles.clear();
+
+#ifdef __linux__
+    if (m_inotify == -1)
+        return;
+
+    std::lock_guard lock(m_mutex);
+
+    alignas(inotify_event) char buffer[4096];
+
+    for (;;)
+    {
+        const ssize_t length = read(m_inotify, buffer, sizeof(buffer));
+
+//      EAGAIN, nothing left to read
+        if (length <= 0)
+            return;
+
+        for (ssize_t offset = 0; offset < length; )
         {
-            for (const auto& file : std::filesystem::recursive_directory_iterator(resFolder))
-                if (file.path().filename() == filename)
-                    return file.path();
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_IGNORED)
+            {
+                m_watches.erase(event->wd);
+                continue;
+            }
+
+            auto watch = m_watches.find(event->wd);
+
+            if (watch == m_watches.end() || event->len == 0)
+                continue;
+
+            const std::string virtualPath = watch->second.empty() ? std::string(event->name) : watch->second + '/' + event->name;
+
+            if (event->mask & (IN_CREATE | IN_MOVED_TO))
+            {
+                if (event->mask & IN_ISDIR)
+                    addDirectory(m_resourceDir / virtualPath);
+                else
+                    addFile(virtualPath);
+            }
+
+//          a created file is reported once its writer closes it, a moved one is complete already
+            if ((event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) && !(event->mask & IN_ISDIR))
+                m_changedFiles.push_back(virtualPath);
+            else if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+            {
+                if (event->mask & IN_ISDIR)
+                    removeDirectory(virtualPath);
+                else
+                    removeFile(virtualPath);
+            }
         }
     }
+#endif
+}
 
-    return std::filesystem::path();
-}
\ No newline at end of file
+
+void FileProvider::buildIndex() noexcept
+{
+    m_indexed = true;
+
+    if (m_resourceDir.empty())
+        m_resourceDir = get_root_path() / "res";
+
+    const auto start = std::chrono::steady_clock::now();
+
+//  a pack next to the res folder replaces it, res.pack for res
+    std::filesystem::path packPath = m_resourceDir;
+    packPath += ".pack";
+
+    if (m_pack.open(packPath))
+    {
+        spdlog::info("FileProvider: {} files served from {} opened in {:.3f} ms",
+                     m_pack.getEntryCount(), packPath.string(),
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+        return;
+    }
+
+    if (!std::filesystem::exists(m_resourceDir))
+        return;
+
+#ifdef __linux__
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (m_inotify == -1)
+        spdlog::warn("FileProvider: inotify is unavailable, changes of {} are not tracked", m_resourceDir.string());
+#endif
+
+    const bool manifest = loadManifest();
+
+    if (!manifest)
+        addDirectory(m_resourceDir);
+
+    const auto collisions = std::count_if(m_names.begin(), m_names.end(), [](const auto& name) { return name.second.size() > 1; });
+
+    spdlog::info("FileProvider: {} files indexed from {} in {:.3f} ms",
+                 m_files.size(), manifest ? manifest_name : "a scan",
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+    if (collisions)
+        spdlog::warn("FileProvider: {} file names are used more than once, look them up by their path relative to res", collisions);
+}
+
+
+//  One virtual path per line, generated after the build by src/cmake/generate_manifest.cmake
+bool FileProvider::loadManifest() noexcept
+{
+    std::ifstream manifest(m_resourceDir / manifest_name);
+
+    if (!manifest)
+        return false;
+
+    std::string line;
+
+    while (std::getline(manifest, line))
+    {
+        if (line.empty())
+            continue;
+
+        addFile(std::move(line));
+    }
+
+//  the manifest lists files only, the directories to watch are their parents
+    if (m_inotify != -1)
+    {
+        std::unordered_set<std::string> directories = { std::string() };
+
+        for (const auto& [virtualPath, path] : m_files)
+            for (size_t slash = virtualPath.find('/'); slash != std::string::npos; slash = virtualPath.find('/', slash + 1))
+                directories.insert(virtualPath.substr(0, slash));
+
+        for (const auto& directory : directories)
+            watchDirectory(m_resourceDir / directory);
+    }
+
+    return true;
+}
+
+
+void FileProvider::addDirectory(const std::filesystem::path& directory) noexcept
+{
+    watchDirectory(directory);
+
+    std::error_code error;
+
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, error); it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+    {
+        if (error)
+            break;
+
+        if (it->is_directory(error))
+            watchDirectory(it->path());
+        else if (it->is_regular_file(error) && it->path().filename() != manifest_name)
+            addFile(getVirtualPath(it->path()));
+    }
+}
+
+
+//  Path relative to the res folder with '/' separators, empty for the folder itself and for paths outside of it
+std::string FileProvider::getVirtualPath(const std::filesystem::path& path) const noexcept
+{
+    const std::string root     = m_resourceDir.generic_string();
+    const std::string absolute = path.generic_string();
+
+    if (absolute.size() <= root.size() + 1 || !absolute.starts_with(root) || absolute[root.size()] != '/')
+        return std::string();
+
+    return absolute.substr(root.size() + 1);
+}
+
+
+void FileProvider::addFile(std::string virtualPath) noexcept
+{
+    const std::filesystem::path path = m_resourceDir / virtualPath;
+
+    if (!m_files.try_emplace(std::move(virtualPath), path).second)
+        return;
+
+//  sorted, a name shared by several files resolves to the first path whatever the directory order
+    auto& paths = m_names[path.filename().string()];
+    paths.insert(std::upper_bound(paths.begin(), paths.end(), path), path);
+}
+
+
+void FileProvider::removeFile(const std::string& virtualPath) noexcept
+{
+    auto file = m_files.find(virtualPath);
+
+    if (file == m_files.end())
+        return;
+
+    const std::filesystem::path path = std::move(file->second);
+    m_files.erase(file);
+
+    if (auto it = m_names.find(path.filename().string()); it != m_names.end())
+    {
+        std::erase(it->second, path);
+
+        if (it->second.empty())
+            m_names.erase(it);
+    }
+}
+
+
+void FileProvider::removeDirectory(const std::string& virtualPath) noexcept
+{
+    const std::string prefix = virtualPath + '/';
+    std::vector<std::string> removed;
+
+    for (const auto& [file, path] : m_files)
+        if (file.starts_with(prefix))
+            removed.push_back(file);
+
+    for (const auto& file : removed)
+        removeFile(file);
+
+//  the watches of the removed directories are dropped with IN_IGNORED
+}
+
+
+void FileProvider::watchDirectory(const std::filesystem::path& directory) noexcept
+{
+#ifdef __linux__
+    if (m_inotify == -1)
+        return;
+
+    const int watch = inotify_add_watch(m_inotify, directory.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ONLYDIR);
+
+    if (watch == -1)
+    {
+        if (!m_watchFailed)
+            spdlog::warn("FileProvider: failed to watch {}, raise fs.inotify.max_user_watches for large trees", directory.string());
+
+        m_watchFailed = true;
+
+        return;
+    }
+
+    m_watches[watch] = getVirtualPath(directory);
+#else
+    (void)directory;
+#endif
+}
@@ -2,16 +2,62 @@
 
 #include <string>
 #include <filesystem>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
 
+#include "files/PackFile.hpp"
 
 
+// Resolves resource names to paths inside the res folder and reads the resources.
+// When res.pack sits next to the res folder every resource is served from the pack (files/PackFile.hpp).
+// Otherwise the folder is indexed once, from res/resources.manifest when the build generated it or by a scan,
+// and on Linux inotify keeps the index in sync with the disk, update() applies the reported changes and lists the rewritten files.
 class FileProvider
 {
 public:
-    FileProvider() noexcept;
+    explicit FileProvider(const std::filesystem::path& resourceDir = {}) noexcept; // empty - the res folder next to the executable
+    FileProvider(const FileProvider&)              noexcept = delete;
+    FileProvider& operator = (const FileProvider&) noexcept = delete;
+    ~FileProvider();
 
+//  filename is either a file name or, to pick one of several files with the same name,
+//  a virtual path relative to the res folder such as "textures/container.jpg"
     static std::filesystem::path findPathToFile(const std::string& filename) noexcept;
 
+//  Reads a path returned by findPathToFile from the pack, other paths are mapped from the disk. Thread safe.
+    static bool readFile(const std::filesystem::path& filepath, FileData* file) noexcept;
+
+//  True when the resources are served from res.pack, nothing is watched then
+    static bool isPacked() noexcept;
+
+//  Called once per frame from the main thread
+    void update() noexcept;
+
+//  Virtual paths of the files written or moved into the res folder, as reported by the last update()
+    std::span<const std::string> getChangedFiles() const noexcept;
+
 private:
-    std::filesystem::path m_exeDir;
+    void buildIndex() noexcept;
+    bool loadManifest() noexcept;
+    void addDirectory(const std::filesystem::path& directory) noexcept;
+    void addFile(std::string virtualPath) noexcept;
+    void removeFile(const std::string& virtualPath) noexcept;
+    void removeDirectory(const std::string& virtualPath) noexcept;
+    void watchDirectory(const std::filesystem::path& directory) noexcept;
+    std::string getVirtualPath(const std::filesystem::path& path) const noexcept;
+
+    std::filesystem::path m_resourceDir;
+    bool                  m_indexed;
+    PackFile              m_pack;
+    std::mutex            m_mutex; // the index, update() changes it while the texture workers read files
+
+    std::unordered_map<std::string, std::filesystem::path>              m_files; // virtual path -> path
+    std::unordered_map<std::string, std::vector<std::filesystem::path>> m_names; // file name -> paths
+
+    int                                  m_inotify;
+    std::unordered_map<int, std::string> m_watches; // watch descriptor -> virtual path of the directory
+    bool                                 m_watchFailed;
+    std::vector<std::string>             m_changedFiles;
 };
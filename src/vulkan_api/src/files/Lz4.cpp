@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cstring>
+
+#include "files/Lz4.hpp"
+
+
+static constexpr size_t min_match      = 4;
+static constexpr size_t last_literals  = 5;  // the block ends with at least 5 literals
+static constexpr size_t match_limit    = 12; // no match starts in the last 12 bytes
+static constexpr size_t max_offset     = 65535;
+static constexpr uint32_t hash_bits    = 16;
+
+
+static uint32_t read_u32(const uint8_t* src) noexcept
+{
+    uint32_t value;
+    memcpy(&value, src, sizeof(value));
+
+    return value;
+}
+
+
+static uint32_t hash_sequence(uint32_t sequence) noexcept
+{
+    return (sequence * 2654435761u) >> (32 - hash_bits);
+}
+
+
+//  Lengths past the 4 bits of the token continue in bytes of 255
+static void write_length(std::vector<uint8_t>& dst, size_t length) noexcept
+{
+    for (; length >= 255; length -= 255)
+        dst.push_back(255);
+
+    dst.push_back(static_cast<uint8_t>(length));
+}
+
+
+static void write_sequence(std::vector<uint8_t>& dst, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength) noexcept
+{
+    const size_t matchCode = matchLength ? matchLength - min_match : 0;
+
+    dst.push_back(static_cast<uint8_t>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+
+    if (literalCount >= 15)
+        write_length(dst, literalCount - 15);
+
+    dst.insert(dst.end(), literals, literals + literalCount);
+
+//  the last sequence only has literals
+    if (matchLength == 0)
+        return;
+
+    dst.push_back(static_cast<uint8_t>(offset));
+    dst.push_back(static_cast<uint8_t>(offset >> 8));
+
+    if (matchCode >= 15)
+        write_length(dst, matchCode - 15);
+}
+
+
+
+std::vector<uint8_t> lz4_compress(std::span<const uint8_t> src) noexcept
+{
+    std::vector<uint8_t> dst;
+
+    if (src.empty())
+        return dst;
+
+    dst.reserve(src.size() + src.size() / 255 + 16);
+
+    const uint8_t* const begin = src.data();
+    const uint8_t* const end   = begin + src.size();
+
+    const uint8_t* anchor = begin;
+
+    if (src.size() > match_limit)
+    {
+        std::vector<uint32_t> table(size_t(1) << hash_bits, UINT32_MAX);
+
+        const uint8_t* const matchEnd = end - last_literals;
+        const uint8_t* position       = begin;
+
+        while (position + match_limit <= end)
+        {
+            const uint32_t sequence = read_u32(position);
+            const uint32_t hash     = hash_sequence(sequence);
+            const uint32_t previous = table[hash];
+
+            table[hash] = static_cast<uint32_t>(position - begin);
+
+            if (previous == UINT32_MAX || size_t(position - begin) - previous > max_offset || read_u32(begin + previous) != sequence)
+            {
+                position++;
+                continue;
+            }
+
+            const uint8_t* match = begin + previous;
+            size_t length = min_match;
+
+            while (position + length < matchEnd && match[length] == position[length])
+                length++;
+
+            write_sequence(dst, anchor, size_t(position - anchor), size_t(position - match), length);
+
+            position += length;
+            anchor    = position;
+        }
+    }
+
+    write_sequence(dst, anchor, size_t(end - anchor), 0, 0);
+
+    return dst;
+}
+
+
+bool lz4_decompress(std::span<const uint8_t> src, std::span<uint8_t> dst) noexcept
+{
+    const uint8_t* in        = src.data();
+    const uint8_t* const inEnd = in + src.size();
+
+    uint8_t* out             = dst.data();
+    uint8_t* const outEnd    = out + dst.size();
+
+    auto readLength = [&](size_t length) -> size_t
+    {
+        if (length != 15)
+            return length;
+
+        for (uint8_t byte = 255; byte == 255; length += byte)
+        {
+            if (in == inEnd)
+                return SIZE_MAX;
+
+            byte = *in++;
+        }
+
+        return length;
+    };
+
+    while (in < inEnd)
+    {
+        const uint8_t token = *in++;
+
+        const size_t literalCount = readLength(token >> 4);
+
+        if (literalCount == SIZE_MAX || literalCount > size_t(inEnd - in) || literalCount > size_t(outEnd - out))
+            return false;
+
+        memcpy(out, in, literalCount);
+        in  += literalCount;
+        out += literalCount;
+
+//      the last sequence ends the block after its literals
+        if (in == inEnd)
+            break;
+
+        if (inEnd - in < 2)
+            return false;
+
+        const size_t offset = in[0] | (size_t(in[1]) << 8);
+        in += 2;
+
+        size_t matchLength = readLength(token & 15);
+
+        if (matchLength == SIZE_MAX || offset == 0 || offset > size_t(out - dst.data()))
+            return false;
+
+        matchLength += min_match;
+
+        if (matchLength > size_t(outEnd - out))
+            return false;
+
+//      the match may overlap the bytes it writes, copy byte by byte
+        const uint8_t* match = out - offset;
+
+        for (size_t i = 0; i < matchLength; ++i)
+            out[i] = match[i];
+
+        out += matchLength;
+    }
+
+    return out == outEnd;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// LZ4 block format codec, compatible with LZ4_compress_default/LZ4_decompress_safe.
+// The compressor is the plain greedy one, it runs offline in the asset packer.
+
+constexpr uint64_t lz4_max_ratio = 255; // decompressed bytes per compressed byte at most, a length byte adds 255
+
+//  Returns the compressed bytes, empty if src is empty
+std::vector<uint8_t> lz4_compress(std::span<const uint8_t> src) noexcept;
+
+//  Decompresses into dst which has the exact decompressed size, false on corrupt input
+bool lz4_decompress(std::span<const uint8_t> src, std::span<uint8_t> dst) noexcept;
@@ -0,0 +1,144 @@
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+#include "files/MappedFile.hpp"
+
+
+
+MappedFile::MappedFile() noexcept:
+    m_data(nullptr),
+    m_size(0)
+{
+
+}
+
+
+MappedFile::MappedFile(MappedFile&& other) noexcept:
+    m_data(std::exchange(other.m_data, nullptr)),
+    m_size(std::exchange(other.m_size, 0))
+{
+
+}
+
+
+MappedFile& MappedFile::operator = (MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+
+    return *this;
+}
+
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+
+bool MappedFile::open(const std::filesystem::path& filepath) noexcept
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+
+    if (!mapping)
+        return false;
+
+//  the view keeps the mapping alive
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+
+    if (!view)
+        return false;
+
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(size.QuadPart);
+#else
+    const int file = ::open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (file == -1)
+        return false;
+
+    struct stat status;
+
+//  an empty file cannot be mapped
+    if (fstat(file, &status) == -1 || status.st_size == 0)
+    {
+        ::close(file);
+
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+
+    if (view == MAP_FAILED)
+        return false;
+
+//  assets are read whole right after opening, start the read ahead now
+    madvise(view, static_cast<size_t>(status.st_size), MADV_WILLNEED);
+
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(status.st_size);
+#endif
+
+    return true;
+}
+
+
+void MappedFile::close() noexcept
+{
+    if (!m_data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+#else
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+
+std::span<const uint8_t> MappedFile::getData() const noexcept
+{
+    return { m_data, m_size };
+}
+
+
+bool MappedFile::isOpen() const noexcept
+{
+    return (m_data != nullptr);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+// Read only memory mapping of a whole file.
+// Assets are read straight from the mapping, no heap buffer holds a copy of the file.
+// The mapping starts on a page boundary, so data aligned in the file stays aligned in memory.
+class MappedFile final
+{
+public:
+    MappedFile() noexcept;
+    MappedFile(const MappedFile&)              noexcept = delete;
+    MappedFile(MappedFile&& other)             noexcept;
+    MappedFile& operator = (const MappedFile&) noexcept = delete;
+    MappedFile& operator = (MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    bool open(const std::filesystem::path& filepath) noexcept;
+    void close() noexcept;
+
+    std::span<const uint8_t> getData() const noexcept;
+    bool isOpen() const noexcept;
+
+private:
+    const uint8_t* m_data;
+    size_t         m_size;
+};
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cstring>
+
+#include "spdlog/spdlog.h"
+
+#include "files/Lz4.hpp"
+#include "files/PackFile.hpp"
+
+
+
+bool PackFile::open(const std::filesystem::path& filepath) noexcept
+{
+    close();
+
+    if (!m_file.open(filepath))
+        return false;
+
+    const auto bytes = m_file.getData();
+
+//  the tables are read in place, the packer keeps them 8 byte aligned
+    const auto* header = reinterpret_cast<const PackHeader*>(bytes.data());
+
+    const bool valid = bytes.size() >= sizeof(PackHeader) &&
+                       memcmp(header->magic, pack_magic, sizeof(header->magic)) == 0 &&
+                       header->version == pack_version &&
+                       header->entriesOffset % alignof(PackEntry) == 0 &&
+                       header->namesOffset % alignof(PackName) == 0 &&
+                       header->entriesOffset + uint64_t(header->entryCount) * sizeof(PackEntry) <= bytes.size() &&
+                       header->namesOffset + uint64_t(header->entryCount) * sizeof(PackName) <= bytes.size() &&
+                       header->pathsOffset <= bytes.size();
+
+    if (!valid)
+    {
+        spdlog::error("Pack: {} is not a version {} pack", filepath.string(), pack_version);
+        m_file.close();
+
+        return false;
+    }
+
+    m_entries = { reinterpret_cast<const PackEntry*>(bytes.data() + header->entriesOffset), header->entryCount };
+    m_names   = { reinterpret_cast<const PackName*>(bytes.data() + header->namesOffset), header->entryCount };
+    m_paths   = { reinterpret_cast<const char*>(bytes.data() + header->pathsOffset), bytes.size() - header->pathsOffset };
+
+//  a damaged table must not send a read outside of the mapping
+    for (const auto& entry : m_entries)
+    {
+        if (uint64_t(entry.pathOffset) + entry.pathLength > m_paths.size() || entry.offset > bytes.size() || entry.storedSize > bytes.size() - entry.offset)
+        {
+            spdlog::error("Pack: {} has an entry outside of the file", filepath.string());
+            close();
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void PackFile::close() noexcept
+{
+    m_entries = {};
+    m_names   = {};
+    m_paths   = {};
+    m_file.close();
+}
+
+
+const PackEntry* PackFile::find(std::string_view virtualPath) const noexcept
+{
+    const uint64_t hash = pack_hash(virtualPath);
+
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), hash, [](const PackEntry& entry, uint64_t value) { return entry.pathHash < value; });
+
+    for (; it != m_entries.end() && it->pathHash == hash; ++it)
+        if (getPath(*it) == virtualPath)
+            return &*it;
+
+    return nullptr;
+}
+
+
+const PackEntry* PackFile::findByName(std::string_view filename) const noexcept
+{
+    const uint64_t hash = pack_hash(filename);
+
+    auto it = std::lower_bound(m_names.begin(), m_names.end(), hash, [](const PackName& name, uint64_t value) { return name.nameHash < value; });
+
+    for (; it != m_names.end() && it->nameHash == hash; ++it)
+        if (it->entry < m_entries.size() && pack_file_name(getPath(m_entries[it->entry])) == filename)
+            return &m_entries[it->entry];
+
+    return nullptr;
+}
+
+
+std::string_view PackFile::getPath(const PackEntry& entry) const noexcept
+{
+    return m_paths.substr(entry.pathOffset, entry.pathLength);
+}
+
+
+bool PackFile::read(const PackEntry& entry, FileData* file) const noexcept
+{
+    const auto stored = m_file.getData().subspan(entry.offset, entry.storedSize);
+
+    switch (entry.compression)
+    {
+        case PackCompressionNone:
+            file->data = stored;
+
+            return (entry.size == entry.storedSize);
+
+        case PackCompressionLz4:
+//          the size comes from the table, a damaged one must not allocate more than the stored bytes can decode to
+            if (entry.size > entry.storedSize * lz4_max_ratio)
+            {
+                spdlog::error("Pack: {} is corrupt, {} bytes cannot decompress to {}", getPath(entry), entry.storedSize, entry.size);
+
+                return false;
+            }
+
+            file->buffer.resize(entry.size);
+
+            if (!lz4_decompress(stored, file->buffer))
+            {
+                spdlog::error("Pack: {} is corrupt", getPath(entry));
+
+                return false;
+            }
+
+            file->data = file->buffer;
+
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+
+uint32_t PackFile::getEntryCount() const noexcept
+{
+    return static_cast<uint32_t>(m_entries.size());
+}
+
+
+bool PackFile::isOpen() const noexcept
+{
+    return m_file.isOpen();
+}
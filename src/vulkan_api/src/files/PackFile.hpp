@@ -0,0 +1,44 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "files/MappedFile.hpp"
+#include "files/PackFormat.hpp"
+
+// Bytes of a resource: a span into the pack mapping, the mapping of a loose file or a decompressed copy.
+// Moving it keeps data valid.
+struct FileData
+{
+    std::span<const uint8_t> data;
+    MappedFile               mapping;
+    std::vector<uint8_t>     buffer;
+};
+
+
+// Read only view of an asset pack (files/PackFormat.hpp), the whole pack is one mapping.
+// Lookups binary search the tables of the pack in place, opening a pack builds nothing.
+class PackFile final
+{
+public:
+    bool open(const std::filesystem::path& filepath) noexcept;
+    void close() noexcept;
+
+    const PackEntry* find(std::string_view virtualPath) const noexcept;
+    const PackEntry* findByName(std::string_view filename) const noexcept; // the first path in alphabetical order
+    std::string_view getPath(const PackEntry& entry) const noexcept;
+
+//  Uncompressed entries are not copied, data points into the mapping
+    bool read(const PackEntry& entry, FileData* file) const noexcept;
+
+    uint32_t getEntryCount() const noexcept;
+    bool isOpen() const noexcept;
+
+private:
+    MappedFile                     m_file;
+    std::span<const PackEntry>     m_entries;
+    std::span<const PackName>      m_names;
+    std::string_view               m_paths;
+};
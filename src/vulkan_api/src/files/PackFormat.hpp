@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+
+// Asset pack written by the asset_packer tool and served by FileProvider.
+//     PackHeader
+//     PackEntry[entryCount]  sorted by pathHash, then by path
+//     PackName[entryCount]   sorted by nameHash, then by path
+//     paths                  virtual paths relative to res with '/' separators, not null terminated
+//     data                   every entry starts on a 16 byte boundary
+// Shared between the engine and the packer, keep it header only.
+
+constexpr char     pack_magic[4] = { 'W', 'P', 'A', 'K' };
+constexpr uint32_t pack_version  = 1;
+constexpr uint64_t pack_data_alignment = 16;
+
+enum PackCompression : uint32_t
+{
+    PackCompressionNone = 0,
+    PackCompressionLz4  = 1
+};
+
+struct PackHeader
+{
+    char     magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+    uint64_t entriesOffset;
+    uint64_t namesOffset;
+    uint64_t pathsOffset;
+};
+
+struct PackEntry
+{
+    uint64_t pathHash;
+    uint64_t offset;      // from the start of the pack
+    uint64_t size;        // once decompressed
+    uint64_t storedSize;  // in the pack
+    uint32_t pathOffset;  // from pathsOffset
+    uint32_t pathLength;
+    uint32_t compression; // PackCompression
+    uint32_t reserved;
+};
+
+//  Lookups by file name only, "container.jpg" for "textures/container.jpg"
+struct PackName
+{
+    uint64_t nameHash;
+    uint32_t entry;
+    uint32_t reserved;
+};
+
+
+//  FNV-1a
+inline uint64_t pack_hash(std::string_view text) noexcept
+{
+    uint64_t hash = 14695981039346656037ull;
+
+    for (const char c : text)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+
+inline std::string_view pack_file_name(std::string_view path) noexcept
+{
+    const size_t slash = path.find_last_of('/');
+
+    return (slash == std::string_view::npos) ? path : path.substr(slash + 1);
+}
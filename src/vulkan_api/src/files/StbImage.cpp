@@ -1,6 +1,14 @@
+#include <fstream>
+#include <string>
+#include <vector>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
 
+#include "utils/CpuProfiler.hpp"
+#include "files/FileProvider.hpp"
 #include "files/StbImage.hpp"
 
 void StbImage::StbImageDeleter::operator()(uint8_t* src) noexcept
@@ -10,9 +18,17 @@ void StbImage::StbImageDeleter::operator()(uint8_t* src) noexcept
 
 bool StbImage::loadFromFile(const std::filesystem::path& filepath,int mode) noexcept
 {
-    std::string path(filepath.generic_string());
+    CPU_PROFILE_SCOPE("StbImage::loadFromFile");
+
+//  stb decodes straight from the mapping or the pack instead of its own stdio buffer
+    FileData file;
+
+    if (!FileProvider::readFile(filepath, &file))
+        return false;
 
-    if (stbi_uc* src = stbi_load(path.c_str(), &width, &height, &bytePerPixel, mode); src != nullptr)
+    const auto data = file.data;
+
+    if (stbi_uc* src = stbi_load_from_memory(data.data(), static_cast<int>(data.size()), &width, &height, &bytePerPixel, mode); src != nullptr)
     {
         pixels.reset(src);
 
@@ -20,4 +36,40 @@ bool StbImage::loadFromFile(const std::filesystem::path& filepath,int mode) noex
     }
 
     return false;
-}
\ No newline at end of file
+}
+
+
+bool StbImage::saveToFile(const std::filesystem::path& filepath, uint32_t width, uint32_t height, std::span<const uint8_t> rgba) noexcept
+{
+    if (rgba.size() < size_t(width) * height * 4)
+        return false;
+
+    if (filepath.extension() == ".png")
+        return stbi_write_png(filepath.string().c_str(), static_cast<int>(width), static_cast<int>(height), 4, rgba.data(), static_cast<int>(width * 4)) != 0;
+
+    std::ofstream file(filepath, std::ios::binary);
+
+    if (!file)
+        return false;
+
+    const std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    file.write(header.data(), header.size());
+
+    std::vector<uint8_t> row(size_t(width) * 3);
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const uint8_t* src = rgba.data() + size_t(y) * width * 4;
+
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+
+    return file.good();
+}
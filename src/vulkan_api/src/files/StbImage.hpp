@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <memory>
+#include <span>
 
 struct StbImage
 {
@@ -21,6 +22,9 @@ struct StbImage
 
     bool loadFromFile(const std::filesystem::path& filepath, int mode) noexcept;
 
+//  Tightly packed RGBA rows. A .png path is encoded by stb_image_write, any other is written as a binary PPM without alpha
+    static bool saveToFile(const std::filesystem::path& filepath, uint32_t width, uint32_t height, std::span<const uint8_t> rgba) noexcept;
+
     std::unique_ptr<uint8_t[], StbImageDeleter> pixels;
     int32_t width = 0;
     int32_t height = 0;
@@ -0,0 +1,146 @@
+#include "spdlog/spdlog.h"
+
+#include "utils/CpuProfiler.hpp"
+#include "jobs/JobSystem.hpp"
+
+
+JobSystem::JobSystem() noexcept:
+    m_job(nullptr),
+    m_count(0),
+    m_next(0),
+    m_remaining(0),
+    m_active(0),
+    m_generation(0),
+    m_stop(false)
+{
+
+}
+
+
+JobSystem::~JobSystem()
+{
+    destroy();
+}
+
+
+bool JobSystem::create(uint32_t threadCount) noexcept
+{
+    destroy();
+
+    m_stop = false;
+
+    try
+    {
+        for (uint32_t i = 1; i < threadCount; ++i)
+            m_workers.emplace_back(&JobSystem::workerLoop, this);
+    }
+    catch (const std::system_error& error)
+    {
+        spdlog::error("Job system: failed to start a worker thread, {}", error.what());
+        destroy();
+
+        return false;
+    }
+
+    spdlog::info("Job system: {} threads", getThreadCount());
+
+    return true;
+}
+
+
+void JobSystem::destroy() noexcept
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_wakeUp.notify_all();
+
+    for (auto& worker : m_workers)
+        worker.join();
+
+    m_workers.clear();
+}
+
+
+void JobSystem::dispatch(uint32_t count, const Job& job) noexcept
+{
+    if (count == 0)
+        return;
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        m_job       = &job;
+        m_count     = count;
+        m_remaining = count;
+        m_next.store(0, std::memory_order_relaxed);
+        m_generation++;
+    }
+
+    m_wakeUp.notify_all();
+
+    runJobs();
+
+//  a late worker may still hold the job, so wait for it to leave before the next dispatch reuses the state
+    std::unique_lock lock(m_mutex);
+    m_finished.wait(lock, [this] { return m_remaining == 0 && m_active == 0; });
+
+    m_job = nullptr;
+}
+
+
+uint32_t JobSystem::getThreadCount() const noexcept
+{
+    return static_cast<uint32_t>(m_workers.size()) + 1;
+}
+
+
+void JobSystem::workerLoop() noexcept
+{
+    CPU_PROFILE_THREAD("job worker");
+
+    uint64_t generation = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock lock(m_mutex);
+            m_wakeUp.wait(lock, [&] { return m_stop || (m_generation != generation && m_job); });
+
+            if (m_stop)
+                return;
+
+            generation = m_generation;
+            m_active++;
+        }
+
+        runJobs();
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_active--;
+        }
+
+        m_finished.notify_all();
+    }
+}
+
+
+void JobSystem::runJobs() noexcept
+{
+    uint32_t completed = 0;
+
+    for (uint32_t index = m_next.fetch_add(1, std::memory_order_relaxed); index < m_count; index = m_next.fetch_add(1, std::memory_order_relaxed))
+    {
+        (*m_job)(index);
+        completed++;
+    }
+
+    if (completed)
+    {
+        std::lock_guard lock(m_mutex);
+        m_remaining -= completed;
+    }
+}
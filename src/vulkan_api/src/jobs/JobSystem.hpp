@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Fixed pool of worker threads running parallel for loops.
+// The thread calling dispatch() takes part in the work, so a system created with N threads spawns N - 1 workers.
+class JobSystem final
+{
+public:
+    using Job = std::function<void(uint32_t index)>;
+
+    JobSystem() noexcept;
+    ~JobSystem();
+
+    bool create(uint32_t threadCount) noexcept;
+    void destroy() noexcept;
+
+//  Runs job(index) for every index in [0, count) and returns once all of them have finished
+    void dispatch(uint32_t count, const Job& job) noexcept;
+
+    uint32_t getThreadCount() const noexcept;
+
+private:
+    void workerLoop() noexcept;
+    void runJobs() noexcept;
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_wakeUp;
+    std::condition_variable m_finished;
+
+//  state of the current dispatch, written under the mutex while no worker takes part in it
+    const Job*            m_job;
+    uint32_t              m_count;
+    std::atomic<uint32_t> m_next;
+    uint32_t              m_remaining;
+    uint32_t              m_active;
+    uint64_t              m_generation;
+    bool                  m_stop;
+};
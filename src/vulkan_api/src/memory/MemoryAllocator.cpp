@@ -0,0 +1,426 @@
+#include <cassert>
+#include <algorithm>
+#include <bit>
+
+#include "spdlog/spdlog.h"
+
+#include "utils/CpuProfiler.hpp"
+#include "context/Context.hpp"
+#include "memory/MemoryAllocator.hpp"
+
+
+static MemoryAllocator* g_allocator;
+
+// The smallest piece of a block the buddy allocator hands out
+static constexpr VkDeviceSize MIN_ALLOCATION_SIZE = 256;
+
+
+static uint32_t find_memory_type_index(const VkPhysicalDeviceMemoryProperties& memProperties, uint32_t typeFilter, VkMemoryPropertyFlags properties) noexcept
+{
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; ++i)
+        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
+            return i;
+
+    return UINT32_MAX;
+}
+
+
+static uint32_t size_to_order(VkDeviceSize size) noexcept
+{
+    const VkDeviceSize rounded = std::bit_ceil(std::max(size, MIN_ALLOCATION_SIZE));
+
+    return static_cast<uint32_t>(std::countr_zero(rounded / MIN_ALLOCATION_SIZE));
+}
+
+
+static VkDeviceSize order_to_size(uint32_t order) noexcept
+{
+    return MIN_ALLOCATION_SIZE << order;
+}
+
+
+static bool buddy_allocate(MemoryBlock* block, uint32_t order, VkDeviceSize* offset) noexcept
+{
+    auto& freeLists = block->freeLists;
+    uint32_t current = order;
+
+    while (current < freeLists.size() && freeLists[current].empty())
+        ++current;
+
+    if (current >= freeLists.size())
+        return false;
+
+    VkDeviceSize result = *freeLists[current].begin();
+    freeLists[current].erase(freeLists[current].begin());
+
+//  split the found range until it matches the requested order, the upper halves become free buddies
+    while (current > order)
+    {
+        --current;
+        freeLists[current].insert(result + order_to_size(current));
+    }
+
+    *offset = result;
+
+    return true;
+}
+
+
+static void buddy_free(MemoryBlock* block, VkDeviceSize offset, uint32_t order) noexcept
+{
+    auto& freeLists = block->freeLists;
+    const uint32_t maxOrder = static_cast<uint32_t>(freeLists.size() - 1);
+
+//  merge with the buddy while it is free
+    while (order < maxOrder)
+    {
+        const VkDeviceSize buddy = offset ^ order_to_size(order);
+        auto it = freeLists[order].find(buddy);
+
+        if (it == freeLists[order].end())
+            break;
+
+        freeLists[order].erase(it);
+        offset = std::min(offset, buddy);
+        ++order;
+    }
+
+    freeLists[order].insert(offset);
+}
+
+
+
+MemoryAllocator::MemoryAllocator() noexcept:
+    m_memoryProperties{},
+    m_blockSizes{},
+    m_dedicatedCount(0),
+    m_dedicatedBytes(0)
+{
+    assert(g_allocator == nullptr);
+    g_allocator = this;
+}
+
+
+MemoryAllocator::~MemoryAllocator()
+{
+    g_allocator = nullptr;
+}
+
+
+bool MemoryAllocator::create(VkDeviceSize preferredBlockSize) noexcept
+{
+    vkGetPhysicalDeviceMemoryProperties(vkContext->get<VkPhysicalDevice>(), &m_memoryProperties);
+
+    preferredBlockSize = std::bit_floor(std::max(preferredBlockSize, MIN_ALLOCATION_SIZE));
+
+    for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; ++i)
+    {
+        const VkDeviceSize heapSize = m_memoryProperties.memoryHeaps[m_memoryProperties.memoryTypes[i].heapIndex].size;
+
+//      small heaps (e.g. the 256 MB BAR window) must not be eaten by a couple of blocks
+        m_blockSizes[i] = std::min(preferredBlockSize, std::bit_floor(std::max(heapSize / 8, MIN_ALLOCATION_SIZE)));
+    }
+
+    spdlog::info("Memory allocator: {} memory types, preferred block size {} bytes", m_memoryProperties.memoryTypeCount, preferredBlockSize);
+
+    return (m_memoryProperties.memoryTypeCount > 0);
+}
+
+
+void MemoryAllocator::destroy() noexcept
+{
+    logStatistics();
+
+    const auto logicalDevice = vkContext->get<VkDevice>();
+    std::lock_guard lock(m_mutex);
+
+    for (auto& pool : m_pools)
+    {
+        for (auto& block : pool.blocks)
+        {
+            if (block->allocationCount)
+                spdlog::warn("Memory allocator: block of memory type {} destroyed with {} live allocations", pool.memoryTypeIndex, block->allocationCount);
+
+            if (block->mapped)
+                vkUnmapMemory(logicalDevice, block->memory);
+
+            vkFreeMemory(logicalDevice, block->memory, VK_NULL_HANDLE);
+        }
+    }
+
+    m_pools.clear();
+}
+
+
+bool MemoryAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear, Allocation* allocation) noexcept
+{
+    CPU_PROFILE_SCOPE("MemoryAllocator::allocate");
+
+    const uint32_t memoryTypeIndex = find_memory_type_index(m_memoryProperties, requirements.memoryTypeBits, properties);
+
+    if (memoryTypeIndex == UINT32_MAX)
+    {
+        spdlog::error("Memory allocator: no memory type satisfies the properties {:#x}", properties);
+
+        return false;
+    }
+
+//  huge resources (render targets, big textures) get their own VkDeviceMemory
+    const VkDeviceSize requiredSize = std::max(requirements.size, requirements.alignment);
+
+    if (requiredSize > m_blockSizes[memoryTypeIndex] / 2)
+        return allocateDedicated(requirements, memoryTypeIndex, allocation);
+
+//  buddy ranges are aligned to their own size, so rounding up to the alignment is enough
+    const uint32_t order = size_to_order(requiredSize);
+
+    std::lock_guard lock(m_mutex);
+
+    Pool* pool = getPool(memoryTypeIndex, linear);
+    VkDeviceSize offset = 0;
+    MemoryBlock* target = nullptr;
+
+    for (auto& block : pool->blocks)
+    {
+        if (buddy_allocate(block.get(), order, &offset))
+        {
+            target = block.get();
+            break;
+        }
+    }
+
+    if (!target)
+    {
+        target = createBlock(pool);
+
+        if (!target || !buddy_allocate(target, order, &offset))
+            return false;
+    }
+
+    target->allocationCount++;
+    target->bytesRequested += requirements.size;
+    target->bytesAllocated += order_to_size(order);
+
+    allocation->memory          = target->memory;
+    allocation->offset          = offset;
+    allocation->size            = requirements.size;
+    allocation->mapped          = target->mapped ? static_cast<uint8_t*>(target->mapped) + offset : nullptr;
+    allocation->block           = target;
+    allocation->order           = order;
+    allocation->memoryTypeIndex = memoryTypeIndex;
+
+    return true;
+}
+
+
+void MemoryAllocator::free(Allocation& allocation) noexcept
+{
+    if (!allocation.memory)
+        return;
+
+    if (allocation.block)
+    {
+        std::lock_guard lock(m_mutex);
+
+        MemoryBlock* block = allocation.block;
+        buddy_free(block, allocation.offset, allocation.order);
+
+        block->allocationCount--;
+        block->bytesRequested -= allocation.size;
+        block->bytesAllocated -= order_to_size(allocation.order);
+    }
+    else
+    {
+        const auto logicalDevice = vkContext->get<VkDevice>();
+
+        if (allocation.mapped)
+            vkUnmapMemory(logicalDevice, allocation.memory);
+
+        vkFreeMemory(logicalDevice, allocation.memory, VK_NULL_HANDLE);
+
+        std::lock_guard lock(m_mutex);
+        m_dedicatedCount--;
+        m_dedicatedBytes -= allocation.size;
+    }
+
+    allocation = {};
+}
+
+
+void MemoryAllocator::trim() noexcept
+{
+    const auto logicalDevice = vkContext->get<VkDevice>();
+    std::lock_guard lock(m_mutex);
+
+    for (auto& pool : m_pools)
+    {
+        std::erase_if(pool.blocks, [logicalDevice](const std::unique_ptr<MemoryBlock>& block)
+        {
+            if (block->allocationCount)
+                return false;
+
+            if (block->mapped)
+                vkUnmapMemory(logicalDevice, block->memory);
+
+            vkFreeMemory(logicalDevice, block->memory, VK_NULL_HANDLE);
+
+            return true;
+        });
+    }
+}
+
+
+MemoryAllocator::Statistics MemoryAllocator::getStatistics() const noexcept
+{
+    Statistics stats = {};
+    VkDeviceSize freeBytes = 0;
+    VkDeviceSize contiguousFreeBytes = 0; // sum of the largest free range of every block
+
+    std::lock_guard lock(m_mutex);
+
+    for (const auto& pool : m_pools)
+    {
+        for (const auto& block : pool.blocks)
+        {
+            stats.blockCount++;
+            stats.allocationCount += block->allocationCount;
+            stats.bytesReserved   += block->size;
+            stats.bytesRequested  += block->bytesRequested;
+            stats.bytesAllocated  += block->bytesAllocated;
+
+            VkDeviceSize largestInBlock = 0;
+
+            for (uint32_t order = 0; order < block->freeLists.size(); ++order)
+            {
+                if (block->freeLists[order].empty())
+                    continue;
+
+                freeBytes += order_to_size(order) * block->freeLists[order].size();
+                largestInBlock = order_to_size(order);
+            }
+
+            contiguousFreeBytes   += largestInBlock;
+            stats.largestFreeRange = std::max(stats.largestFreeRange, largestInBlock);
+        }
+    }
+
+    stats.dedicatedCount   = m_dedicatedCount;
+    stats.allocationCount += m_dedicatedCount;
+    stats.bytesReserved   += m_dedicatedBytes;
+    stats.bytesRequested  += m_dedicatedBytes;
+    stats.bytesAllocated  += m_dedicatedBytes;
+    stats.fragmentation    = freeBytes ? 1.f - static_cast<float>(contiguousFreeBytes) / static_cast<float>(freeBytes) : 0.f;
+
+    return stats;
+}
+
+
+void MemoryAllocator::logStatistics() const noexcept
+{
+    const auto stats = getStatistics();
+
+    spdlog::info("Memory allocator: {} blocks, {} dedicated, {} allocations", stats.blockCount, stats.dedicatedCount, stats.allocationCount);
+    spdlog::info("Memory allocator: reserved {} bytes, allocated {} bytes, requested {} bytes", stats.bytesReserved, stats.bytesAllocated, stats.bytesRequested);
+    spdlog::info("Memory allocator: largest free range {} bytes, fragmentation {:.3f}", stats.largestFreeRange, stats.fragmentation);
+}
+
+
+MemoryAllocator* MemoryAllocator::getInstance() noexcept
+{
+    return g_allocator;
+}
+
+
+MemoryAllocator::Pool* MemoryAllocator::getPool(uint32_t memoryTypeIndex, bool linear) noexcept
+{
+    for (auto& pool : m_pools)
+        if (pool.memoryTypeIndex == memoryTypeIndex && pool.linear == linear)
+            return &pool;
+
+    m_pools.push_back({ memoryTypeIndex, linear, {} });
+
+    return &m_pools.back();
+}
+
+
+MemoryBlock* MemoryAllocator::createBlock(Pool* pool) noexcept
+{
+    const auto logicalDevice = vkContext->get<VkDevice>();
+    const VkDeviceSize blockSize = m_blockSizes[pool->memoryTypeIndex];
+
+    const VkMemoryAllocateInfo allocInfo =
+    {
+        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext           = VK_NULL_HANDLE,
+        .allocationSize  = blockSize,
+        .memoryTypeIndex = pool->memoryTypeIndex
+    };
+
+    auto block = std::make_unique<MemoryBlock>();
+
+    if (vkAllocateMemory(logicalDevice, &allocInfo, VK_NULL_HANDLE, &block->memory) != VK_SUCCESS)
+    {
+        spdlog::error("Memory allocator: failed to allocate a block of {} bytes from memory type {}", blockSize, pool->memoryTypeIndex);
+
+        return nullptr;
+    }
+
+    if (m_memoryProperties.memoryTypes[pool->memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        if (vkMapMemory(logicalDevice, block->memory, 0, VK_WHOLE_SIZE, 0, &block->mapped) != VK_SUCCESS)
+        {
+            vkFreeMemory(logicalDevice, block->memory, VK_NULL_HANDLE);
+
+            return nullptr;
+        }
+    }
+
+    block->size = blockSize;
+    block->freeLists.resize(size_to_order(blockSize) + 1);
+    block->freeLists.back().insert(0);
+
+    spdlog::debug("Memory allocator: new {} block of {} bytes, memory type {}", pool->linear ? "linear" : "optimal", blockSize, pool->memoryTypeIndex);
+
+    pool->blocks.push_back(std::move(block));
+
+    return pool->blocks.back().get();
+}
+
+
+bool MemoryAllocator::allocateDedicated(const VkMemoryRequirements& requirements, uint32_t memoryTypeIndex, Allocation* allocation) noexcept
+{
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+    const VkMemoryAllocateInfo allocInfo =
+    {
+        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext           = VK_NULL_HANDLE,
+        .allocationSize  = requirements.size,
+        .memoryTypeIndex = memoryTypeIndex
+    };
+
+    Allocation result = {};
+
+    if (vkAllocateMemory(logicalDevice, &allocInfo, VK_NULL_HANDLE, &result.memory) != VK_SUCCESS)
+        return false;
+
+    if (m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        if (vkMapMemory(logicalDevice, result.memory, 0, VK_WHOLE_SIZE, 0, &result.mapped) != VK_SUCCESS)
+        {
+            vkFreeMemory(logicalDevice, result.memory, VK_NULL_HANDLE);
+
+            return false;
+        }
+    }
+
+    result.size            = requirements.size;
+    result.memoryTypeIndex = memoryTypeIndex;
+    *allocation            = result;
+
+    std::lock_guard lock(m_mutex);
+    m_dedicatedCount++;
+    m_dedicatedBytes += requirements.size;
+
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unordered_set>
+
+#include <vulkan/vulkan.h>
+
+
+struct Allocation
+{
+    VkDeviceMemory      memory = VK_NULL_HANDLE;
+    VkDeviceSize        offset = 0;
+    VkDeviceSize        size   = 0;
+    void*               mapped = nullptr;
+    struct MemoryBlock* block  = nullptr; // nullptr for dedicated allocations
+    uint32_t            order  = 0;
+    uint32_t            memoryTypeIndex = UINT32_MAX;
+};
+
+
+struct MemoryBlock
+{
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize   size   = 0;
+    void*          mapped = nullptr;
+    uint32_t       allocationCount = 0;
+    VkDeviceSize   bytesRequested  = 0;
+    VkDeviceSize   bytesAllocated  = 0;
+    std::vector<std::unordered_set<VkDeviceSize>> freeLists; // free offsets per buddy order
+};
+
+
+// Block based device memory allocator.
+// Every memory type gets a list of large blocks which are split by a buddy allocator.
+// Linear (buffers) and optimal (images) resources never share a block, so bufferImageGranularity is never violated.
+// Host visible blocks are persistently mapped, Allocation::mapped points to the first byte of the sub-range.
+class MemoryAllocator final
+{
+public:
+    struct Statistics
+    {
+        uint32_t     blockCount;
+        uint32_t     dedicatedCount;
+        uint32_t     allocationCount;
+        VkDeviceSize bytesReserved;  // sum of all VkDeviceMemory objects
+        VkDeviceSize bytesRequested; // sum of requested sizes
+        VkDeviceSize bytesAllocated; // sum of sizes rounded to the buddy order
+        VkDeviceSize largestFreeRange;
+        float        fragmentation;  // 0 - free memory of every block is one range, 1 - free memory is scattered
+    };
+
+    MemoryAllocator() noexcept;
+    ~MemoryAllocator();
+
+    bool create(VkDeviceSize preferredBlockSize = 64ull * 1024 * 1024) noexcept;
+    void destroy() noexcept;
+
+    bool allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear, Allocation* allocation) noexcept;
+    void free(Allocation& allocation) noexcept;
+
+//  Defragmentation hook: returns the memory of completely empty blocks back to the driver
+    void trim() noexcept;
+
+    Statistics getStatistics() const noexcept;
+    void logStatistics() const noexcept;
+
+    static MemoryAllocator* getInstance() noexcept;
+
+private:
+    struct Pool
+    {
+        uint32_t memoryTypeIndex;
+        bool     linear;
+        std::vector<std::unique_ptr<MemoryBlock>> blocks;
+    };
+
+    Pool* getPool(uint32_t memoryTypeIndex, bool linear) noexcept;
+    MemoryBlock* createBlock(Pool* pool) noexcept;
+    bool allocateDedicated(const VkMemoryRequirements& requirements, uint32_t memoryTypeIndex, Allocation* allocation) noexcept;
+
+    VkPhysicalDeviceMemoryProperties m_memoryProperties;
+    VkDeviceSize m_blockSizes[VK_MAX_MEMORY_TYPES];
+    std::vector<Pool> m_pools;
+
+    uint32_t     m_dedicatedCount;
+    VkDeviceSize m_dedicatedBytes;
+
+    mutable std::mutex m_mutex;
+};
+
+#define vkAllocator MemoryAllocator::getInstance()
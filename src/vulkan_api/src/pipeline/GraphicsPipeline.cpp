@@ -1,36 +1,60 @@
 #include <cstring>
 #include <array>
+#include <chrono>
 
 #include <cglm/struct/mat4.h>
+#include "spdlog/spdlog.h"
 
 #include "utils/Tools.hpp"
 #include "context/Context.hpp"
-#include "view/swapchain/Swapchain.hpp"
-#include "view/View.hpp"
 #include "pipeline/state/PipelineState.hpp"
 #include "pipeline/GraphicsPipeline.hpp"
 
 
-bool GraphicsPipeline::create(const PipelineState& state) noexcept
+bool GraphicsPipeline::create(const PipelineState& state, VkDescriptorSetLayout setLayout, VkPipelineLayout pipelineLayout) noexcept
 {
     destroy(); // for recreate case
 
-    const auto physicalDevice = vkContext->get<VkPhysicalDevice>(); 
     const auto logicalDevice = vkContext->get<VkDevice>();
 
-    const VkFormat colorFormat = vkView->getSwapchain()->getColorAttachment(0).format;
-    const VkFormat depthFormat = vkView->getSwapchain()->getDepthAttachment().format;
+    descriptorSetLayout = setLayout;
+    layout              = pipelineLayout;
+    pushConstantStages  = 0;
+
+//  vkCmdPushConstants names every stage of the ranges it overlaps
+    for (const auto& range : state.constantRanges)
+        pushConstantStages |= range.stageFlags;
 
     const VkPipelineVertexInputStateCreateInfo vertexInput = state.vertexInputState.getInfo();
+    const VkSpecializationInfo specializationInfo = state.specialization.getInfo();
+
+    std::vector<VkPipelineShaderStageCreateInfo> stages = state.shaderInfo;
+
+    if (!state.specialization.empty())
+        for (auto& stage : stages)
+            stage.pSpecializationInfo = &specializationInfo;
+
+//  tells whether the pipeline cache held the pipeline, a loaded cache file alone does not mean it did
+    VkPipelineCreationFeedback feedback = {};
+    std::vector<VkPipelineCreationFeedback> stageFeedbacks(stages.size());
+
+    const VkPipelineCreationFeedbackCreateInfo feedbackInfo =
+    {
+        .sType                              = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO,
+        .pNext                              = VK_NULL_HANDLE,
+        .pPipelineCreationFeedback          = &feedback,
+        .pipelineStageCreationFeedbackCount = static_cast<uint32_t>(stageFeedbacks.size()),
+        .pPipelineStageCreationFeedbacks    = stageFeedbacks.data()
+    };
 
     const VkPipelineRenderingCreateInfoKHR pipelineRenderingInfo =
     {
         .sType                   = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR,
-        .pNext                   = VK_NULL_HANDLE,
+        .pNext                   = &feedbackInfo,
         .viewMask                = 0,
         .colorAttachmentCount    = 1,
-        .pColorAttachmentFormats = &colorFormat,
-        .depthAttachmentFormat   = depthFormat,
+        .pColorAttachmentFormats = &state.colorFormat,
+        .depthAttachmentFormat   = state.depthFormat,
         .stencilAttachmentFormat = VK_FORMAT_UNDEFINED
     };
 
@@ -60,23 +84,6 @@ bool GraphicsPipeline::create(const PipelineState& state) noexcept
         .pDynamicStates    = dynamicStates.data()
     };
 
-    if (vkCreateDescriptorSetLayout(logicalDevice, &state.layoutInfo, VK_NULL_HANDLE, &descriptorSetLayout) != VK_SUCCESS)
-        return false;
-
-    const VkPipelineLayoutCreateInfo pipelineLayoutInfo = 
-    {
-        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-        .pNext                  = VK_NULL_HANDLE,
-        .flags                  = 0,
-        .setLayoutCount         = 1,
-        .pSetLayouts            = &descriptorSetLayout,
-        .pushConstantRangeCount = static_cast<uint32_t>(state.constantRanges.size()),
-        .pPushConstantRanges    = state.constantRanges.data()
-    };
-
-    if (vkCreatePipelineLayout(logicalDevice, &pipelineLayoutInfo, VK_NULL_HANDLE, &layout) != VK_SUCCESS)
-        return false;
-
     const VkPipelineDepthStencilStateCreateInfo depthStencilInfo = 
     {
         .sType                 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
@@ -98,8 +105,8 @@ bool GraphicsPipeline::create(const PipelineState& state) noexcept
         .sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
         .pNext               = &pipelineRenderingInfo,
         .flags               = 0,
-        .stageCount          = static_cast<uint32_t>(state.shaderInfo.size()),
-        .pStages             = state.shaderInfo.data(),
+        .stageCount          = static_cast<uint32_t>(stages.size()),
+        .pStages             = stages.data(),
         .pVertexInputState   = &vertexInput,
         .pInputAssemblyState = &state.inputAssembly,
         .pTessellationState  = VK_NULL_HANDLE,
@@ -116,7 +123,24 @@ bool GraphicsPipeline::create(const PipelineState& state) noexcept
         .basePipelineIndex   = 0
     };
 
-    return (vkCreateGraphicsPipelines(logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, VK_NULL_HANDLE, &handle) == VK_SUCCESS);
+    const auto start = std::chrono::steady_clock::now();
+    const VkResult result = vkCreateGraphicsPipelines(logicalDevice, vkContext->get<VkPipelineCache>(), 1, &pipelineInfo, VK_NULL_HANDLE, &handle);
+    const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const char* cache = "not reported";
+
+    if (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT)
+        cache = (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT) ? "hit" : "miss";
+
+    spdlog::info("Graphics pipeline created in {:.3f} ms, pipeline cache {}, cache file {}", elapsed, cache, vkContext->isPipelineCacheWarm() ? "loaded" : "absent");
+
+    return (result == VK_SUCCESS);
+}
+
+
+void GraphicsPipeline::pushConstants(VkCommandBuffer cmd, const void* data, uint32_t size, uint32_t offset) const noexcept
+{
+    vkCmdPushConstants(cmd, layout, pushConstantStages, offset, size, data);
 }
 
 
@@ -127,13 +151,8 @@ void GraphicsPipeline::destroy() noexcept
     if (handle)
         vkDestroyPipeline(logicalDevice, handle, VK_NULL_HANDLE);
 
-    if (layout)
-        vkDestroyPipelineLayout(logicalDevice, layout, VK_NULL_HANDLE);
-
-    if (descriptorSetLayout)
-        vkDestroyDescriptorSetLayout(logicalDevice, descriptorSetLayout, VK_NULL_HANDLE);
-
     handle              = VK_NULL_HANDLE;
     layout              = VK_NULL_HANDLE;
     descriptorSetLayout = VK_NULL_HANDLE; 
+    pushConstantStages  = 0;
 }
\ No newline at end of file
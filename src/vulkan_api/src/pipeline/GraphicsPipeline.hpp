@@ -1,12 +1,17 @@
 #pragma once
 
 
+// The layouts are shared and owned by the PipelineLibrary, destroy() only releases the pipeline itself.
 struct GraphicsPipeline
 {
-    bool create(const struct PipelineState& state) noexcept;
+    bool create(const struct PipelineState& state, VkDescriptorSetLayout setLayout, VkPipelineLayout pipelineLayout) noexcept;
     void destroy() noexcept;
 
+//  Writes the per draw block, offset and size must stay within the push constant range of the layout
+    void pushConstants(VkCommandBuffer cmd, const void* data, uint32_t size, uint32_t offset = 0) const noexcept;
+
     VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
     VkPipelineLayout      layout              = VK_NULL_HANDLE;
     VkPipeline            handle              = VK_NULL_HANDLE;
+    VkShaderStageFlags    pushConstantStages  = 0; // stages of the push constant range, 0 - the layout has none
 };
@@ -0,0 +1,528 @@
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <type_traits>
+
+#include "spdlog/spdlog.h"
+
+#include "context/Context.hpp"
+#include "pipeline/PipelineLibrary.hpp"
+
+
+namespace
+{
+//  FNV-1a over the fields which take part in the object creation, padding and pointers are never hashed
+    struct Hasher
+    {
+        uint64_t value = 14695981039346656037ull;
+
+        template<class T>
+        void add(T data) noexcept
+        {
+            static_assert(std::is_scalar_v<T>);
+
+            const auto* bytes = reinterpret_cast<const uint8_t*>(&data);
+
+            for (size_t i = 0; i < sizeof(T); ++i)
+            {
+                value ^= bytes[i];
+                value *= 1099511628211ull;
+            }
+        }
+
+        void add(const char* string) noexcept
+        {
+            for (; string && *string; ++string)
+                add(*string);
+
+            add('\0');
+        }
+    };
+}
+
+
+static void hash_bindings(Hasher& hasher, const VkDescriptorSetLayoutCreateInfo& info) noexcept
+{
+    hasher.add(info.flags);
+    hasher.add(info.bindingCount);
+
+    for (uint32_t i = 0; i < info.bindingCount; ++i)
+    {
+        const auto& binding = info.pBindings[i];
+
+        hasher.add(binding.binding);
+        hasher.add(binding.descriptorType);
+        hasher.add(binding.descriptorCount);
+        hasher.add(binding.stageFlags);
+
+        if (binding.pImmutableSamplers)
+            for (uint32_t j = 0; j < binding.descriptorCount; ++j)
+                hasher.add(binding.pImmutableSamplers[j]);
+    }
+}
+
+
+static void hash_push_constants(Hasher& hasher, std::span<const VkPushConstantRange> ranges) noexcept
+{
+    hasher.add(ranges.size());
+
+    for (const auto& range : ranges)
+    {
+        hasher.add(range.stageFlags);
+        hasher.add(range.offset);
+        hasher.add(range.size);
+    }
+}
+
+
+
+PipelineLibrary::PipelineLibrary() noexcept:
+    m_stop(false),
+    m_hitCount(0),
+    m_missCount(0)
+{
+
+}
+
+
+PipelineLibrary::~PipelineLibrary()
+{
+    destroy();
+}
+
+
+bool PipelineLibrary::create(uint32_t workerCount) noexcept
+{
+    m_stop = false;
+
+    try
+    {
+        for (uint32_t i = 0; i < workerCount; ++i)
+            m_workers.emplace_back(&PipelineLibrary::workerLoop, this);
+    }
+    catch (const std::system_error& error)
+    {
+        spdlog::error("Pipeline library: failed to start a worker thread, {}", error.what());
+
+        return false;
+    }
+
+    spdlog::info("Pipeline library: {} background compile threads", workerCount);
+
+    return true;
+}
+
+
+void PipelineLibrary::destroy() noexcept
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_requested.notify_all();
+
+    for (auto& worker : m_workers)
+        worker.join();
+
+    m_workers.clear();
+
+    if (m_pipelines.empty() && m_pipelineLayouts.empty() && m_setLayouts.empty())
+        return;
+
+    const auto stats = getStatistics();
+    spdlog::info("Pipeline library: {} pipelines, {} pipeline layouts, {} set layouts, {} hits, {} misses",
+                 stats.pipelineCount, stats.pipelineLayoutCount, stats.setLayoutCount, stats.hitCount, stats.missCount);
+
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+    for (auto& [key, entry] : m_pipelines)
+        entry.pipeline.destroy();
+
+    for (auto& [key, layout] : m_pipelineLayouts)
+        vkDestroyPipelineLayout(logicalDevice, layout, VK_NULL_HANDLE);
+
+    for (auto& [key, layout] : m_setLayouts)
+        vkDestroyDescriptorSetLayout(logicalDevice, layout, VK_NULL_HANDLE);
+
+    m_pipelines.clear();
+    m_pipelineLayouts.clear();
+    m_setLayouts.clear();
+    m_requests.clear();
+}
+
+
+VkDescriptorSetLayout PipelineLibrary::getDescriptorSetLayout(const VkDescriptorSetLayoutCreateInfo& info) noexcept
+{
+    Hasher hasher;
+    hash_bindings(hasher, info);
+
+    std::lock_guard lock(m_mutex);
+
+    if (auto it = m_setLayouts.find(hasher.value); it != m_setLayouts.end())
+    {
+        m_hitCount++;
+
+        return it->second;
+    }
+
+    VkDescriptorSetLayout layout;
+
+    if (vkCreateDescriptorSetLayout(vkContext->get<VkDevice>(), &info, VK_NULL_HANDLE, &layout) != VK_SUCCESS)
+        return VK_NULL_HANDLE;
+
+    m_missCount++;
+    m_setLayouts.emplace(hasher.value, layout);
+
+    return layout;
+}
+
+
+VkPipelineLayout PipelineLibrary::getPipelineLayout(std::span<const VkDescriptorSetLayout> setLayouts, std::span<const VkPushConstantRange> ranges) noexcept
+{
+    Hasher hasher;
+    hasher.add(setLayouts.size());
+
+    for (VkDescriptorSetLayout setLayout : setLayouts)
+        hasher.add(setLayout);
+
+    hash_push_constants(hasher, ranges);
+
+    std::lock_guard lock(m_mutex);
+
+    if (auto it = m_pipelineLayouts.find(hasher.value); it != m_pipelineLayouts.end())
+    {
+        m_hitCount++;
+
+        return it->second;
+    }
+
+    const VkPipelineLayoutCreateInfo pipelineLayoutInfo =
+    {
+        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .pNext                  = VK_NULL_HANDLE,
+        .flags                  = 0,
+        .setLayoutCount         = static_cast<uint32_t>(setLayouts.size()),
+        .pSetLayouts            = setLayouts.data(),
+        .pushConstantRangeCount = static_cast<uint32_t>(ranges.size()),
+        .pPushConstantRanges    = ranges.data()
+    };
+
+    VkPipelineLayout layout;
+
+    if (vkCreatePipelineLayout(vkContext->get<VkDevice>(), &pipelineLayoutInfo, VK_NULL_HANDLE, &layout) != VK_SUCCESS)
+        return VK_NULL_HANDLE;
+
+    m_missCount++;
+    m_pipelineLayouts.emplace(hasher.value, layout);
+
+    return layout;
+}
+
+
+bool PipelineLibrary::getPipeline(const PipelineState& state, GraphicsPipeline* pipeline) noexcept
+{
+    const uint64_t key = requestPipeline(state);
+
+    if (key == 0)
+        return false;
+
+    return waitPipeline(key, pipeline);
+}
+
+
+bool PipelineLibrary::waitPipeline(uint64_t key, GraphicsPipeline* pipeline) noexcept
+{
+    std::unique_lock lock(m_mutex);
+
+    auto it = m_pipelines.find(key);
+
+    if (it == m_pipelines.end())
+        return false;
+
+//  nobody has picked the request up yet, it is built here instead of waiting for a worker
+    if (it->second.status == Status::Pending)
+    {
+        auto queued = std::find_if(m_requests.begin(), m_requests.end(), [key](const Request& request) { return request.key == key; });
+
+        if (queued != m_requests.end())
+        {
+            Request request = std::move(*queued);
+            m_requests.erase(queued);
+
+            lock.unlock();
+            build(request);
+            lock.lock();
+        }
+    }
+
+//  the entry is looked up again, once built another thread may release it while the lock is dropped
+    auto isBuilt = [this, key]
+    {
+        auto built = m_pipelines.find(key);
+
+        return (built == m_pipelines.end() || built->second.status != Status::Pending);
+    };
+
+    m_built.wait(lock, isBuilt);
+
+    it = m_pipelines.find(key);
+
+    if (it == m_pipelines.end())
+        return false;
+
+    *pipeline = it->second.pipeline;
+
+    return (it->second.status == Status::Ready);
+}
+
+
+uint64_t PipelineLibrary::requestPipeline(const PipelineState& state) noexcept
+{
+    const uint64_t key = hash(state);
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (m_pipelines.contains(key))
+        {
+            m_hitCount++;
+
+            return key;
+        }
+    }
+
+    Request request = { key, state, {}, VK_NULL_HANDLE, VK_NULL_HANDLE };
+
+    if (!resolveLayouts(state, &request.setLayout, &request.pipelineLayout))
+        return 0;
+
+//  the copy outlives the caller, the bindings were only needed to resolve the layouts,
+//  the ranges move along with the request and the span into them stays valid
+    request.constantRanges.assign(state.constantRanges.begin(), state.constantRanges.end());
+    request.state.layoutInfo.bindingCount = 0;
+    request.state.layoutInfo.pBindings    = VK_NULL_HANDLE;
+    request.state.constantRanges          = request.constantRanges;
+
+    {
+        std::lock_guard lock(m_mutex);
+
+//      another thread may have requested the same state in the meantime
+        if (!m_pipelines.try_emplace(key, Entry{ {}, Status::Pending }).second)
+        {
+            m_hitCount++;
+
+            return key;
+        }
+
+        m_missCount++;
+        m_requests.push_back(std::move(request));
+    }
+
+    m_requested.notify_one();
+
+    return key;
+}
+
+
+bool PipelineLibrary::findPipeline(uint64_t key, GraphicsPipeline* pipeline) const noexcept
+{
+    std::lock_guard lock(m_mutex);
+
+    auto it = m_pipelines.find(key);
+
+    if (it == m_pipelines.end() || it->second.status != Status::Ready)
+        return false;
+
+    *pipeline = it->second.pipeline;
+
+    return true;
+}
+
+
+bool PipelineLibrary::isPending(uint64_t key) const noexcept
+{
+    std::lock_guard lock(m_mutex);
+
+    auto it = m_pipelines.find(key);
+
+    return (it != m_pipelines.end() && it->second.status == Status::Pending);
+}
+
+
+bool PipelineLibrary::releasePipeline(uint64_t key) noexcept
+{
+    std::lock_guard lock(m_mutex);
+
+    auto it = m_pipelines.find(key);
+
+    if (it == m_pipelines.end() || it->second.status == Status::Pending)
+        return false;
+
+    it->second.pipeline.destroy();
+    m_pipelines.erase(it);
+
+    return true;
+}
+
+
+PipelineLibrary::Statistics PipelineLibrary::getStatistics() const noexcept
+{
+    std::lock_guard lock(m_mutex);
+
+    return
+    {
+        .pipelineCount       = static_cast<uint32_t>(m_pipelines.size()),
+        .pipelineLayoutCount = static_cast<uint32_t>(m_pipelineLayouts.size()),
+        .setLayoutCount      = static_cast<uint32_t>(m_setLayouts.size()),
+        .hitCount            = m_hitCount,
+        .missCount           = m_missCount
+    };
+}
+
+
+uint64_t PipelineLibrary::hash(const PipelineState& state) noexcept
+{
+    Hasher hasher;
+
+    hasher.add(state.shaderInfo.size());
+
+    for (const auto& stage : state.shaderInfo)
+    {
+        hasher.add(stage.stage);
+        hasher.add(stage.module);
+        hasher.add(stage.pName);
+    }
+
+//  a variant differs from its siblings only by these values, the offsets depend on the order of the set() calls
+    hasher.add(state.specialization.entries.size());
+
+    for (const auto& entry : state.specialization.entries)
+    {
+        hasher.add(entry.constantID);
+        hasher.add(state.specialization.data[entry.offset / sizeof(uint32_t)]);
+    }
+
+    const auto& vertexInput = state.vertexInputState;
+    hasher.add(vertexInput.bindingDescriptions.size());
+
+    for (const auto& binding : vertexInput.bindingDescriptions)
+    {
+        hasher.add(binding.binding);
+        hasher.add(binding.stride);
+        hasher.add(binding.inputRate);
+    }
+
+    hasher.add(vertexInput.attributeDescriptions.size());
+
+    for (const auto& attribute : vertexInput.attributeDescriptions)
+    {
+        hasher.add(attribute.location);
+        hasher.add(attribute.binding);
+        hasher.add(attribute.format);
+        hasher.add(attribute.offset);
+    }
+
+    hasher.add(state.inputAssembly.topology);
+    hasher.add(state.inputAssembly.primitiveRestartEnable);
+
+    hasher.add(state.viewportState.viewportCount);
+    hasher.add(state.viewportState.scissorCount);
+
+    const auto& rasterizer = state.rasterizer;
+    hasher.add(rasterizer.depthClampEnable);
+    hasher.add(rasterizer.rasterizerDiscardEnable);
+    hasher.add(rasterizer.polygonMode);
+    hasher.add(rasterizer.cullMode);
+    hasher.add(rasterizer.frontFace);
+    hasher.add(rasterizer.depthBiasEnable);
+    hasher.add(rasterizer.depthBiasConstantFactor);
+    hasher.add(rasterizer.depthBiasClamp);
+    hasher.add(rasterizer.depthBiasSlopeFactor);
+    hasher.add(rasterizer.lineWidth);
+
+    const auto& multisampling = state.multisampling;
+    hasher.add(multisampling.rasterizationSamples);
+    hasher.add(multisampling.sampleShadingEnable);
+    hasher.add(multisampling.minSampleShading);
+    hasher.add(multisampling.alphaToCoverageEnable);
+    hasher.add(multisampling.alphaToOneEnable);
+
+    const auto& blending = state.colorBlending;
+    hasher.add(blending.blendEnable);
+    hasher.add(blending.srcColorBlendFactor);
+    hasher.add(blending.dstColorBlendFactor);
+    hasher.add(blending.colorBlendOp);
+    hasher.add(blending.srcAlphaBlendFactor);
+    hasher.add(blending.dstAlphaBlendFactor);
+    hasher.add(blending.alphaBlendOp);
+    hasher.add(blending.colorWriteMask);
+
+    hasher.add(state.colorFormat);
+    hasher.add(state.depthFormat);
+
+    hash_bindings(hasher, state.layoutInfo);
+    hash_push_constants(hasher, state.constantRanges);
+    hasher.add(state.textureSetLayout);
+
+//  0 is reserved for a failed request
+    return hasher.value ? hasher.value : 1;
+}
+
+
+bool PipelineLibrary::resolveLayouts(const PipelineState& state, VkDescriptorSetLayout* setLayout, VkPipelineLayout* pipelineLayout) noexcept
+{
+    *setLayout = getDescriptorSetLayout(state.layoutInfo);
+
+    if (!*setLayout)
+        return false;
+
+    const std::array<VkDescriptorSetLayout, 2> setLayouts = { *setLayout, state.textureSetLayout };
+    const size_t setCount = state.textureSetLayout ? 2 : 1;
+
+    *pipelineLayout = getPipelineLayout(std::span(setLayouts).first(setCount), state.constantRanges);
+
+    return (*pipelineLayout != VK_NULL_HANDLE);
+}
+
+
+void PipelineLibrary::build(Request& request) noexcept
+{
+    GraphicsPipeline pipeline;
+    const bool created = pipeline.create(request.state, request.setLayout, request.pipelineLayout);
+
+    if (!created)
+        spdlog::error("Pipeline library: failed to create the pipeline {:016x}", request.key);
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        Entry& entry   = m_pipelines[request.key];
+        entry.pipeline = pipeline;
+        entry.status   = created ? Status::Ready : Status::Failed;
+    }
+
+    m_built.notify_all();
+}
+
+
+void PipelineLibrary::workerLoop() noexcept
+{
+    for (;;)
+    {
+        Request request;
+
+        {
+            std::unique_lock lock(m_mutex);
+            m_requested.wait(lock, [this] { return m_stop || !m_requests.empty(); });
+
+            if (m_stop)
+                return;
+
+            request = std::move(m_requests.front());
+            m_requests.pop_front();
+        }
+
+        build(request);
+    }
+}
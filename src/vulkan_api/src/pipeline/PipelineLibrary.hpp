@@ -0,0 +1,99 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "pipeline/GraphicsPipeline.hpp"
+#include "pipeline/state/PipelineState.hpp"
+
+
+// Owner of every pipeline, pipeline layout and descriptor set layout.
+// Objects are keyed by a hash of their description, asking twice for the same state returns the same handles.
+// Pipelines requested with requestPipeline() are compiled by worker threads, the frame keeps drawing meanwhile.
+class PipelineLibrary final
+{
+public:
+    struct Statistics
+    {
+        uint32_t pipelineCount;
+        uint32_t pipelineLayoutCount;
+        uint32_t setLayoutCount;
+        uint32_t hitCount;   // requests served by an existing object
+        uint32_t missCount;  // requests which created an object
+    };
+
+    PipelineLibrary() noexcept;
+    ~PipelineLibrary();
+
+    bool create(uint32_t workerCount = 1) noexcept;
+    void destroy() noexcept;
+
+    VkDescriptorSetLayout getDescriptorSetLayout(const VkDescriptorSetLayoutCreateInfo& info) noexcept;
+    VkPipelineLayout getPipelineLayout(std::span<const VkDescriptorSetLayout> setLayouts, std::span<const VkPushConstantRange> ranges) noexcept;
+
+//  Returns the pipeline of the state, it is compiled on the calling thread if nobody asked for it before
+    bool getPipeline(const PipelineState& state, GraphicsPipeline* pipeline) noexcept;
+
+//  Queues the compilation on a worker and returns the key to poll with findPipeline().
+//  The shader modules referenced by the state must stay alive until the pipeline is ready.
+    uint64_t requestPipeline(const PipelineState& state) noexcept;
+    bool findPipeline(uint64_t key, GraphicsPipeline* pipeline) const noexcept;
+    bool waitPipeline(uint64_t key, GraphicsPipeline* pipeline) noexcept; // blocks until the requested pipeline is compiled or has failed
+    bool isPending(uint64_t key) const noexcept;
+
+//  Destroys a compiled or failed pipeline, the caller makes sure no command buffer in flight uses it
+    bool releasePipeline(uint64_t key) noexcept;
+
+    Statistics getStatistics() const noexcept;
+
+    static uint64_t hash(const PipelineState& state) noexcept;
+
+private:
+    enum class Status
+    {
+        Pending,
+        Ready,
+        Failed
+    };
+
+    struct Entry
+    {
+        GraphicsPipeline pipeline;
+        Status           status;
+    };
+
+    struct Request
+    {
+        uint64_t                         key;
+        PipelineState                    state;
+        std::vector<VkPushConstantRange> constantRanges; // state.constantRanges, GraphicsPipeline::create reads their stages
+        VkDescriptorSetLayout            setLayout;
+        VkPipelineLayout                 pipelineLayout;
+    };
+
+    bool resolveLayouts(const PipelineState& state, VkDescriptorSetLayout* setLayout, VkPipelineLayout* pipelineLayout) noexcept;
+    void build(Request& request) noexcept;
+    void workerLoop() noexcept;
+
+    std::unordered_map<uint64_t, VkDescriptorSetLayout> m_setLayouts;
+    std::unordered_map<uint64_t, VkPipelineLayout>      m_pipelineLayouts;
+    std::unordered_map<uint64_t, Entry>                 m_pipelines;
+
+    std::vector<std::thread> m_workers;
+    std::deque<Request>      m_requests;
+    bool                     m_stop;
+
+    uint32_t m_hitCount;
+    uint32_t m_missCount;
+
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_requested;
+    std::condition_variable m_built;
+};
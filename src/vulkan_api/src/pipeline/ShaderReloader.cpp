@@ -0,0 +1,516 @@
+#include <cstdio>
+#include <algorithm>
+#include <array>
+
+#include "spdlog/spdlog.h"
+
+#include "files/FileProvider.hpp"
+#include "context/Context.hpp"
+#include "pipeline/ShaderReloader.hpp"
+
+#if defined(SHADER_SOURCE_DIR) && defined(_WIN32)
+#define popen  _popen
+#define pclose _pclose
+#endif
+
+
+#ifdef SHADER_SOURCE_DIR
+static constexpr std::chrono::milliseconds source_poll_interval(200);
+#endif
+
+
+static std::string get_stage_names(std::span<const ShaderReloader::Stage> stages) noexcept
+{
+    std::string names;
+
+    for (const auto& stage : stages)
+        names += (names.empty() ? "" : ", ") + stage.path;
+
+    return names;
+}
+
+
+static void set_shader_stages(PipelineState& state, std::span<const std::unique_ptr<Shader>> modules) noexcept
+{
+    state.shaderInfo.clear();
+
+    for (const auto& shader : modules)
+        state.shaderInfo.push_back(shader->getInfo());
+}
+
+
+static double get_milliseconds(std::chrono::steady_clock::duration duration) noexcept
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+
+
+ShaderReloader::ShaderReloader() noexcept:
+    m_library(nullptr),
+    m_framesInFlight(1),
+    m_frame(0),
+    m_watching(false),
+    m_stop(false)
+{
+
+}
+
+
+ShaderReloader::~ShaderReloader()
+{
+    destroy();
+}
+
+
+bool ShaderReloader::create(PipelineLibrary* library, uint32_t framesInFlight) noexcept
+{
+    m_library        = library;
+    m_framesInFlight = framesInFlight;
+    m_stop           = false;
+
+//  the pack never changes
+    m_watching = !FileProvider::isPacked();
+
+    if (!m_watching)
+        return true;
+
+    try
+    {
+        m_worker = std::thread(&ShaderReloader::workerLoop, this);
+    }
+    catch (const std::system_error& error)
+    {
+        spdlog::error("Shader reload: failed to start the worker thread, {}", error.what());
+
+        return false;
+    }
+
+#ifdef SHADER_SOURCE_DIR
+    spdlog::info("Shader reload: watching res/shaders and the GLSL sources in {}", SHADER_SOURCE_DIR);
+#else
+    spdlog::info("Shader reload: watching res/shaders");
+#endif
+
+    return true;
+}
+
+
+void ShaderReloader::destroy() noexcept
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_requested.notify_all();
+
+    if (m_worker.joinable())
+        m_worker.join();
+
+//  a library worker may still be compiling with the new modules
+    GraphicsPipeline pipeline;
+
+    for (const auto& loaded : m_loaded)
+        if (loaded.key)
+            m_library->waitPipeline(loaded.key, &pipeline);
+
+    for (const auto& program : m_programs)
+        if (program.busy && program.pending.key)
+            m_library->waitPipeline(program.pending.key, &pipeline);
+
+    m_jobs.clear();
+    m_loaded.clear();
+    m_retired.clear();
+    m_programs.clear();
+    m_compiled.clear();
+    m_sourceTimes.clear();
+}
+
+
+bool ShaderReloader::add(std::span<const Stage> stages, const PipelineState& state, const PipelineInterface& interface, GraphicsPipeline* pipeline) noexcept
+{
+    Program program;
+    program.stages.assign(stages.begin(), stages.end());
+    program.target = pipeline;
+
+    Job job = { 0, program.stages, state, interface, {}, Clock::now() };
+    Loaded loaded = load(job);
+
+    if (!loaded.key)
+        return false;
+
+    if (!m_library->waitPipeline(loaded.key, pipeline))
+    {
+        m_library->releasePipeline(loaded.key);
+
+        return false;
+    }
+
+//  the copy of the state outlives the caller, the arrays it points to are owned by the program
+    program.interface = std::move(loaded.interface);
+    program.state     = job.state;
+    program.state.setupInterface(program.interface);
+
+    program.key        = loaded.key;
+    program.modules    = std::move(loaded.modules);
+    program.codeHashes = std::move(loaded.codeHashes);
+
+    m_programs.push_back(std::move(program));
+
+    return true;
+}
+
+
+void ShaderReloader::update(std::span<const std::string> changedFiles) noexcept
+{
+    if (!m_watching)
+        return;
+
+    m_frame++;
+
+    std::vector<Loaded> loaded;
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        const auto now = Clock::now();
+
+//      a .spv rewritten by glslc is timed from the save of its source
+        const auto changeTime = [this, now](const std::string& path)
+        {
+            auto node = m_sourceTimes.extract(path);
+
+            return node ? node.mapped() : now;
+        };
+
+        for (const auto& path : changedFiles)
+            markChanged(path, changeTime(path));
+
+        for (const auto& path : m_compiled)
+            markChanged(path, changeTime(path));
+
+        m_compiled.clear();
+        loaded.swap(m_loaded);
+    }
+
+    for (auto& result : loaded)
+    {
+        Program& program = m_programs[result.program];
+
+        if (result.key)
+            program.pending = std::move(result);
+        else
+            program.busy = false;
+    }
+
+    bool queued = false;
+
+    for (uint32_t i = 0; i < m_programs.size(); ++i)
+    {
+        Program& program = m_programs[i];
+
+        if (program.busy && program.pending.key)
+            swap(program);
+
+        if (!program.dirty || program.busy)
+            continue;
+
+        std::lock_guard lock(m_mutex);
+        m_jobs.push_back({ i, program.stages, program.state, program.interface, program.codeHashes, program.dirtyTime });
+
+        program.busy  = true;
+        program.dirty = false;
+        queued        = true;
+    }
+
+    if (queued)
+        m_requested.notify_one();
+
+//  the frames recorded before the swap have retired once the fence of every frame in flight was waited for again
+    std::erase_if(m_retired, [this](const Retired& retired)
+    {
+        if (retired.frame > m_frame)
+            return false;
+
+        m_library->releasePipeline(retired.key);
+
+        return true;
+    });
+}
+
+
+void ShaderReloader::markChanged(const std::string& path, Clock::time_point time) noexcept
+{
+    for (auto& program : m_programs)
+    {
+        if (std::none_of(program.stages.begin(), program.stages.end(), [&path](const Stage& stage) { return stage.path == path; }))
+            continue;
+
+        if (!program.dirty || time < program.dirtyTime)
+            program.dirtyTime = time;
+
+        program.dirty = true;
+    }
+}
+
+
+void ShaderReloader::swap(Program& program) noexcept
+{
+    Loaded& pending = program.pending;
+    GraphicsPipeline pipeline;
+
+    if (m_library->findPipeline(pending.key, &pipeline))
+    {
+        m_retired.push_back({ program.key, std::move(program.modules), m_frame + m_framesInFlight });
+
+        program.key        = pending.key;
+        program.modules    = std::move(pending.modules);
+        program.codeHashes = std::move(pending.codeHashes);
+        *program.target    = pipeline;
+
+        spdlog::info("Shader reload: {} swapped in {:.1f} ms after the change, {:.1f} ms of it loading the modules",
+                     get_stage_names(program.stages), get_milliseconds(Clock::now() - pending.changeTime), pending.loadTime);
+    }
+    else if (!m_library->isPending(pending.key))
+    {
+        spdlog::error("Shader reload: the pipeline of {} failed to compile, the previous one is kept", get_stage_names(program.stages));
+
+        m_library->releasePipeline(pending.key);
+        pending.modules.clear();
+    }
+    else
+    {
+        return;
+    }
+
+    pending      = {};
+    program.busy = false;
+}
+
+
+ShaderReloader::Loaded ShaderReloader::load(Job& job) const noexcept
+{
+    const auto start = Clock::now();
+
+    Loaded loaded;
+    loaded.program    = job.program;
+    loaded.changeTime = job.changeTime;
+
+    std::vector<FileData> files(job.stages.size());
+
+    for (size_t i = 0; i < job.stages.size(); ++i)
+    {
+        const auto path = FileProvider::findPathToFile(job.stages[i].path);
+
+        if (path.empty() || !FileProvider::readFile(path, &files[i]))
+        {
+            spdlog::error("Shader reload: failed to read {}", job.stages[i].path);
+
+            return loaded;
+        }
+
+        const auto& data = files[i].data;
+        loaded.codeHashes.push_back(pack_hash(std::string_view(reinterpret_cast<const char*>(data.data()), data.size())));
+    }
+
+//  an editor touching the file or a rebuild copying the same output
+    if (loaded.codeHashes == job.codeHashes)
+    {
+        loaded.unchanged = true;
+
+        return loaded;
+    }
+
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+    for (size_t i = 0; i < job.stages.size(); ++i)
+    {
+        auto& shader = loaded.modules.emplace_back(std::make_unique<Shader>(logicalDevice));
+
+        if (!shader->loadFromMemory(files[i].data, job.stages[i].stage))
+        {
+            spdlog::error("Shader reload: {} is not a valid SPIR-V module", job.stages[i].path);
+            loaded.modules.clear();
+
+            return loaded;
+        }
+    }
+
+//  the first load takes the layout and the vertex input from the modules, a reload has to keep them
+    loaded.interface = job.interface;
+    loaded.interface.clear();
+
+    for (const auto& shader : loaded.modules)
+    {
+        if (!loaded.interface.merge(shader->getReflection()))
+        {
+            spdlog::error("Shader reload: the stages of {} do not fit together", get_stage_names(job.stages));
+            loaded.modules.clear();
+
+            return loaded;
+        }
+    }
+
+    if (job.codeHashes.empty())
+    {
+        job.state.setupInterface(loaded.interface);
+    }
+    else if (!(loaded.interface == job.interface))
+    {
+        spdlog::error("Shader reload: {} changed its bindings, push constants or vertex inputs, restart to apply it", get_stage_names(job.stages));
+        loaded.modules.clear();
+
+        return loaded;
+    }
+
+    set_shader_stages(job.state, loaded.modules);
+
+//  new modules make a new key, the pipeline in use is left alone
+    loaded.key      = m_library->requestPipeline(job.state);
+    loaded.loadTime = get_milliseconds(Clock::now() - start);
+
+    if (!loaded.key)
+        loaded.modules.clear();
+
+    return loaded;
+}
+
+
+void ShaderReloader::workerLoop() noexcept
+{
+#ifdef SHADER_SOURCE_DIR
+    pollSources(); // the first pass records the write times
+#endif
+
+    for (;;)
+    {
+        Job job;
+
+        {
+            std::unique_lock lock(m_mutex);
+
+#ifdef SHADER_SOURCE_DIR
+            const bool requested = m_requested.wait_for(lock, source_poll_interval, [this] { return m_stop || !m_jobs.empty(); });
+#else
+            m_requested.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+            const bool requested = true;
+#endif
+
+            if (m_stop)
+                return;
+
+            if (requested)
+            {
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+            else
+            {
+                lock.unlock();
+#ifdef SHADER_SOURCE_DIR
+                pollSources();
+#endif
+                continue;
+            }
+        }
+
+        Loaded loaded = load(job);
+
+        if (loaded.unchanged)
+            spdlog::debug("Shader reload: {} unchanged", get_stage_names(job.stages));
+
+        std::lock_guard lock(m_mutex);
+        m_loaded.push_back(std::move(loaded));
+    }
+}
+
+
+#ifdef SHADER_SOURCE_DIR
+void ShaderReloader::pollSources() noexcept
+{
+    constexpr std::array<std::string_view, 6> extensions = { ".vert", ".frag", ".geom", ".tesc", ".tese", ".comp" };
+
+    std::error_code error;
+
+    for (const auto& entry : std::filesystem::directory_iterator(SHADER_SOURCE_DIR, error))
+    {
+        const auto extension = entry.path().extension().string();
+
+        if (std::find(extensions.begin(), extensions.end(), extension) == extensions.end())
+            continue;
+
+        const auto writeTime = entry.last_write_time(error);
+
+        if (error)
+            continue;
+
+        auto [it, inserted] = m_sourceWriteTimes.try_emplace(entry.path().string(), writeTime);
+
+        if (inserted || it->second == writeTime)
+            continue;
+
+        it->second = writeTime;
+        compileSource(entry.path(), Clock::now());
+    }
+}
+
+
+//  Same naming as src/cmake/compile_shaders.cmake, vertex_shader.vert -> shaders/vertex_shader.spv
+void ShaderReloader::compileSource(const std::filesystem::path& source, Clock::time_point changeTime) noexcept
+{
+    const std::string virtualPath = "shaders/" + source.stem().string() + ".spv";
+    const auto output = FileProvider::findPathToFile(virtualPath);
+
+    if (output.empty())
+    {
+        spdlog::warn("Shader reload: {} has no {} to replace, rebuild to add a new shader", source.filename().string(), virtualPath);
+
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_sourceTimes[virtualPath] = changeTime;
+    }
+
+    std::string command = "\"" GLSLC_EXECUTABLE "\" \"" + source.string() + "\" -o \"" + output.string() + "\" 2>&1";
+
+#ifdef _WIN32
+    command = "\"" + command + "\""; // cmd strips the outer quotes
+#endif
+
+    const auto start = Clock::now();
+    FILE* pipe = popen(command.c_str(), "r");
+
+    if (!pipe)
+    {
+        spdlog::error("Shader reload: failed to run glslc");
+
+        return;
+    }
+
+    std::string log;
+    std::array<char, 256> buffer;
+
+    while (fgets(buffer.data(), static_cast<int>(buffer.size()), pipe))
+        log += buffer.data();
+
+    const int status = pclose(pipe);
+
+    std::lock_guard lock(m_mutex);
+
+    if (status != 0)
+    {
+        spdlog::error("Shader reload: glslc failed on {}\n{}", source.filename().string(), log);
+        m_sourceTimes.erase(virtualPath);
+
+        return;
+    }
+
+    spdlog::info("Shader reload: {} compiled in {:.1f} ms", source.filename().string(), get_milliseconds(Clock::now() - start));
+
+//  platforms without a watch on res learn about the new .spv from here
+    m_compiled.push_back(virtualPath);
+}
+#endif
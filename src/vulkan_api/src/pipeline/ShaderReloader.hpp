@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "pipeline/PipelineLibrary.hpp"
+
+
+// Keeps pipelines in sync with their SPIR-V while the application runs.
+// A worker thread loads the .spv files reported by FileProvider::getChangedFiles(), the PipelineLibrary workers compile the affected
+// pipelines through the pipeline cache and update() swaps them in at the start of a frame. The replaced pipeline and its modules
+// are destroyed once the frames in flight which may still use them have retired, the device is never idled.
+// Debug builds also poll the GLSL sources (SHADER_SOURCE_DIR) and recompile an edited one with glslc into res/shaders.
+// Nothing is watched when the resources are served from res.pack.
+class ShaderReloader final
+{
+public:
+    struct Stage
+    {
+        std::string           path; // virtual path of the .spv inside the res folder
+        VkShaderStageFlagBits stage;
+    };
+
+    ShaderReloader() noexcept;
+    ~ShaderReloader();
+
+    bool create(PipelineLibrary* library, uint32_t framesInFlight) noexcept;
+    void destroy() noexcept; // before the library, the modules of pipelines still being compiled are waited for
+
+//  Compiles the pipeline on the calling thread, update() rewrites *pipeline when one of the stages changes.
+//  state describes everything but the shader stages and their interface, which is reflected from the modules with the options of interface.
+//  A reload changing the interface is rejected, the descriptor sets and vertex buffers were made for the first one.
+    bool add(std::span<const Stage> stages, const PipelineState& state, const PipelineInterface& interface, GraphicsPipeline* pipeline) noexcept;
+
+//  Called once per frame from the main thread once the fence of the frame was waited for
+    void update(std::span<const std::string> changedFiles) noexcept;
+
+private:
+    using Clock   = std::chrono::steady_clock;
+    using Modules = std::vector<std::unique_ptr<Shader>>;
+
+    struct Job
+    {
+        uint32_t              program;
+        std::vector<Stage>    stages;
+        PipelineState         state;      // points into the interface of the program
+        PipelineInterface     interface;  // a reload has to match it, the first load only takes its options
+        std::vector<uint64_t> codeHashes; // of the modules in use, a rewrite with the same code is not compiled again
+        Clock::time_point     changeTime;
+    };
+
+    struct Loaded
+    {
+        uint32_t              program;
+        uint64_t              key = 0; // 0 - failed or unchanged
+        bool                  unchanged = false;
+        Modules               modules;
+        PipelineInterface     interface;
+        std::vector<uint64_t> codeHashes;
+        Clock::time_point     changeTime;
+        double                loadTime = 0.0;
+    };
+
+    struct Program
+    {
+        std::vector<Stage> stages;
+        PipelineState      state;
+        PipelineInterface  interface; // state.layoutInfo and state.constantRanges point into it
+        GraphicsPipeline*  target;
+
+        uint64_t              key;
+        Modules               modules;
+        std::vector<uint64_t> codeHashes;
+
+        bool              busy  = false; // a job is queued or its pipeline is being compiled
+        bool              dirty = false; // changed again, reloaded once the current job is done
+        Clock::time_point dirtyTime;
+        Loaded            pending;
+    };
+
+    struct Retired
+    {
+        uint64_t key;
+        Modules  modules;
+        uint64_t frame; // released by the update() of this frame
+    };
+
+    void markChanged(const std::string& path, Clock::time_point time) noexcept;
+    void swap(Program& program) noexcept;
+    Loaded load(Job& job) const noexcept;
+    void workerLoop() noexcept;
+#ifdef SHADER_SOURCE_DIR
+    void pollSources() noexcept;
+    void compileSource(const std::filesystem::path& source, Clock::time_point changeTime) noexcept;
+#endif
+
+    PipelineLibrary*     m_library;
+    std::vector<Program> m_programs;
+    std::vector<Retired> m_retired;
+    uint32_t             m_framesInFlight;
+    uint64_t             m_frame;
+    bool                 m_watching;
+
+    std::thread             m_worker;
+    std::deque<Job>         m_jobs;
+    std::vector<Loaded>     m_loaded;
+    std::mutex              m_mutex;
+    std::condition_variable m_requested;
+    bool                    m_stop;
+
+//  written by the worker, guarded by m_mutex
+    std::vector<std::string>                             m_compiled;    // .spv rewritten by glslc
+    std::unordered_map<std::string, Clock::time_point>   m_sourceTimes; // .spv -> when its GLSL source was saved
+
+#ifdef SHADER_SOURCE_DIR
+    std::unordered_map<std::string, std::filesystem::file_time_type> m_sourceWriteTimes; // worker only
+#endif
+};
@@ -0,0 +1,128 @@
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
+#include "context/Context.hpp"
+#include "pipeline/descriptors/BindlessTextures.hpp"
+
+
+bool BindlessTextures::create(uint32_t slotCount) noexcept
+{
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+    capacity = std::min(slotCount, vkContext->getBindlessTextureLimit());
+
+    if (capacity == 0)
+    {
+        spdlog::error("Bindless textures: descriptor indexing is not enabled on the device");
+
+        return false;
+    }
+
+    {// Layout, the array is the last binding of the set so its size can vary per allocation
+        const VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                                      VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT |
+                                                      VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                                      VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT;
+
+        const VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = 
+        {
+            .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+            .pNext         = VK_NULL_HANDLE,
+            .bindingCount  = 1,
+            .pBindingFlags = &bindingFlags
+        };
+
+        const VkDescriptorSetLayoutBinding binding = 
+        {
+            .binding            = 0,
+            .descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount    = capacity,
+            .stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .pImmutableSamplers = VK_NULL_HANDLE
+        };
+
+        const VkDescriptorSetLayoutCreateInfo layoutInfo = 
+        {
+            .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .pNext        = &bindingFlagsInfo,
+            .flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+            .bindingCount = 1,
+            .pBindings    = &binding
+        };
+
+        if (vkCreateDescriptorSetLayout(logicalDevice, &layoutInfo, VK_NULL_HANDLE, &layout) != VK_SUCCESS)
+            return false;
+    }
+
+    {// Pool
+        const VkDescriptorPoolSize poolSize = 
+        {
+            .type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = capacity
+        };
+
+        const VkDescriptorPoolCreateInfo poolInfo = 
+        {
+            .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .pNext         = VK_NULL_HANDLE,
+            .flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+            .maxSets       = 1,
+            .poolSizeCount = 1,
+            .pPoolSizes    = &poolSize
+        };
+
+        if (vkCreateDescriptorPool(logicalDevice, &poolInfo, VK_NULL_HANDLE, &pool) != VK_SUCCESS)
+            return false;
+    }
+
+    {// Set
+        const VkDescriptorSetVariableDescriptorCountAllocateInfo countInfo = 
+        {
+            .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO,
+            .pNext              = VK_NULL_HANDLE,
+            .descriptorSetCount = 1,
+            .pDescriptorCounts  = &capacity
+        };
+
+        const VkDescriptorSetAllocateInfo allocateInfo = 
+        {
+            .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext              = &countInfo,
+            .descriptorPool     = pool,
+            .descriptorSetCount = 1,
+            .pSetLayouts        = &layout
+        };
+
+        if (vkAllocateDescriptorSets(logicalDevice, &allocateInfo, &set) != VK_SUCCESS)
+            return false;
+    }
+
+    spdlog::info("Bindless textures: {} slots", capacity);
+
+    return true;
+}
+
+
+void BindlessTextures::write(DescriptorWriter& writer, uint32_t slot, const VkDescriptorImageInfo& imageInfo) const noexcept
+{
+    writer.writeImage(set, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, imageInfo, slot);
+}
+
+
+void BindlessTextures::destroy() noexcept
+{
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+//  the set is freed with its pool
+    if (pool)
+        vkDestroyDescriptorPool(logicalDevice, pool, VK_NULL_HANDLE);
+
+    if (layout)
+        vkDestroyDescriptorSetLayout(logicalDevice, layout, VK_NULL_HANDLE);
+
+    pool     = VK_NULL_HANDLE;
+    layout   = VK_NULL_HANDLE;
+    set      = VK_NULL_HANDLE;
+    capacity = 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "pipeline/descriptors/DescriptorWriter.hpp"
+
+
+// Every texture in one runtime sized array of combined image samplers, bound once as set 1 and indexed by the material
+// of a draw. The array is partially bound and written after bind: a slot is filled when its texture is resident and is
+// never rewritten, the frames in flight keep reading the slots they already use.
+// Requires VulkanContext::getBindlessTextureLimit() to be non-zero.
+// Buffers have no array here, every draw shares the same ones: the instances come from one vertex buffer and the per draw
+// data from the uniform arena of set 0, selected with a dynamic offset which an update after bind layout does not allow.
+struct BindlessTextures
+{
+    static constexpr uint32_t placeholder_slot = 0;
+
+    bool create(uint32_t slotCount) noexcept; // the caller fills placeholder_slot before the first draw
+    void write(DescriptorWriter& writer, uint32_t slot, const VkDescriptorImageInfo& imageInfo) const noexcept; // queued until the writer is flushed
+    void destroy() noexcept;
+
+    VkDescriptorSetLayout layout   = VK_NULL_HANDLE;
+    VkDescriptorPool      pool     = VK_NULL_HANDLE;
+    VkDescriptorSet       set      = VK_NULL_HANDLE;
+    uint32_t              capacity = 0; // slots of the array, clamped to the limit of the device
+};
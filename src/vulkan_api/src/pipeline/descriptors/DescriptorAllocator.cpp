@@ -0,0 +1,278 @@
+#include <array>
+#include <algorithm>
+#include <type_traits>
+
+#include "spdlog/spdlog.h"
+#include <magic_enum/magic_enum.hpp>
+
+#include "context/Context.hpp"
+#include "pipeline/descriptors/DescriptorAllocator.hpp"
+
+
+// descriptors of each type reserved per set, a pool of N sets holds N times these
+static constexpr std::array<VkDescriptorPoolSize, 7> descriptors_per_set = 
+{
+    VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         2 },
+    VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 },
+    VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         2 },
+    VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1 },
+    VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4 },
+    VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,          2 },
+    VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          1 }
+};
+
+static constexpr uint32_t first_pool_sets = 64;
+static constexpr uint32_t max_pool_sets   = 4096;
+
+
+// FNV-1a over the layout and the written fields, the unused info of a write is zero
+static void hash_value(uint64_t& hash, const auto& data) noexcept
+{
+    static_assert(std::is_scalar_v<std::remove_cvref_t<decltype(data)>>);
+
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&data);
+
+    for (size_t i = 0; i < sizeof(data); ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+
+static uint64_t hash_set(VkDescriptorSetLayout layout, std::span<const DescriptorAllocator::Write> writes) noexcept
+{
+    uint64_t hash = 14695981039346656037ull;
+
+    hash_value(hash, layout);
+
+    for (const auto& write : writes)
+    {
+        hash_value(hash, write.binding);
+        hash_value(hash, write.type);
+        hash_value(hash, write.buffer.buffer);
+        hash_value(hash, write.buffer.offset);
+        hash_value(hash, write.buffer.range);
+        hash_value(hash, write.image.sampler);
+        hash_value(hash, write.image.imageView);
+        hash_value(hash, write.image.imageLayout);
+    }
+
+    return hash;
+}
+
+
+
+DescriptorAllocator::DescriptorAllocator() noexcept:
+    m_frame(0),
+    m_setsPerPool(first_pool_sets),
+    m_statistics()
+{
+
+}
+
+
+DescriptorAllocator::~DescriptorAllocator()
+{
+    destroy();
+}
+
+
+bool DescriptorAllocator::create(uint32_t framesInFlight) noexcept
+{
+    m_frames.resize(framesInFlight);
+    m_frame = 0;
+
+//  the cache is expected to be used every frame, its first pool is created up front
+    m_cachePools.pools.push_back(createPool());
+
+    return (m_cachePools.pools.back() != VK_NULL_HANDLE);
+}
+
+
+void DescriptorAllocator::destroy() noexcept
+{
+    if (m_statistics.poolCount == 0)
+        return;
+
+    const auto& stats = m_statistics;
+    const uint64_t requests = stats.cacheHits + stats.cacheMisses;
+
+    spdlog::info("Descriptor allocator: {} pools, {} sets allocated, {} cached sets, {:.1f}% cache hits",
+                 stats.poolCount, stats.allocatedSets, m_cache.size(), requests ? 100.0 * stats.cacheHits / requests : 0.0);
+
+    for (auto& chain : m_frames)
+        destroy(chain);
+
+    destroy(m_cachePools);
+
+    m_frames.clear();
+    m_cache.clear();
+
+    m_setsPerPool = first_pool_sets;
+    m_statistics  = {};
+}
+
+
+void DescriptorAllocator::beginFrame(uint32_t frame) noexcept
+{
+    m_frame = frame;
+    reset(m_frames[frame]);
+}
+
+
+VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout layout) noexcept
+{
+    return allocate(m_frames[m_frame], layout);
+}
+
+
+VkDescriptorSet DescriptorAllocator::getSet(VkDescriptorSetLayout layout, std::span<const Write> writes) noexcept
+{
+    const uint64_t key = hash_set(layout, writes);
+
+    if (auto it = m_cache.find(key); it != m_cache.end())
+    {
+        m_statistics.cacheHits++;
+
+        return it->second;
+    }
+
+    m_statistics.cacheMisses++;
+
+    const VkDescriptorSet set = allocate(m_cachePools, layout);
+
+    if (!set)
+        return VK_NULL_HANDLE;
+
+    for (const auto& write : writes)
+    {
+        if (write.image.imageView || write.image.sampler)
+            m_writer.writeImage(set, write.binding, write.type, write.image);
+        else
+            m_writer.writeBuffer(set, write.binding, write.type, write.buffer);
+    }
+
+    m_writer.flush();
+
+    m_cache.emplace(key, set);
+
+    return set;
+}
+
+
+void DescriptorAllocator::clearCache() noexcept
+{
+    reset(m_cachePools);
+    m_cache.clear();
+}
+
+
+DescriptorAllocator::Statistics DescriptorAllocator::getStatistics() const noexcept
+{
+    return m_statistics;
+}
+
+
+VkDescriptorSet DescriptorAllocator::allocate(Chain& chain, VkDescriptorSetLayout layout) noexcept
+{
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+//  a full pool is skipped until the chain is reset, a new one is appended at the end of the chain
+    for (;; chain.current++)
+    {
+        const bool fresh = (chain.current == chain.pools.size());
+
+        if (fresh)
+        {
+            const VkDescriptorPool pool = createPool();
+
+            if (!pool)
+                return VK_NULL_HANDLE;
+
+            chain.pools.push_back(pool);
+        }
+
+        const VkDescriptorSetAllocateInfo allocateInfo = 
+        {
+            .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext              = VK_NULL_HANDLE,
+            .descriptorPool     = chain.pools[chain.current],
+            .descriptorSetCount = 1,
+            .pSetLayouts        = &layout
+        };
+
+        VkDescriptorSet set;
+        const VkResult result = vkAllocateDescriptorSets(logicalDevice, &allocateInfo, &set);
+
+        if (result == VK_SUCCESS)
+        {
+            m_statistics.allocatedSets++;
+
+            return set;
+        }
+
+//      an empty pool which can not hold the set never will, the layout needs more than descriptors_per_set
+        if (fresh || (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL))
+        {
+            spdlog::error("Descriptor allocator: failed to allocate a set with the result: {}", magic_enum::enum_name(result));
+
+            return VK_NULL_HANDLE;
+        }
+    }
+}
+
+
+void DescriptorAllocator::reset(Chain& chain) noexcept
+{
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+//  the pools past the current one were never touched since the last reset
+    for (size_t i = 0; i < chain.pools.size() && i <= chain.current; ++i)
+        vkResetDescriptorPool(logicalDevice, chain.pools[i], 0);
+
+    chain.current = 0;
+}
+
+
+void DescriptorAllocator::destroy(Chain& chain) noexcept
+{
+    for (VkDescriptorPool pool : chain.pools)
+        vkDestroyDescriptorPool(vkContext->get<VkDevice>(), pool, VK_NULL_HANDLE);
+
+    chain.pools.clear();
+    chain.current = 0;
+}
+
+
+VkDescriptorPool DescriptorAllocator::createPool() noexcept
+{
+    std::array<VkDescriptorPoolSize, descriptors_per_set.size()> poolSizes = descriptors_per_set;
+
+    for (auto& poolSize : poolSizes)
+        poolSize.descriptorCount *= m_setsPerPool;
+
+    const VkDescriptorPoolCreateInfo poolInfo = 
+    {
+        .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext         = VK_NULL_HANDLE,
+        .flags         = 0,
+        .maxSets       = m_setsPerPool,
+        .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+        .pPoolSizes    = poolSizes.data()
+    };
+
+    VkDescriptorPool pool;
+
+    if (vkCreateDescriptorPool(vkContext->get<VkDevice>(), &poolInfo, VK_NULL_HANDLE, &pool) != VK_SUCCESS)
+    {
+        spdlog::error("Descriptor allocator: failed to create a pool of {} sets", m_setsPerPool);
+
+        return VK_NULL_HANDLE;
+    }
+
+    m_statistics.poolCount++;
+    m_setsPerPool = std::min(m_setsPerPool * 2, max_pool_sets);
+
+    return pool;
+}
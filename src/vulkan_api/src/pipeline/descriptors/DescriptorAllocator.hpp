@@ -0,0 +1,77 @@
+#pragma once
+
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "pipeline/descriptors/DescriptorWriter.hpp"
+
+
+// Descriptor sets from chains of pools which grow as they fill, nothing is freed one set at a time.
+// Transient sets come from the pools of the current frame, beginFrame() resets them wholesale once the frame is idle.
+// Cached sets are keyed by a hash of their layout and contents, asking twice for the same bindings returns the same
+// set without writing it again. A cached set is never updated, the frames in flight can share it.
+// Not thread safe, sets are allocated on the main thread before the recording starts.
+class DescriptorAllocator final
+{
+public:
+    struct Write
+    {
+        uint32_t               binding;
+        VkDescriptorType       type;
+        VkDescriptorBufferInfo buffer = {}; // buffer types
+        VkDescriptorImageInfo  image  = {}; // sampler and image types
+    };
+
+    struct Statistics
+    {
+        uint32_t poolCount;     // pools created, transient and cached
+        uint64_t allocatedSets; // vkAllocateDescriptorSets calls which succeeded
+        uint64_t cacheHits;
+        uint64_t cacheMisses;
+    };
+
+    DescriptorAllocator() noexcept;
+    ~DescriptorAllocator();
+
+    bool create(uint32_t framesInFlight) noexcept;
+    void destroy() noexcept;
+
+//  The fence of the frame has been waited for, its transient sets are released
+    void beginFrame(uint32_t frame) noexcept;
+
+//  Valid until beginFrame() comes around to the current frame again, the caller writes it
+    VkDescriptorSet allocate(VkDescriptorSetLayout layout) noexcept;
+
+//  A set holding the writes, allocated and written on the first request only.
+//  The resources of the writes have to outlive the cache, see clearCache()
+    VkDescriptorSet getSet(VkDescriptorSetLayout layout, std::span<const Write> writes) noexcept;
+
+//  Releases every cached set, the caller makes sure no command buffer in flight uses one
+    void clearCache() noexcept;
+
+    Statistics getStatistics() const noexcept;
+
+private:
+    struct Chain
+    {
+        std::vector<VkDescriptorPool> pools;
+        size_t                        current = 0; // pools before it are full
+    };
+
+    VkDescriptorSet allocate(Chain& chain, VkDescriptorSetLayout layout) noexcept;
+    void reset(Chain& chain) noexcept;
+    void destroy(Chain& chain) noexcept;
+    VkDescriptorPool createPool() noexcept;
+
+    std::vector<Chain> m_frames;
+    Chain              m_cachePools;
+    std::unordered_map<uint64_t, VkDescriptorSet> m_cache;
+    DescriptorWriter   m_writer; // the writes of a cache miss, kept for its capacity
+
+    uint32_t   m_frame;
+    uint32_t   m_setsPerPool; // grows with every pool created
+    Statistics m_statistics;
+};
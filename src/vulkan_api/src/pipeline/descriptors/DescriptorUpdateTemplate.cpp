@@ -0,0 +1,52 @@
+#include "spdlog/spdlog.h"
+#include <magic_enum/magic_enum.hpp>
+
+#include "context/Context.hpp"
+#include "pipeline/descriptors/DescriptorUpdateTemplate.hpp"
+
+
+bool DescriptorUpdateTemplate::create(VkDescriptorSetLayout layout, std::span<const VkDescriptorUpdateTemplateEntry> entries) noexcept
+{
+    const VkDescriptorUpdateTemplateCreateInfo templateInfo =
+    {
+        .sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO,
+        .pNext                      = VK_NULL_HANDLE,
+        .flags                      = 0,
+        .descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size()),
+        .pDescriptorUpdateEntries   = entries.data(),
+        .templateType               = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET,
+        .descriptorSetLayout        = layout,
+//      ignored by the descriptor set templates, only push descriptor templates name a pipeline layout
+        .pipelineBindPoint          = VK_PIPELINE_BIND_POINT_GRAPHICS,
+        .pipelineLayout             = VK_NULL_HANDLE,
+        .set                        = 0
+    };
+
+    const VkResult result = vkCreateDescriptorUpdateTemplate(vkContext->get<VkDevice>(), &templateInfo, VK_NULL_HANDLE, &handle);
+
+    if (result != VK_SUCCESS)
+    {
+        spdlog::error("Descriptor update template: failed to create with the result: {}", magic_enum::enum_name(result));
+
+        handle = VK_NULL_HANDLE;
+
+        return false;
+    }
+
+    return true;
+}
+
+
+void DescriptorUpdateTemplate::update(VkDescriptorSet set, const void* data) const noexcept
+{
+    vkUpdateDescriptorSetWithTemplate(vkContext->get<VkDevice>(), set, handle, data);
+}
+
+
+void DescriptorUpdateTemplate::destroy() noexcept
+{
+    if (handle)
+        vkDestroyDescriptorUpdateTemplate(vkContext->get<VkDevice>(), handle, VK_NULL_HANDLE);
+
+    handle = VK_NULL_HANDLE;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <span>
+
+#include <vulkan/vulkan.h>
+
+
+// Writes a whole set of a layout from one block of memory in a single driver call. Each entry gives the offset and the
+// stride of the VkDescriptorBufferInfo or VkDescriptorImageInfo of a binding in the block. The driver decodes the
+// layout once at creation instead of walking VkWriteDescriptorSet structures on every update, the layouts updated
+// every frame or for thousands of sets are worth a template.
+struct DescriptorUpdateTemplate
+{
+    bool create(VkDescriptorSetLayout layout, std::span<const VkDescriptorUpdateTemplateEntry> entries) noexcept;
+    void update(VkDescriptorSet set, const void* data) const noexcept;
+    void destroy() noexcept;
+
+    VkDescriptorUpdateTemplate handle = VK_NULL_HANDLE;
+};
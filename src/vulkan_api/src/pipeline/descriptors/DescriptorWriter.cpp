@@ -0,0 +1,100 @@
+#include "context/Context.hpp"
+#include "pipeline/descriptors/DescriptorWriter.hpp"
+
+
+void DescriptorWriter::writeBuffer(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, const VkDescriptorBufferInfo& bufferInfo, uint32_t arrayElement) noexcept
+{
+    m_bufferInfos.push_back(bufferInfo);
+    append(set, binding, type, arrayElement, { m_bufferInfos.size() - 1, false });
+}
+
+
+void DescriptorWriter::writeImage(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, const VkDescriptorImageInfo& imageInfo, uint32_t arrayElement) noexcept
+{
+    m_imageInfos.push_back(imageInfo);
+    append(set, binding, type, arrayElement, { m_imageInfos.size() - 1, true });
+}
+
+
+uint32_t DescriptorWriter::flush() noexcept
+{
+    if (m_writes.empty())
+        return 0;
+
+    for (size_t i = 0; i < m_writes.size(); ++i)
+    {
+        const Source& source = m_sources[i];
+
+        if (source.image)
+            m_writes[i].pImageInfo  = &m_imageInfos[source.firstInfo];
+        else
+            m_writes[i].pBufferInfo = &m_bufferInfos[source.firstInfo];
+    }
+
+    const auto count = static_cast<uint32_t>(m_writes.size());
+
+    vkUpdateDescriptorSets(vkContext->get<VkDevice>(), count, m_writes.data(), 0, VK_NULL_HANDLE);
+    clear();
+
+    return count;
+}
+
+
+void DescriptorWriter::reserve(size_t writes) noexcept
+{
+    m_writes.reserve(writes);
+    m_sources.reserve(writes);
+    m_bufferInfos.reserve(writes);
+    m_imageInfos.reserve(writes);
+}
+
+
+void DescriptorWriter::clear() noexcept
+{
+    m_writes.clear();
+    m_sources.clear();
+    m_bufferInfos.clear();
+    m_imageInfos.clear();
+}
+
+
+bool DescriptorWriter::empty() const noexcept
+{
+    return m_writes.empty();
+}
+
+
+void DescriptorWriter::append(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, uint32_t arrayElement, Source source) noexcept
+{
+//  the next element of the array of the previous write, its infos are already contiguous
+    if (!m_writes.empty())
+    {
+        VkWriteDescriptorSet& last = m_writes.back();
+        const Source& lastSource = m_sources.back();
+
+        if (last.dstSet == set && last.dstBinding == binding && last.descriptorType == type &&
+            last.dstArrayElement + last.descriptorCount == arrayElement &&
+            lastSource.image == source.image && lastSource.firstInfo + last.descriptorCount == source.firstInfo)
+        {
+            last.descriptorCount++;
+
+            return;
+        }
+    }
+
+    m_writes.push_back(
+    {
+        .sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext            = VK_NULL_HANDLE,
+        .dstSet           = set,
+        .dstBinding       = binding,
+        .dstArrayElement  = arrayElement,
+        .descriptorCount  = 1,
+        .descriptorType   = type,
+        .pImageInfo       = VK_NULL_HANDLE,
+        .pBufferInfo      = VK_NULL_HANDLE,
+        .pTexelBufferView = VK_NULL_HANDLE
+    });
+
+    m_sources.push_back(source);
+}
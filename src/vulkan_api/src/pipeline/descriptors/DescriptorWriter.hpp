@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+
+// Descriptor writes gathered and submitted with one vkUpdateDescriptorSets call. The infos are copied, the caller's
+// structures may go away before flush(). Consecutive elements of the same array are merged into a single write.
+// The capacity is kept between flushes, a writer reused every frame stops allocating after the first one.
+// Not thread safe.
+class DescriptorWriter final
+{
+public:
+    void writeBuffer(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, const VkDescriptorBufferInfo& bufferInfo, uint32_t arrayElement = 0) noexcept;
+    void writeImage(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, const VkDescriptorImageInfo& imageInfo, uint32_t arrayElement = 0) noexcept;
+
+//  Submits the pending writes and clears them, returns the number of VkWriteDescriptorSet submitted
+    uint32_t flush() noexcept;
+
+    void reserve(size_t writes) noexcept; // of either kind
+    void clear() noexcept;
+    bool empty() const noexcept;
+
+private:
+    struct Source
+    {
+        size_t firstInfo; // in m_imageInfos or m_bufferInfos
+        bool   image;
+    };
+
+    void append(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, uint32_t arrayElement, Source source) noexcept;
+
+    std::vector<VkWriteDescriptorSet>   m_writes;  // the info pointers are resolved in flush(), the arrays below reallocate
+    std::vector<Source>                 m_sources; // one per write
+    std::vector<VkDescriptorBufferInfo> m_bufferInfos;
+    std::vector<VkDescriptorImageInfo>  m_imageInfos;
+};
@@ -1,15 +1,11 @@
 #include <cstdio>
-#include <cstdlib>
-#include <cstring>
 
+#include "files/FileProvider.hpp"
 #include "pipeline/stages/shader/Shader.hpp"
 
 
-// Helper function to read a file into a buffer
-static size_t read_shader_file(const char* filename, char** buffer) noexcept;
-
 // Function to create a shader module from SPIR-V data
-static VkShaderModule create_shader_module(VkDevice device, const char* filename) noexcept;
+static VkShaderModule create_shader_module(VkDevice device, std::span<const uint8_t> code) noexcept;
 
 
 Shader::Shader(VkDevice device) noexcept:
@@ -30,18 +26,54 @@ Shader::~Shader()
 
 bool Shader::loadFromFile(const std::filesystem::path& filePath, VkShaderStageFlagBits stage) noexcept
 {
-    if (auto shaderModule = create_shader_module(m_device, filePath.string().c_str()))
+    FileData file;
+
+    if (!FileProvider::readFile(filePath, &file))
     {
-        m_module = shaderModule;
-        m_stage = stage;
+#ifdef DEBUG
+        fprintf(stderr, "Failed to open file: %s\n", filePath.string().c_str());
+#endif
+        return false;
+    }
 
+    if (loadFromMemory(file.data, stage))
         return true;
-    }
-        
+
+#ifdef DEBUG
+    fprintf(stderr, "Failed to create shader module from file: %s\n", filePath.string().c_str());
+#endif
     return false;
 }
 
 
+bool Shader::loadFromMemory(std::span<const uint8_t> code, VkShaderStageFlagBits stage) noexcept
+{
+    auto shaderModule = create_shader_module(m_device, code);
+
+    if (!shaderModule)
+        return false;
+
+//  the magic and the size were checked by create_shader_module
+    ShaderReflection reflection;
+
+    if (!reflection.reflect(std::span(reinterpret_cast<const uint32_t*>(code.data()), code.size() / sizeof(uint32_t))))
+    {
+        vkDestroyShaderModule(m_device, shaderModule, VK_NULL_HANDLE);
+
+        return false;
+    }
+
+    if (m_module)
+        vkDestroyShaderModule(m_device, m_module, VK_NULL_HANDLE);
+
+    m_module     = shaderModule;
+    m_stage      = stage;
+    m_reflection = std::move(reflection);
+
+    return true;
+}
+
+
 VkPipelineShaderStageCreateInfo Shader::getInfo() const noexcept
 {
     const VkPipelineShaderStageCreateInfo info =
@@ -59,58 +91,19 @@ VkPipelineShaderStageCreateInfo Shader::getInfo() const noexcept
 }
 
 
-
-size_t read_shader_file(const char* filename, char** buffer) noexcept
+const ShaderReflection& Shader::getReflection() const noexcept
 {
-    FILE* file = fopen(filename, "rb");
-
-    if (!file) 
-    {
-#ifdef DEBUG
-        fprintf(stderr, "Failed to open file: %s\n", filename);
-#endif
-        return 0;
-    }
-
-    fseek(file, 0, SEEK_END);
-    size_t fileSize = (size_t)ftell(file);
-    fseek(file, 0, SEEK_SET);
-
-    *buffer = (char*)malloc(fileSize);
-
-    if (!(*buffer)) 
-    {
-        fclose(file);
-#ifdef DEBUG
-        fprintf(stderr, "Failed to allocate memory for shader file: %s\n", filename);
-#endif
-        return 0;
-    }
-
-    size_t bytesRead = fread(*buffer, 1, fileSize, file);
-
-    if (bytesRead != fileSize) 
-    {
-        free(*buffer);
-        fclose(file);
-#ifdef DEBUG
-        fprintf(stderr, "Failed to read full file: %s\n", filename);
-#endif
-        return 0;
-    }
-
-    fclose(file);
-
-    return fileSize;
+    return m_reflection;
 }
 
 
-VkShaderModule create_shader_module(VkDevice device, const char* filename) noexcept
+
+VkShaderModule create_shader_module(VkDevice device, std::span<const uint8_t> code) noexcept
 {
-    char* code;
-    size_t codeSize = read_shader_file(filename, &code);
+    constexpr uint32_t spirv_magic = 0x07230203;
 
-    if (codeSize == 0)
+//  a file caught while it is being written is rejected here rather than by the driver
+    if (code.size() < sizeof(uint32_t) || code.size() % sizeof(uint32_t) != 0 || *reinterpret_cast<const uint32_t*>(code.data()) != spirv_magic)
         return VK_NULL_HANDLE;
 
     const VkShaderModuleCreateInfo createInfo = 
@@ -118,21 +111,14 @@ VkShaderModule create_shader_module(VkDevice device, const char* filename) noexc
         .sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
         .pNext    = VK_NULL_HANDLE,
         .flags    = 0,
-        .codeSize = codeSize,             // The pointer must be a uint32_t pointer and aligned correctly.
-        .pCode    = (const uint32_t*)code // Ensure your memory allocation is suitable for this (malloc usually is).
+        .codeSize = code.size(),
+        .pCode    = reinterpret_cast<const uint32_t*>(code.data()) // mappings are page aligned, pack entries 16 byte aligned
     };
 
     VkShaderModule shaderModule;
 
     if (vkCreateShaderModule(device, &createInfo, NULL, &shaderModule) != VK_SUCCESS) 
-    {
-#ifdef DEBUG
-        fprintf(stderr, "Failed to create shader module from file: %s\n", filename);
-#endif
         shaderModule = VK_NULL_HANDLE;
-    }
-
-    free(code);
 
     return shaderModule;
 }
\ No newline at end of file
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <filesystem>
+#include <span>
 
 #include <vulkan/vulkan.h>
 
+#include "pipeline/stages/shader/ShaderReflection.hpp"
+
 class Shader
 {
 public:
@@ -15,11 +18,14 @@ public:
     ~Shader();
 
     bool loadFromFile(const std::filesystem::path& filePath, VkShaderStageFlagBits stage) noexcept;
+    bool loadFromMemory(std::span<const uint8_t> code, VkShaderStageFlagBits stage) noexcept; // code is 4 byte aligned SPIR-V
 
     VkPipelineShaderStageCreateInfo getInfo() const noexcept;
+    const ShaderReflection& getReflection() const noexcept;
 
 private:
     VkDevice              m_device;
     VkShaderModule        m_module;
     VkShaderStageFlagBits m_stage;
+    ShaderReflection      m_reflection;
 };
\ No newline at end of file
@@ -0,0 +1,657 @@
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+
+#include "spdlog/spdlog.h"
+
+#include "pipeline/stages/shader/ShaderReflection.hpp"
+
+
+// The subset of the SPIR-V specification (unified 1.6) the reflection reads
+namespace spv
+{
+    constexpr uint32_t magic = 0x07230203;
+    constexpr size_t   header_size = 5; // magic, version, generator, bound, schema
+
+    enum Op : uint32_t
+    {
+        OpEntryPoint        = 15,
+        OpTypeInt           = 21,
+        OpTypeFloat         = 22,
+        OpTypeVector        = 23,
+        OpTypeMatrix        = 24,
+        OpTypeImage         = 25,
+        OpTypeSampler       = 26,
+        OpTypeSampledImage  = 27,
+        OpTypeArray         = 28,
+        OpTypeRuntimeArray  = 29,
+        OpTypeStruct        = 30,
+        OpTypePointer       = 32,
+        OpConstant          = 43,
+        OpSpecConstant      = 50,
+        OpVariable          = 59,
+        OpDecorate          = 71,
+        OpMemberDecorate    = 72
+    };
+
+    enum Decoration : uint32_t
+    {
+        Block         = 2,
+        BufferBlock   = 3,
+        ArrayStride   = 6,
+        MatrixStride  = 7,
+        BuiltIn       = 11,
+        Location      = 30,
+        Binding       = 33,
+        DescriptorSet = 34,
+        Offset        = 35
+    };
+
+    enum StorageClass : uint32_t
+    {
+        UniformConstant = 0,
+        Input           = 1,
+        Uniform         = 2,
+        PushConstant    = 9,
+        StorageBuffer   = 12
+    };
+
+    enum Dim : uint32_t
+    {
+        DimBuffer      = 5,
+        DimSubpassData = 6
+    };
+}
+
+
+namespace
+{
+    struct Definition
+    {
+        uint32_t                  opcode = 0;
+        std::span<const uint32_t> operands; // the result id included
+    };
+
+    struct Decorations
+    {
+        uint32_t set         = 0;
+        uint32_t binding     = UINT32_MAX;
+        uint32_t location    = UINT32_MAX;
+        uint32_t arrayStride = 0;
+        bool     builtIn     = false;
+        bool     block       = false;
+        bool     bufferBlock = false;
+    };
+
+    struct Member
+    {
+        uint32_t offset       = 0;
+        uint32_t matrixStride = 0;
+    };
+
+    struct Module
+    {
+        std::vector<Definition>                definitions;  // by id
+        std::vector<Decorations>               decorations;  // by id
+        std::unordered_map<uint64_t, Member>   members;      // struct id << 32 | member index
+        std::vector<uint32_t>                  variables;
+
+        const Definition& get(uint32_t id) const noexcept
+        {
+            static const Definition none;
+
+            return id < definitions.size() ? definitions[id] : none;
+        }
+
+        const Member* getMember(uint32_t structId, uint32_t index) const noexcept
+        {
+            auto it = members.find(static_cast<uint64_t>(structId) << 32 | index);
+
+            return it != members.end() ? &it->second : nullptr;
+        }
+    };
+}
+
+
+static constexpr uint32_t max_type_depth = 16; // nested structs and arrays, deeper ones are taken for a malformed module
+
+
+static VkShaderStageFlagBits execution_model_to_stage(uint32_t model) noexcept
+{
+    constexpr std::array<VkShaderStageFlagBits, 6> stages =
+    {
+        VK_SHADER_STAGE_VERTEX_BIT,
+        VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT,
+        VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT,
+        VK_SHADER_STAGE_GEOMETRY_BIT,
+        VK_SHADER_STAGE_FRAGMENT_BIT,
+        VK_SHADER_STAGE_COMPUTE_BIT
+    };
+
+    return model < stages.size() ? stages[model] : VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM;
+}
+
+
+static uint32_t get_constant(const Module& module, uint32_t id) noexcept
+{
+    const Definition& constant = module.get(id);
+
+//  a specialization constant sizes the array with its default
+    if ((constant.opcode != spv::OpConstant && constant.opcode != spv::OpSpecConstant) || constant.operands.size() < 3)
+        return 0;
+
+    return constant.operands[2];
+}
+
+
+//  Size of a type laid out by its Offset, ArrayStride and MatrixStride decorations, 0 when it has none
+static uint32_t get_type_size(const Module& module, uint32_t id, uint32_t matrixStride, uint32_t depth) noexcept
+{
+    const Definition& type = module.get(id);
+
+    if (depth > max_type_depth || type.operands.empty())
+        return 0;
+
+    const auto& operands = type.operands;
+
+    switch (type.opcode)
+    {
+        case spv::OpTypeInt:
+        case spv::OpTypeFloat:
+            return operands.size() > 1 ? operands[1] / 8 : 0;
+
+        case spv::OpTypeVector:
+            return operands.size() > 2 ? operands[2] * get_type_size(module, operands[1], 0, depth + 1) : 0;
+
+        case spv::OpTypeMatrix:
+            if (operands.size() < 3)
+                return 0;
+
+            return operands[2] * (matrixStride ? matrixStride : get_type_size(module, operands[1], 0, depth + 1));
+
+        case spv::OpTypeArray:
+        {
+            if (operands.size() < 3)
+                return 0;
+
+            const uint32_t stride = module.decorations[id].arrayStride;
+
+            return get_constant(module, operands[2]) * (stride ? stride : get_type_size(module, operands[1], matrixStride, depth + 1));
+        }
+
+        case spv::OpTypeStruct:
+        {
+            uint32_t size = 0;
+
+            for (uint32_t i = 1; i < operands.size(); ++i)
+            {
+                const Member* member = module.getMember(id, i - 1);
+                const uint32_t offset = member ? member->offset : 0;
+
+                size = std::max(size, offset + get_type_size(module, operands[i], member ? member->matrixStride : 0, depth + 1));
+            }
+
+            return size;
+        }
+
+        default:
+            return 0;
+    }
+}
+
+
+static bool get_descriptor_type(const Module& module, uint32_t storageClass, uint32_t typeId, VkDescriptorType* descriptorType) noexcept
+{
+    const Definition& type = module.get(typeId);
+
+    if (storageClass == spv::StorageBuffer)
+    {
+        *descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+        return true;
+    }
+
+    if (storageClass == spv::Uniform)
+    {
+        if (type.opcode != spv::OpTypeStruct)
+            return false;
+
+//      before SPIR-V 1.3 storage buffers were Uniform blocks decorated BufferBlock
+        *descriptorType = module.decorations[typeId].bufferBlock ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+
+        return true;
+    }
+
+    switch (type.opcode)
+    {
+        case spv::OpTypeSampledImage:
+            *descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            return true;
+
+        case spv::OpTypeSampler:
+            *descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+            return true;
+
+        case spv::OpTypeImage:
+        {
+            if (type.operands.size() < 7)
+                return false;
+
+            const uint32_t dim     = type.operands[2];
+            const bool     storage = (type.operands[6] == 2); // 1 - sampled, 2 - read and written
+
+            if (dim == spv::DimSubpassData)
+                *descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+            else if (dim == spv::DimBuffer)
+                *descriptorType = storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+            else
+                *descriptorType = storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+
+static bool get_attribute_type(const Module& module, uint32_t typeId, VertexInputState::AttributeType* attributeType) noexcept
+{
+    const Definition* type = &module.get(typeId);
+    uint32_t columns    = 1;
+    uint32_t components = 1;
+
+    if (type->opcode == spv::OpTypeMatrix && type->operands.size() > 2)
+    {
+        columns = type->operands[2];
+        type    = &module.get(type->operands[1]);
+    }
+
+    if (type->opcode == spv::OpTypeVector && type->operands.size() > 2)
+    {
+        components = type->operands[2];
+        type       = &module.get(type->operands[1]);
+    }
+
+    if ((type->opcode != spv::OpTypeFloat && type->opcode != spv::OpTypeInt) || type->operands.size() < 2 || type->operands[1] != 32)
+        return false;
+
+    if (columns == 4 && components == 4 && type->opcode == spv::OpTypeFloat)
+    {
+        *attributeType = VertexInputState::Float4x4;
+
+        return true;
+    }
+
+    if (columns != 1 || components > 4)
+        return false;
+
+    const uint32_t first = (type->opcode == spv::OpTypeFloat) ? VertexInputState::Float1 : VertexInputState::Int1;
+    *attributeType = static_cast<VertexInputState::AttributeType>(first + components - 1);
+
+    return true;
+}
+
+
+static bool parse_module(std::span<const uint32_t> code, Module* module, uint32_t* executionModel) noexcept
+{
+    if (code.size() < spv::header_size || code[0] != spv::magic)
+        return false;
+
+    const uint32_t bound = code[3];
+
+    if (bound == 0 || bound > code.size()) // every id is defined by an instruction of at least one word
+        return false;
+
+    module->definitions.resize(bound);
+    module->decorations.resize(bound);
+    *executionModel = UINT32_MAX;
+
+    for (size_t offset = spv::header_size; offset < code.size(); )
+    {
+        const uint32_t wordCount = code[offset] >> 16;
+        const uint32_t opcode    = code[offset] & 0xffff;
+
+        if (wordCount == 0 || offset + wordCount > code.size())
+            return false;
+
+        const auto operands = code.subspan(offset + 1, wordCount - 1);
+        offset += wordCount;
+
+        switch (opcode)
+        {
+            case spv::OpEntryPoint:
+                if (*executionModel == UINT32_MAX && !operands.empty())
+                    *executionModel = operands[0];
+                break;
+
+            case spv::OpTypeInt:
+            case spv::OpTypeFloat:
+            case spv::OpTypeVector:
+            case spv::OpTypeMatrix:
+            case spv::OpTypeImage:
+            case spv::OpTypeSampler:
+            case spv::OpTypeSampledImage:
+            case spv::OpTypeArray:
+            case spv::OpTypeRuntimeArray:
+            case spv::OpTypeStruct:
+            case spv::OpTypePointer:
+                if (operands.empty() || operands[0] >= bound)
+                    return false;
+
+                module->definitions[operands[0]] = { opcode, operands };
+                break;
+
+            case spv::OpConstant:
+            case spv::OpSpecConstant:
+            case spv::OpVariable:
+                if (operands.size() < 3 || operands[1] >= bound)
+                    return false;
+
+                module->definitions[operands[1]] = { opcode, operands };
+
+                if (opcode == spv::OpVariable)
+                    module->variables.push_back(operands[1]);
+                break;
+
+            case spv::OpDecorate:
+            {
+                if (operands.size() < 2 || operands[0] >= bound)
+                    return false;
+
+                Decorations& decorations = module->decorations[operands[0]];
+                const uint32_t literal = operands.size() > 2 ? operands[2] : 0;
+
+                switch (operands[1])
+                {
+                    case spv::Block:         decorations.block       = true;    break;
+                    case spv::BufferBlock:   decorations.bufferBlock = true;    break;
+                    case spv::ArrayStride:   decorations.arrayStride = literal; break;
+                    case spv::BuiltIn:       decorations.builtIn     = true;    break;
+                    case spv::Location:      decorations.location    = literal; break;
+                    case spv::Binding:       decorations.binding     = literal; break;
+                    case spv::DescriptorSet: decorations.set         = literal; break;
+                    default: break;
+                }
+                break;
+            }
+
+            case spv::OpMemberDecorate:
+            {
+                if (operands.size() < 4)
+                    break;
+
+                if (operands[2] != spv::Offset && operands[2] != spv::MatrixStride)
+                    break;
+
+                Member& member = module->members[static_cast<uint64_t>(operands[0]) << 32 | operands[1]];
+                (operands[2] == spv::Offset ? member.offset : member.matrixStride) = operands[3];
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    return *executionModel != UINT32_MAX;
+}
+
+
+
+bool ShaderReflection::reflect(std::span<const uint32_t> code) noexcept
+{
+    stage = VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM;
+    bindings.clear();
+    inputs.clear();
+    pushConstantOffset = 0;
+    pushConstantSize   = 0;
+
+    Module   module;
+    uint32_t executionModel;
+
+    if (!parse_module(code, &module, &executionModel))
+    {
+        spdlog::error("Shader reflection: malformed SPIR-V module");
+
+        return false;
+    }
+
+    stage = execution_model_to_stage(executionModel);
+
+    for (const uint32_t id : module.variables)
+    {
+        const Definition& variable = module.get(id);
+        const uint32_t storageClass = variable.operands[2];
+        const Definition& pointer = module.get(variable.operands[0]);
+
+        if (pointer.opcode != spv::OpTypePointer || pointer.operands.size() < 3)
+            continue;
+
+        uint32_t typeId = pointer.operands[2];
+
+        switch (storageClass)
+        {
+            case spv::UniformConstant:
+            case spv::Uniform:
+            case spv::StorageBuffer:
+            {
+                Binding binding = { module.decorations[id].set, module.decorations[id].binding, VK_DESCRIPTOR_TYPE_MAX_ENUM, 1 };
+
+                if (binding.binding == UINT32_MAX)
+                    continue;
+
+//              arrays of resources take one descriptor per element
+                for (uint32_t depth = 0; depth < max_type_depth; ++depth)
+                {
+                    const Definition& type = module.get(typeId);
+
+                    if (type.opcode == spv::OpTypeArray && type.operands.size() > 2)
+                        binding.count *= get_constant(module, type.operands[2]);
+                    else if (type.opcode == spv::OpTypeRuntimeArray && type.operands.size() > 1)
+                        binding.count = 0;
+                    else
+                        break;
+
+                    typeId = type.operands[1];
+                }
+
+                if (!get_descriptor_type(module, storageClass, typeId, &binding.type))
+                {
+                    spdlog::warn("Shader reflection: the resource at set {} binding {} has an unsupported type, it is left out", binding.set, binding.binding);
+
+                    continue;
+                }
+
+                bindings.push_back(binding);
+                break;
+            }
+
+            case spv::PushConstant:
+            {
+                const Definition& block = module.get(typeId);
+                uint32_t offset = UINT32_MAX;
+
+                for (uint32_t i = 1; i < block.operands.size(); ++i)
+                {
+                    const Member* member = module.getMember(typeId, i - 1);
+                    offset = std::min(offset, member ? member->offset : 0);
+                }
+
+                if (offset == UINT32_MAX)
+                    continue;
+
+//              a block starting past 0 leaves its leading bytes to the other stages
+                pushConstantOffset = offset;
+                pushConstantSize   = get_type_size(module, typeId, 0, 0) - offset;
+                break;
+            }
+
+            case spv::Input:
+            {
+                if (stage != VK_SHADER_STAGE_VERTEX_BIT || module.decorations[id].builtIn)
+                    continue;
+
+                Input input = { module.decorations[id].location, VertexInputState::Float1 };
+
+                if (input.location == UINT32_MAX || !get_attribute_type(module, typeId, &input.type))
+                {
+                    spdlog::error("Shader reflection: unsupported vertex input at location {}", input.location);
+
+                    return false;
+                }
+
+                inputs.push_back(input);
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    std::sort(bindings.begin(), bindings.end(), [](const Binding& a, const Binding& b) { return a.set != b.set ? a.set < b.set : a.binding < b.binding; });
+    std::sort(inputs.begin(), inputs.end(), [](const Input& a, const Input& b) { return a.location < b.location; });
+
+    return true;
+}
+
+
+
+bool PipelineInterface::merge(const ShaderReflection& stage) noexcept
+{
+    for (const auto& binding : stage.bindings)
+    {
+//      the shader only has to agree with the layout created by BindlessTextures
+        if (binding.set == 1 && bindlessTextures)
+        {
+            if (binding.binding != 0 || binding.type != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER || binding.count != 0)
+            {
+                spdlog::error("Shader reflection: set 1 binding {} is not the bindless texture array, a runtime sized sampler array at binding 0", binding.binding);
+
+                return false;
+            }
+
+            continue;
+        }
+
+        if (binding.set != 0)
+        {
+            spdlog::error("Shader reflection: set {} binding {} is not supported, pipelines have a single descriptor set", binding.set, binding.binding);
+
+            return false;
+        }
+
+        const VkDescriptorType type = (dynamicUniformBuffers && binding.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : binding.type;
+
+        auto it = std::lower_bound(bindings.begin(), bindings.end(), binding.binding,
+                                   [](const VkDescriptorSetLayoutBinding& layout, uint32_t index) { return layout.binding < index; });
+
+        if (it != bindings.end() && it->binding == binding.binding)
+        {
+            if (it->descriptorType != type || it->descriptorCount != binding.count)
+            {
+                spdlog::error("Shader reflection: the stages declare binding {} differently", binding.binding);
+
+                return false;
+            }
+
+            it->stageFlags |= stage.stage;
+
+            continue;
+        }
+
+        const VkDescriptorSetLayoutBinding layout =
+        {
+            .binding            = binding.binding,
+            .descriptorType     = type,
+            .descriptorCount    = binding.count,
+            .stageFlags         = static_cast<VkShaderStageFlags>(stage.stage),
+            .pImmutableSamplers = VK_NULL_HANDLE
+        };
+
+        bindings.insert(it, layout);
+    }
+
+//  one range for every stage, vkCmdPushConstants is then called with the stage flags of the range
+    if (stage.pushConstantSize)
+    {
+        if (constantRanges.empty())
+        {
+            constantRanges.push_back({ static_cast<VkShaderStageFlags>(stage.stage), stage.pushConstantOffset, stage.pushConstantSize });
+        }
+        else
+        {
+            VkPushConstantRange& range = constantRanges.front();
+            const uint32_t end = std::max(range.offset + range.size, stage.pushConstantOffset + stage.pushConstantSize);
+
+            range.stageFlags |= stage.stage;
+            range.offset      = std::min(range.offset, stage.pushConstantOffset);
+            range.size        = end - range.offset;
+        }
+    }
+
+    if (stage.stage != VK_SHADER_STAGE_VERTEX_BIT)
+        return true;
+
+//  VertexInputState assigns the locations in order, gaps and a matrix split between the two bindings can not be expressed
+    uint32_t location = 0;
+
+    for (const auto& input : stage.inputs)
+    {
+        const uint32_t end = location + ((input.type == VertexInputState::Float4x4) ? 4 : 1);
+
+        if (input.location != location)
+        {
+            spdlog::error("Shader reflection: the vertex inputs have to fill the locations from 0 without gaps, location {} is unexpected", input.location);
+
+            return false;
+        }
+
+        if (location < instanceLocation && end > instanceLocation)
+        {
+            spdlog::error("Shader reflection: the matrix at location {} is split by the first instance location {}", location, instanceLocation);
+
+            return false;
+        }
+
+        location = end;
+    }
+
+    inputs = stage.inputs;
+
+    return true;
+}
+
+
+void PipelineInterface::clear() noexcept
+{
+    bindings.clear();
+    constantRanges.clear();
+    inputs.clear();
+}
+
+
+bool PipelineInterface::operator == (const PipelineInterface& other) const noexcept
+{
+    const auto sameBinding = [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b)
+    {
+        return a.binding == b.binding && a.descriptorType == b.descriptorType && a.descriptorCount == b.descriptorCount && a.stageFlags == b.stageFlags;
+    };
+
+    const auto sameRange = [](const VkPushConstantRange& a, const VkPushConstantRange& b)
+    {
+        return a.stageFlags == b.stageFlags && a.offset == b.offset && a.size == b.size;
+    };
+
+    const auto sameInput = [](const ShaderReflection::Input& a, const ShaderReflection::Input& b)
+    {
+        return a.location == b.location && a.type == b.type;
+    };
+
+    return instanceLocation == other.instanceLocation && dynamicUniformBuffers == other.dynamicUniformBuffers &&
+           std::equal(bindings.begin(), bindings.end(), other.bindings.begin(), other.bindings.end(), sameBinding) &&
+           std::equal(constantRanges.begin(), constantRanges.end(), other.constantRanges.begin(), other.constantRanges.end(), sameRange) &&
+           std::equal(inputs.begin(), inputs.end(), other.inputs.begin(), other.inputs.end(), sameInput);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "pipeline/stages/shader/VertexInputState.hpp"
+
+
+// Interface of a SPIR-V module read from its types and decorations: the descriptor bindings, the push constant block
+// and the vertex inputs. Resources are reported whether the entry point uses them or not.
+struct ShaderReflection
+{
+    struct Binding
+    {
+        uint32_t         set;
+        uint32_t         binding;
+        VkDescriptorType type;  // uniform buffers are never reported dynamic, see PipelineInterface::dynamicUniformBuffers
+        uint32_t         count; // 0 - runtime sized array
+    };
+
+    struct Input
+    {
+        uint32_t                        location;
+        VertexInputState::AttributeType type;
+    };
+
+    bool reflect(std::span<const uint32_t> code) noexcept;
+
+    VkShaderStageFlagBits stage = VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM;
+    std::vector<Binding>  bindings;
+    uint32_t              pushConstantOffset = 0;
+    uint32_t              pushConstantSize   = 0; // 0 - no push constant block
+    std::vector<Input>    inputs;                 // vertex stage only, sorted by location
+};
+
+
+// The reflected stages of a pipeline merged into one descriptor set layout, one push constant range and the vertex input.
+// Set 1 is only accepted as the bindless texture array, its layout is not reflected.
+// A binding used by several stages is visible to all of them. PipelineState::setupInterface() points the state into
+// the arrays, like a DescriptorSetLayout the interface has to outlive the state.
+struct PipelineInterface
+{
+    uint32_t instanceLocation      = UINT32_MAX; // vertex inputs from this location on advance per instance
+    bool     dynamicUniformBuffers = false;      // uniform buffers are bound with a dynamic offset
+    bool     bindlessTextures      = false;      // set 1 is the array of BindlessTextures, see PipelineState::textureSetLayout
+
+    bool merge(const ShaderReflection& stage) noexcept;
+    void clear() noexcept; // keeps the options
+
+    bool operator == (const PipelineInterface& other) const noexcept;
+
+    std::vector<VkDescriptorSetLayoutBinding> bindings;       // set 0, sorted by binding
+    std::vector<VkPushConstantRange>          constantRanges; // at most one, covering the blocks of every stage
+    std::vector<ShaderReflection::Input>      inputs;
+};
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <cstring>
+
+#include "pipeline/stages/shader/SpecializationConstants.hpp"
+
+
+static void set_constant(SpecializationConstants& constants, uint32_t id, uint32_t bits) noexcept;
+
+
+
+void SpecializationConstants::set(uint32_t id, bool value) noexcept
+{
+    set_constant(*this, id, value ? VK_TRUE : VK_FALSE);
+}
+
+
+void SpecializationConstants::set(uint32_t id, int32_t value) noexcept
+{
+    set_constant(*this, id, static_cast<uint32_t>(value));
+}
+
+
+void SpecializationConstants::set(uint32_t id, uint32_t value) noexcept
+{
+    set_constant(*this, id, value);
+}
+
+
+void SpecializationConstants::set(uint32_t id, float value) noexcept
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    set_constant(*this, id, bits);
+}
+
+
+bool SpecializationConstants::empty() const noexcept
+{
+    return entries.empty();
+}
+
+
+VkSpecializationInfo SpecializationConstants::getInfo() const noexcept
+{
+    const VkSpecializationInfo info =
+    {
+        .mapEntryCount = static_cast<uint32_t>(entries.size()),
+        .pMapEntries   = entries.data(),
+        .dataSize      = data.size() * sizeof(uint32_t),
+        .pData         = data.data()
+    };
+
+    return info;
+}
+
+
+
+void set_constant(SpecializationConstants& constants, uint32_t id, uint32_t bits) noexcept
+{
+    auto& entries = constants.entries;
+    auto it = std::lower_bound(entries.begin(), entries.end(), id, [](const VkSpecializationMapEntry& entry, uint32_t value) { return entry.constantID < value; });
+
+    if (it != entries.end() && it->constantID == id)
+    {
+        constants.data[it->offset / sizeof(uint32_t)] = bits;
+
+        return;
+    }
+
+//  the data keeps the order of the calls, the entries the order of the ids
+    const VkSpecializationMapEntry entry =
+    {
+        .constantID = id,
+        .offset     = static_cast<uint32_t>(constants.data.size() * sizeof(uint32_t)),
+        .size       = sizeof(uint32_t)
+    };
+
+    entries.insert(it, entry);
+    constants.data.push_back(bits);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// Values of the constant_id constants of the shaders, resolved when the pipeline is created.
+// Every constant is stored in 4 bytes, bool is passed as VkBool32. Setting an id again replaces its value.
+struct SpecializationConstants
+{
+    void set(uint32_t id, bool value)     noexcept;
+    void set(uint32_t id, int32_t value)  noexcept;
+    void set(uint32_t id, uint32_t value) noexcept;
+    void set(uint32_t id, float value)    noexcept;
+
+    bool empty() const noexcept;
+    VkSpecializationInfo getInfo() const noexcept; // points into entries and data
+
+    std::vector<VkSpecializationMapEntry> entries; // sorted by id
+    std::vector<uint32_t>                 data;
+};
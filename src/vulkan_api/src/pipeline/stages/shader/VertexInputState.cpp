@@ -7,25 +7,53 @@ static VkFormat shader_attribute_type_to_vk_format(const VertexInputState::Attri
 
 
 
-void VertexInputState::create(std::span<const VertexInputState::AttributeType> attributes) noexcept
+void VertexInputState::create(std::span<const VertexInputState::AttributeType> attributes, 
+                              std::span<const VertexInputState::AttributeType> instanceAttributes) noexcept
 {
-    attributeDescriptions.resize(attributes.size());
-    VkVertexInputAttributeDescription* descriptions = attributeDescriptions.data();
-    uint32_t offset = 0;
+    attributeDescriptions.clear();
+    bindingDescriptions.clear();
 
-    for (uint32_t i = 0; i < attributes.size(); ++i)
+    uint32_t location = 0;
+
+    const auto addBinding = [this, &location](std::span<const VertexInputState::AttributeType> types, uint32_t binding, VkVertexInputRate inputRate)
     {
-        descriptions[i].location = i;
-        descriptions[i].binding  = 0;
-        descriptions[i].format   = shader_attribute_type_to_vk_format(attributes[i]);
-        descriptions[i].offset   = offset;
+        uint32_t offset = 0;
+
+        for (const auto type : types)
+        {
+//          a matrix is passed as its columns
+            const uint32_t columns = (type == VertexInputState::Float4x4) ? 4 : 1;
+            const uint32_t columnSize = static_cast<uint32_t>(shader_attribute_type_sizeof(type) / columns);
+
+            for (uint32_t column = 0; column < columns; ++column)
+            {
+                const VkVertexInputAttributeDescription description = 
+                {
+                    .location = location++,
+                    .binding  = binding,
+                    .format   = shader_attribute_type_to_vk_format(type),
+                    .offset   = offset
+                };
+
+                attributeDescriptions.push_back(description);
+                offset += columnSize;
+            }
+        }
+
+        const VkVertexInputBindingDescription bindingDescription = 
+        {
+            .binding   = binding,
+            .stride    = offset,
+            .inputRate = inputRate
+        };
+
+        bindingDescriptions.push_back(bindingDescription);
+    };
 
-        offset += shader_attribute_type_sizeof(attributes[i]);
-    }
+    addBinding(attributes, 0, VK_VERTEX_INPUT_RATE_VERTEX);
 
-    bindingDescription.binding   = 0;
-    bindingDescription.stride    = offset;
-    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    if (!instanceAttributes.empty())
+        addBinding(instanceAttributes, 1, VK_VERTEX_INPUT_RATE_INSTANCE);
 }
 
 
@@ -36,8 +64,8 @@ VkPipelineVertexInputStateCreateInfo VertexInputState::getInfo() const noexcept
         .sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
         .pNext                           = VK_NULL_HANDLE,
         .flags                           = 0,
-        .vertexBindingDescriptionCount   = 1,
-        .pVertexBindingDescriptions      = &bindingDescription,
+        .vertexBindingDescriptionCount   = static_cast<uint32_t>(bindingDescriptions.size()),
+        .pVertexBindingDescriptions      = bindingDescriptions.data(),
         .vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size()),
         .pVertexAttributeDescriptions    = attributeDescriptions.data()
     };
@@ -66,6 +94,9 @@ uint32_t shader_attribute_type_to_component_count(const VertexInputState::Attrib
         case VertexInputState::Float4:
         case VertexInputState::Int4:
             return 4;
+
+        case VertexInputState::Float4x4:
+            return 16;
     }
 
     return 0;
@@ -80,6 +111,7 @@ size_t shader_attribute_type_sizeof(const VertexInputState::AttributeType type)
         case VertexInputState::Float2:
         case VertexInputState::Float3:
         case VertexInputState::Float4:
+        case VertexInputState::Float4x4:
             return sizeof(float) * shader_attribute_type_to_component_count(type);
 
         case VertexInputState::Int1:
@@ -102,6 +134,8 @@ VkFormat shader_attribute_type_to_vk_format(const VertexInputState::AttributeTyp
         case VertexInputState::Float3: return VK_FORMAT_R32G32B32_SFLOAT;
         case VertexInputState::Float4: return VK_FORMAT_R32G32B32A32_SFLOAT;
 
+        case VertexInputState::Float4x4: return VK_FORMAT_R32G32B32A32_SFLOAT; // format of a single column
+
         case VertexInputState::Int1: return VK_FORMAT_R32_SINT;
         case VertexInputState::Int2: return VK_FORMAT_R32G32_SINT;
         case VertexInputState::Int3: return VK_FORMAT_R32G32B32_SINT;
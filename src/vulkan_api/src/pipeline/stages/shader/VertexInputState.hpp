@@ -16,12 +16,16 @@ struct VertexInputState
         Int1,
         Int2,
         Int3,
-        Int4
+        Int4,
+        Float4x4 // occupies four consecutive locations, one per column
     };
 
-    void create(std::span<const VertexInputState::AttributeType> attributes) noexcept;
+//  Binding 0 is advanced per vertex, binding 1 (if there are instance attributes) per instance.
+//  Locations are assigned in order, the instance attributes follow the vertex attributes.
+    void create(std::span<const VertexInputState::AttributeType> attributes, 
+                std::span<const VertexInputState::AttributeType> instanceAttributes = {}) noexcept;
     VkPipelineVertexInputStateCreateInfo getInfo() const noexcept;
 
     std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
-    VkVertexInputBindingDescription bindingDescription;
+    std::vector<VkVertexInputBindingDescription>   bindingDescriptions;
 };
\ No newline at end of file
@@ -1,12 +1,37 @@
 #include "pipeline/state/PipelineState.hpp"
 
 
-void PipelineState::setupShaderStages(std::span<const Shader> shaders, std::span<const VertexInputState::AttributeType> attributes) noexcept
+void PipelineState::setupShaderStages(std::span<const Shader> shaders, 
+                                      std::span<const VertexInputState::AttributeType> attributes, 
+                                      std::span<const VertexInputState::AttributeType> instanceAttributes) noexcept
 {
     for(const auto& shader : shaders)
         shaderInfo.emplace_back(shader.getInfo());
 
-    vertexInputState.create(attributes);
+    vertexInputState.create(attributes, instanceAttributes);
+}
+
+
+void PipelineState::setupInterface(const PipelineInterface& interface) noexcept
+{
+    std::vector<VertexInputState::AttributeType> attributes;
+    std::vector<VertexInputState::AttributeType> instanceAttributes;
+
+    for (const auto& input : interface.inputs)
+        (input.location < interface.instanceLocation ? attributes : instanceAttributes).push_back(input.type);
+
+    vertexInputState.create(attributes, instanceAttributes);
+
+    layoutInfo =
+    {
+        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext        = VK_NULL_HANDLE,
+        .flags        = 0,
+        .bindingCount = static_cast<uint32_t>(interface.bindings.size()),
+        .pBindings    = interface.bindings.data()
+    };
+
+    constantRanges = interface.constantRanges;
 }
 
 
@@ -74,4 +99,11 @@ void PipelineState::setupColorBlending(VkBool32 enabled) noexcept
     colorBlending.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
     colorBlending.alphaBlendOp        = VK_BLEND_OP_ADD;
     colorBlending.colorWriteMask      = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+}
+
+
+void PipelineState::setupAttachmentFormats(VkFormat color, VkFormat depth) noexcept
+{
+    colorFormat = color;
+    depthFormat = depth;
 }
\ No newline at end of file
@@ -4,18 +4,25 @@
 #include <span>
 
 #include "pipeline/stages/shader/Shader.hpp"
+#include "pipeline/stages/shader/ShaderReflection.hpp"
+#include "pipeline/stages/shader/SpecializationConstants.hpp"
 #include "pipeline/stages/shader/VertexInputState.hpp"
 
 struct PipelineState
 {
-    void setupShaderStages(std::span<const Shader> shaders, std::span<const VertexInputState::AttributeType> attributes) noexcept;
+    void setupShaderStages(std::span<const Shader> shaders, 
+                           std::span<const VertexInputState::AttributeType> attributes, 
+                           std::span<const VertexInputState::AttributeType> instanceAttributes = {})                     noexcept;
+    void setupInterface(const PipelineInterface& interface)                                                              noexcept; // layout and vertex input reflected from the shaders
     void setupInputAssembler(const VkPrimitiveTopology primitive)                                                        noexcept;
     void setupViewport()                                                                                                 noexcept;
     void setupRasterization(VkPolygonMode mode)                                                                          noexcept;
     void setupMultisampling()                                                                                            noexcept;
     void setupColorBlending(VkBool32 enabled)                                                                            noexcept;
+    void setupAttachmentFormats(VkFormat color, VkFormat depth)                                                          noexcept;
 
     std::vector<VkPipelineShaderStageCreateInfo> shaderInfo;
+    SpecializationConstants                      specialization; // passed to every stage, an id a stage does not declare is ignored
     VertexInputState                             vertexInputState;
     VkPipelineInputAssemblyStateCreateInfo       inputAssembly;
     VkPipelineViewportStateCreateInfo            viewportState;
@@ -24,4 +31,7 @@ struct PipelineState
     VkPipelineColorBlendAttachmentState          colorBlending;
     VkDescriptorSetLayoutCreateInfo              layoutInfo;
     std::span<const VkPushConstantRange>         constantRanges;
+    VkDescriptorSetLayout                        textureSetLayout = VK_NULL_HANDLE; // set 1, BindlessTextures::layout, VK_NULL_HANDLE - no set 1
+    VkFormat                                     colorFormat = VK_FORMAT_UNDEFINED;
+    VkFormat                                     depthFormat = VK_FORMAT_UNDEFINED;
 };
\ No newline at end of file
@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string>
+
+#include "spdlog/spdlog.h"
+#include <magic_enum/magic_enum.hpp>
+
+#include "context/Context.hpp"
+#include "render/GpuProfiler.hpp"
+
+
+static constexpr VkQueryPipelineStatisticFlags statistics_flags = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+                                                                  VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                                                                  VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+
+GpuProfiler::GpuProfiler() noexcept:
+    m_timestamps(VK_NULL_HANDLE),
+    m_statistics(VK_NULL_HANDLE),
+    m_period(0.f),
+    m_tickMask(0),
+    m_frame(0),
+    m_depth(0),
+    m_frameNumber(0),
+    m_pipelineStatistics{},
+    m_reportFrames(0)
+{
+
+}
+
+
+GpuProfiler::~GpuProfiler()
+{
+    destroy();
+}
+
+
+bool GpuProfiler::create(uint32_t framesInFlight, bool pipelineStatistics) noexcept
+{
+    m_period = vkContext->getTimestampPeriod();
+
+    if (m_period == 0.f)
+    {
+        spdlog::warn("GPU profiler: the main queue has no timestamps, nothing is measured");
+
+        return true;
+    }
+
+    const uint32_t validBits = vkContext->getTimestampValidBits();
+    m_tickMask = validBits < 64 ? (uint64_t(1) << validBits) - 1 : UINT64_MAX;
+
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+    const VkQueryPoolCreateInfo timestampsInfo =
+    {
+        .sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .pNext              = VK_NULL_HANDLE,
+        .flags              = 0,
+        .queryType          = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount         = 2 * max_scopes * framesInFlight,
+        .pipelineStatistics = 0
+    };
+
+    VkResult result = vkCreateQueryPool(logicalDevice, &timestampsInfo, VK_NULL_HANDLE, &m_timestamps);
+
+    if (result != VK_SUCCESS)
+    {
+        spdlog::error("GPU profiler: failed to create the timestamp queries with the result: {}", magic_enum::enum_name(result));
+
+        m_timestamps = VK_NULL_HANDLE;
+
+        return false;
+    }
+
+    if (pipelineStatistics && !vkContext->isPipelineStatisticsSupported())
+        spdlog::warn("GPU profiler: the device has no pipeline statistics queries");
+
+    if (pipelineStatistics && vkContext->isPipelineStatisticsSupported())
+    {
+        const VkQueryPoolCreateInfo statisticsInfo =
+        {
+            .sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .pNext              = VK_NULL_HANDLE,
+            .flags              = 0,
+            .queryType          = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+            .queryCount         = framesInFlight,
+            .pipelineStatistics = statistics_flags
+        };
+
+        result = vkCreateQueryPool(logicalDevice, &statisticsInfo, VK_NULL_HANDLE, &m_statistics);
+
+        if (result != VK_SUCCESS)
+        {
+            spdlog::error("GPU profiler: failed to create the pipeline statistics queries with the result: {}", magic_enum::enum_name(result));
+
+            m_statistics = VK_NULL_HANDLE;
+
+            return false;
+        }
+    }
+
+    m_frames.assign(framesInFlight, {});
+
+    for (auto& frame : m_frames)
+        frame.scopes.reserve(max_scopes);
+
+    m_ticks.resize(2 * max_scopes);
+    m_timings.reserve(max_scopes);
+
+    spdlog::info("GPU profiler: {} scopes per frame, pipeline statistics {}", max_scopes, m_statistics ? "enabled" : "disabled");
+
+    return true;
+}
+
+
+void GpuProfiler::destroy() noexcept
+{
+    if (m_timestamps)
+        vkDestroyQueryPool(vkContext->get<VkDevice>(), m_timestamps, VK_NULL_HANDLE);
+
+    if (m_statistics)
+        vkDestroyQueryPool(vkContext->get<VkDevice>(), m_statistics, VK_NULL_HANDLE);
+
+    m_timestamps = VK_NULL_HANDLE;
+    m_statistics = VK_NULL_HANDLE;
+
+    m_frames.clear();
+    m_timings.clear();
+    m_averages.clear();
+    m_log.close();
+}
+
+
+bool GpuProfiler::setLog(const std::filesystem::path& path) noexcept
+{
+    m_log.close();
+
+    if (path.empty())
+        return true;
+
+    m_log.open(path, std::ios::out | std::ios::trunc);
+
+    if (!m_log)
+    {
+        spdlog::error("GPU profiler: failed to open the log {}", path.string());
+
+        return false;
+    }
+
+    m_log << "frame,scope,depth,time_ms,input_primitives,vertex_invocations,fragment_invocations\n";
+
+    return true;
+}
+
+
+void GpuProfiler::beginFrame(VkCommandBuffer cmd, uint32_t frame) noexcept
+{
+    if (!m_timestamps)
+        return;
+
+    m_frame = frame;
+    m_depth = 0;
+
+    Frame& current = m_frames[frame];
+
+//  a frame whose results are not available yet reports nothing rather than the frame resolved before it again
+    m_timings.clear();
+    m_pipelineStatistics = {};
+
+//  the fence of the frame has signaled, the results of its previous submission are available
+    if (!current.scopes.empty())
+        resolve(current, 2 * max_scopes * frame, frame);
+
+    vkCmdResetQueryPool(cmd, m_timestamps, 2 * max_scopes * frame, 2 * max_scopes);
+
+    if (m_statistics)
+        vkCmdResetQueryPool(cmd, m_statistics, frame, 1);
+
+    current.scopes.clear();
+    current.statisticsScope = invalid_scope;
+    current.number = m_frameNumber++;
+}
+
+
+uint32_t GpuProfiler::beginScope(VkCommandBuffer cmd, const char* name, bool pipelineStatistics) noexcept
+{
+    if (!m_timestamps)
+        return invalid_scope;
+
+    Frame& current = m_frames[m_frame];
+
+    if (current.scopes.size() == max_scopes)
+        return invalid_scope;
+
+    const auto scope = static_cast<uint32_t>(current.scopes.size());
+
+    current.scopes.push_back({ name, m_depth++ });
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestamps, 2 * (max_scopes * m_frame + scope));
+
+//  a single statistics query can be active at a time, the scopes nested in it or after it are timed only
+    if (pipelineStatistics && m_statistics && current.statisticsScope == invalid_scope)
+    {
+        current.statisticsScope = scope;
+        vkCmdBeginQuery(cmd, m_statistics, m_frame, 0);
+    }
+
+    return scope;
+}
+
+
+void GpuProfiler::endScope(VkCommandBuffer cmd, uint32_t scope) noexcept
+{
+    if (scope == invalid_scope)
+        return;
+
+    --m_depth;
+
+    if (scope == m_frames[m_frame].statisticsScope)
+        vkCmdEndQuery(cmd, m_statistics, m_frame);
+
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestamps, 2 * (max_scopes * m_frame + scope) + 1);
+}
+
+
+std::span<const GpuScopeTiming> GpuProfiler::getTimings() const noexcept
+{
+    return m_timings;
+}
+
+
+const GpuPipelineStatistics& GpuProfiler::getPipelineStatistics() const noexcept
+{
+    return m_pipelineStatistics;
+}
+
+
+double GpuProfiler::getFrameTime() const noexcept
+{
+    double time = 0.0;
+
+    for (const auto& timing : m_timings)
+    {
+        if (timing.depth == 0)
+            time += timing.time;
+    }
+
+    return time;
+}
+
+
+VkQueryPipelineStatisticFlags GpuProfiler::getStatisticsFlags() const noexcept
+{
+    return m_statistics ? statistics_flags : 0;
+}
+
+
+void GpuProfiler::resolve(Frame& frame, uint32_t firstQuery, uint32_t statisticsQuery) noexcept
+{
+    const auto logicalDevice = vkContext->get<VkDevice>();
+    const auto queryCount    = static_cast<uint32_t>(2 * frame.scopes.size());
+
+//  no WAIT_BIT, a scope left open is never written and the whole frame is skipped instead of blocking
+    VkResult result = vkGetQueryPoolResults(logicalDevice, m_timestamps, firstQuery, queryCount, queryCount * sizeof(uint64_t),
+                                            m_ticks.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+    if (result != VK_SUCCESS)
+        return;
+
+    for (size_t i = 0; i < frame.scopes.size(); ++i)
+    {
+//      the difference is taken modulo the valid bits, a counter which wrapped inside the scope stays correct
+        const double time = double((m_ticks[2 * i + 1] - m_ticks[2 * i]) & m_tickMask) * m_period * 1e-6;
+
+        m_timings.push_back({ frame.scopes[i].name, frame.scopes[i].depth, time });
+    }
+
+    if (frame.statisticsScope != invalid_scope)
+    {
+//      one value per bit of statistics_flags, in the order of the bits
+        std::array<uint64_t, 3> counters;
+
+        result = vkGetQueryPoolResults(logicalDevice, m_statistics, statisticsQuery, 1, sizeof(counters), counters.data(), sizeof(counters), VK_QUERY_RESULT_64_BIT);
+
+        if (result == VK_SUCCESS)
+            m_pipelineStatistics = { counters[0], counters[1], counters[2] };
+    }
+
+    if (m_log.is_open())
+    {
+        for (size_t i = 0; i < m_timings.size(); ++i)
+        {
+            m_log << frame.number << ',' << m_timings[i].name << ',' << m_timings[i].depth << ',' << m_timings[i].time;
+
+            if (i == frame.statisticsScope)
+                m_log << ',' << m_pipelineStatistics.inputPrimitives << ',' << m_pipelineStatistics.vertexInvocations << ',' << m_pipelineStatistics.fragmentInvocations << '\n';
+            else
+                m_log << ",,,\n";
+        }
+    }
+
+    report(frame.number);
+}
+
+
+void GpuProfiler::report(uint64_t frameNumber) noexcept
+{
+    for (const auto& timing : m_timings)
+    {
+        auto average = std::find_if(m_averages.begin(), m_averages.end(), [&timing](const Average& a) { return std::strcmp(a.name, timing.name) == 0; });
+
+        if (average == m_averages.end())
+            average = m_averages.insert(m_averages.end(), { timing.name, 0.0, 0 });
+
+        average->time += timing.time;
+        average->count++;
+    }
+
+    if (++m_reportFrames < report_interval)
+        return;
+
+    std::string line;
+
+    for (const auto& average : m_averages)
+        line += fmt::format(" {} {:.3f} ms", average.name, average.time / average.count);
+
+    spdlog::debug("GPU profiler: frame {},{}", frameNumber, line);
+
+    m_averages.clear();
+    m_reportFrames = 0;
+}
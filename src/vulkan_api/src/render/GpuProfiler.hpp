@@ -0,0 +1,92 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "FrameStatistics.hpp"
+
+
+// GPU time of named scopes around ranges of a command buffer, a timestamp pair per scope. Every frame in flight has
+// its own queries, they are read back when the frame in flight comes around again and its fence has signaled: frame N
+// resolves frame N - framesInFlight, N - 2 by default, and reading never stalls. One scope per frame may count the
+// primitives and the shader invocations with a pipeline statistics query, when the device and create() allow it.
+// The timings of every resolved frame can go to a CSV log, their averages are logged every report_interval frames.
+// Scopes are opened on the primary command buffer only, outside of a rendering begun for secondary command buffers.
+// Not thread safe. Does nothing when the main queue has no timestamps.
+class GpuProfiler final
+{
+public:
+    static constexpr uint32_t max_scopes      = 32; // per frame, the scopes past it are not measured
+    static constexpr uint32_t invalid_scope   = UINT32_MAX;
+    static constexpr uint32_t report_interval = 500;
+
+    GpuProfiler() noexcept;
+    ~GpuProfiler();
+
+    bool create(uint32_t framesInFlight, bool pipelineStatistics) noexcept;
+    void destroy() noexcept;
+
+//  Opens the CSV log, a row per scope of every frame resolved from now on. An empty path closes it
+    bool setLog(const std::filesystem::path& path) noexcept;
+
+//  Right after vkBeginCommandBuffer, the fence of the frame has been waited for
+    void beginFrame(VkCommandBuffer cmd, uint32_t frame) noexcept;
+
+//  Returns the index to close the scope with, invalid_scope when it is not measured
+    uint32_t beginScope(VkCommandBuffer cmd, const char* name, bool pipelineStatistics = false) noexcept;
+    void endScope(VkCommandBuffer cmd, uint32_t scope) noexcept;
+
+//  The frame resolved by the last beginFrame(), empty when its results were not available yet
+    std::span<const GpuScopeTiming> getTimings() const noexcept;
+    const GpuPipelineStatistics& getPipelineStatistics() const noexcept;
+    double getFrameTime() const noexcept; // ms, sum of the top level scopes
+
+//  VkCommandBufferInheritanceInfo::pipelineStatistics of the secondary command buffers, 0 - no statistics
+    VkQueryPipelineStatisticFlags getStatisticsFlags() const noexcept;
+
+private:
+    struct Scope
+    {
+        const char* name;
+        uint32_t    depth;
+    };
+
+    struct Frame
+    {
+        std::vector<Scope> scopes;
+        uint32_t statisticsScope = invalid_scope;
+        uint64_t number = 0;
+    };
+
+    struct Average
+    {
+        const char* name;
+        double      time;
+        uint32_t    count;
+    };
+
+    void resolve(Frame& frame, uint32_t firstQuery, uint32_t statisticsQuery) noexcept;
+    void report(uint64_t frameNumber) noexcept;
+
+    VkQueryPool m_timestamps;
+    VkQueryPool m_statistics; // one query per frame in flight
+    float       m_period;     // ns per tick
+    uint64_t    m_tickMask;   // timestampValidBits of the main queue, the upper bits are undefined
+
+    std::vector<Frame> m_frames;
+    uint32_t m_frame;
+    uint32_t m_depth;
+    uint64_t m_frameNumber;
+
+    std::vector<uint64_t>       m_ticks;
+    std::vector<GpuScopeTiming> m_timings;
+    GpuPipelineStatistics       m_pipelineStatistics;
+
+    std::vector<Average> m_averages; // of the current report interval
+    uint32_t             m_reportFrames;
+    std::ofstream        m_log;
+};
@@ -4,7 +4,7 @@
 
 
 // TODO add clear color value
-bool Renderer::begin(VkCommandBuffer cmd, uint32_t imageIndex) noexcept
+bool Renderer::begin(VkCommandBuffer cmd, uint32_t frame, uint32_t imageIndex, VkRenderingFlags flags) noexcept
 {
     const auto colorAttachment = vkView->getSwapchain()->getColorAttachment(imageIndex);
     const auto depthAttachment = vkView->getSwapchain()->getDepthAttachment();
@@ -25,6 +25,12 @@ bool Renderer::begin(VkCommandBuffer cmd, uint32_t imageIndex) noexcept
     if (result != VK_SUCCESS)
         return false;
 
+    if (profiler)
+    {
+        profiler->beginFrame(cmd, frame);
+        frameScope = profiler->beginScope(cmd, "frame");
+    }
+
     const VkImageMemoryBarrier imageMemoryBarrier =
     {
         .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
@@ -58,12 +64,13 @@ bool Renderer::begin(VkCommandBuffer cmd, uint32_t imageIndex) noexcept
                          &imageMemoryBarrier                            // pImageMemoryBarriers
     );
 
+//  a single depth buffer is shared by the frames in flight, the clear waits for the depth writes of the previous frame
     VkImageMemoryBarrier depthBufferBarrier = 
     {
         .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
         .pNext               = VK_NULL_HANDLE,
-        .srcAccessMask       = VK_ACCESS_NONE,
-        .dstAccessMask       = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        .srcAccessMask       = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        .dstAccessMask       = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
         .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
         .newLayout           = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
         .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
@@ -80,8 +87,8 @@ bool Renderer::begin(VkCommandBuffer cmd, uint32_t imageIndex) noexcept
     };
 
     vkCmdPipelineBarrier(cmd,
-                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
                          0, 
                          0, 
                          VK_NULL_HANDLE, 
@@ -124,7 +131,7 @@ bool Renderer::begin(VkCommandBuffer cmd, uint32_t imageIndex) noexcept
     {
         .sType                = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
         .pNext                = VK_NULL_HANDLE,
-        .flags                = 0,
+        .flags                = flags,
         .renderArea           = { { 0, 0 }, extent },
         .layerCount           = 1,
         .viewMask             = 0,
@@ -134,8 +141,71 @@ bool Renderer::begin(VkCommandBuffer cmd, uint32_t imageIndex) noexcept
         .pStencilAttachment   = VK_NULL_HANDLE
     };
 
+//  the statistics query stays active across the secondary command buffers, they inherit it
+    if (profiler)
+        renderingScope = profiler->beginScope(cmd, "rendering", true);
+
     vkCmdBeginRendering(cmd, &renderingInfo);
 
+//  dynamic state is not inherited, every secondary command buffer sets its own
+    if (!(flags & VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT))
+        setViewport(cmd);
+
+    return true;
+}
+
+
+bool Renderer::beginSecondary(VkCommandBuffer cmd) const noexcept
+{
+    const VkFormat colorFormat = vkView->getSwapchain()->getColorAttachment(0).format;
+    const VkFormat depthFormat = vkView->getSwapchain()->getDepthAttachment().format;
+
+    const VkCommandBufferInheritanceRenderingInfoKHR renderingInfo =
+    {
+        .sType                   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR,
+        .pNext                   = VK_NULL_HANDLE,
+        .flags                   = 0,
+        .viewMask                = 0,
+        .colorAttachmentCount    = 1,
+        .pColorAttachmentFormats = &colorFormat,
+        .depthAttachmentFormat   = depthFormat,
+        .stencilAttachmentFormat = VK_FORMAT_UNDEFINED,
+        .rasterizationSamples    = VK_SAMPLE_COUNT_1_BIT
+    };
+
+    const VkCommandBufferInheritanceInfo inheritanceInfo =
+    {
+        .sType                = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .pNext                = &renderingInfo,
+        .renderPass           = VK_NULL_HANDLE,
+        .subpass              = 0,
+        .framebuffer          = VK_NULL_HANDLE,
+        .occlusionQueryEnable = VK_FALSE,
+        .queryFlags           = 0,
+        .pipelineStatistics   = profiler ? profiler->getStatisticsFlags() : 0
+    };
+
+    const VkCommandBufferBeginInfo beginInfo = 
+    {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext            = VK_NULL_HANDLE,
+        .flags            = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = &inheritanceInfo
+    };
+
+    if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS)
+        return false;
+
+    setViewport(cmd);
+
+    return true;
+}
+
+
+void Renderer::setViewport(VkCommandBuffer cmd) const noexcept
+{
+    const VkExtent2D extent = vkView->getSwapchain()->getSize();
+
     const VkViewport viewport = 
     {
         .x        = 0.f,
@@ -155,8 +225,6 @@ bool Renderer::begin(VkCommandBuffer cmd, uint32_t imageIndex) noexcept
     };
 
     vkCmdSetScissor(cmd, 0, 1, &scissor);
-
-    return true;
 }
 
 
@@ -164,14 +232,20 @@ bool Renderer::end(VkCommandBuffer cmd, uint32_t imageIndex) noexcept
 {
     vkCmdEndRendering(cmd);
 
+    if (profiler)
+        profiler->endScope(cmd, renderingScope);
+
+//  an offscreen image is only ever read back by a copy
+    const bool offscreen = vkView->getSwapchain()->isOffscreen();
+
     const VkImageMemoryBarrier imageMemoryBarrier =
     {
         .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
         .pNext               = VK_NULL_HANDLE,
         .srcAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-        .dstAccessMask       = VK_ACCESS_NONE,
+        .dstAccessMask       = offscreen ? VK_ACCESS_TRANSFER_READ_BIT : VK_ACCESS_NONE,
         .oldLayout           = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        .newLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+        .newLayout           = offscreen ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
         .srcQueueFamilyIndex = 0,
         .dstQueueFamilyIndex = 0,
         .image               = vkView->getSwapchain()->getColorAttachment(imageIndex).image,
@@ -186,8 +260,8 @@ bool Renderer::end(VkCommandBuffer cmd, uint32_t imageIndex) noexcept
     };
 
     vkCmdPipelineBarrier(cmd,
-                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,   // srcStageMask
-                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,            // dstStageMask
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,                                      // srcStageMask
+                         offscreen ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,  // dstStageMask
                          0,
                          0,
                          VK_NULL_HANDLE,
@@ -197,5 +271,8 @@ bool Renderer::end(VkCommandBuffer cmd, uint32_t imageIndex) noexcept
                          &imageMemoryBarrier                              // pImageMemoryBarriers
     );
 
+    if (profiler)
+        profiler->endScope(cmd, frameScope);
+
     return (vkEndCommandBuffer(cmd) == VK_SUCCESS);
 }
\ No newline at end of file
@@ -2,10 +2,20 @@
 
 #include <vulkan/vulkan.h>
 
+#include "render/GpuProfiler.hpp"
+
 struct Renderer
 {
-    bool begin(VkCommandBuffer cmd, uint32_t imageIndex) noexcept;
+//  With VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT the draws are only allowed in secondary command buffers
+    bool begin(VkCommandBuffer cmd, uint32_t frame, uint32_t imageIndex, VkRenderingFlags flags = 0) noexcept;
     bool end(VkCommandBuffer cmd, uint32_t imageIndex) noexcept;
 
+//  Begins a secondary command buffer continuing the rendering started by begin()
+    bool beginSecondary(VkCommandBuffer cmd) const noexcept;
+    void setViewport(VkCommandBuffer cmd) const noexcept;
+
     VkClearValue clearColor = { 0.f, 0.f, 0.f, 1.f };
+    GpuProfiler* profiler = nullptr; // begin() starts its frame, the queries can not be reset inside the rendering
+    uint32_t frameScope     = GpuProfiler::invalid_scope; // the whole command buffer
+    uint32_t renderingScope = GpuProfiler::invalid_scope; // the rendering, with the pipeline statistics
 };
\ No newline at end of file
@@ -0,0 +1,40 @@
+#version 460
+
+// Fragment workload selected by Engine::setShadingBenchmark() to compare a specialized pipeline with a generic one.
+// The specialized pipeline resolves the loop count and the detail branch at creation time, the driver unrolls the loop
+// and drops the dead code. The generic pipeline reads both from the uniform buffer for every fragment.
+
+layout(constant_id = 0) const uint ITERATIONS = 0; // 0 - generic, the parameters come from ubo.shading
+layout(constant_id = 1) const bool DETAIL     = false;
+
+layout(binding = 0) uniform UniformBufferObject
+{
+    mat4  viewProjection;
+    uvec4 shading; // x - iterations, y - detail
+} ubo;
+
+layout(binding = 1) uniform sampler2D texSampler;
+
+layout(location = 0) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    const bool specialized = (ITERATIONS != 0);
+    const uint iterations  = specialized ? ITERATIONS : ubo.shading.x;
+    const bool detail      = specialized ? DETAIL : (ubo.shading.y != 0);
+
+    vec3 color = texture(texSampler, fragTexCoord).rgb;
+    vec2 point = fragTexCoord;
+
+    for (uint i = 0; i < iterations; ++i)
+    {
+        point = vec2(point.x * point.x - point.y * point.y, 2.0 * point.x * point.y) * 0.5 + fragTexCoord;
+
+        if (detail)
+            color += 0.002 * sin(vec3(point, point.x + point.y) * float(i + 1));
+    }
+
+    outColor = vec4(color + 0.001 * vec3(point, 0.0), 1.0);
+}
@@ -0,0 +1,21 @@
+#version 460
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Fragment shader of the bindless texture mode, every texture is a slot of one array bound for the whole frame
+// and the draw selects its own with the material of the push constants. The index is uniform within a draw.
+
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+layout(push_constant) uniform DrawConstants
+{
+    layout(offset = 64) uint material; // slot in textures, follows the model matrix of vertex_push_constants.vert
+} draw;
+
+layout(location = 0) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main() 
+{
+    outColor = texture(textures[draw.material], fragTexCoord);
+}
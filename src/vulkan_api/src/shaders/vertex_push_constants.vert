@@ -0,0 +1,25 @@
+#version 460
+
+// Vertex shader of DrawPath::PushConstants, one draw per cube with its model matrix in the push constants
+
+layout(binding = 0) uniform UniformBufferObject 
+{
+    mat4 viewProjection;
+} ubo;
+
+layout(push_constant) uniform DrawConstants
+{
+    mat4 model;
+    uint material; // texture of the cube
+} draw;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+
+layout(location = 0) out vec2 fragTexCoord;
+
+void main() 
+{
+    gl_Position = ubo.viewProjection * draw.model * vec4(inPosition, 1.f);
+    fragTexCoord = inTexCoord;
+}
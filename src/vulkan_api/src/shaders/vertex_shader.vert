@@ -2,16 +2,17 @@
 
 layout(binding = 0) uniform UniformBufferObject 
 {
-    mat4 modelViewProjection;
+    mat4 viewProjection;
 } ubo;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) in mat4 inModel; // per instance, locations 2-5
 
 layout(location = 0) out vec2 fragTexCoord;
 
 void main() 
 {
-    gl_Position = ubo.modelViewProjection * vec4(inPosition, 1.f);
+    gl_Position = ubo.viewProjection * inModel * vec4(inPosition, 1.f);
     fragTexCoord = inTexCoord;
-}
\ No newline at end of file
+}
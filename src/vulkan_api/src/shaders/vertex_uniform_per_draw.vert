@@ -0,0 +1,22 @@
+#version 460
+
+// Vertex shader of DrawPath::UniformPerDraw, one draw per cube with its model matrix in its own block of the uniform arena
+
+layout(binding = 0) uniform UniformBufferObject 
+{
+    mat4  viewProjection;
+    uvec4 shading;
+    mat4  model;
+    uint  material; // texture of the cube
+} ubo;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+
+layout(location = 0) out vec2 fragTexCoord;
+
+void main() 
+{
+    gl_Position = ubo.viewProjection * ubo.model * vec4(inPosition, 1.f);
+    fragTexCoord = inTexCoord;
+}
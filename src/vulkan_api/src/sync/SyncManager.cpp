@@ -2,16 +2,17 @@
 #include "sync/SyncManager.hpp"
 
 
-bool SyncManager::create() noexcept
+static const VkSemaphoreCreateInfo semaphore_info = 
 {
-    auto logicalDevice = vkContext->get<VkDevice>();
+    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+    .pNext = VK_NULL_HANDLE,
+    .flags = 0
+};
 
-    const VkSemaphoreCreateInfo semaphoreInfo = 
-    {
-        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-        .pNext = VK_NULL_HANDLE,
-        .flags = 0
-    };
+
+bool SyncManager::create(uint32_t frameCount, uint32_t imageCount) noexcept
+{
+    auto logicalDevice = vkContext->get<VkDevice>();
 
     const VkFenceCreateInfo fenceInfo = 
     {
@@ -20,18 +21,39 @@ bool SyncManager::create() noexcept
         .flags = VK_FENCE_CREATE_SIGNALED_BIT
     };
 
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
-    {
-        if(vkCreateSemaphore(logicalDevice, &semaphoreInfo, VK_NULL_HANDLE, &imageAvailableSemaphores[i]) != VK_SUCCESS)
-            return false;
+    framesInFlight = frameCount;
+    currentFrame   = 0;
 
-        if(vkCreateSemaphore(logicalDevice, &semaphoreInfo, VK_NULL_HANDLE, &renderFinishedSemaphores[i]) != VK_SUCCESS)
+    imageAvailableSemaphores.resize(frameCount, VK_NULL_HANDLE);
+    inFlightFences.resize(frameCount, VK_NULL_HANDLE);
+
+    for (uint32_t i = 0; i < frameCount; ++i)
+    {
+        if(vkCreateSemaphore(logicalDevice, &semaphore_info, VK_NULL_HANDLE, &imageAvailableSemaphores[i]) != VK_SUCCESS)
             return false;
 
         if(vkCreateFence(logicalDevice, &fenceInfo, VK_NULL_HANDLE, &inFlightFences[i]) != VK_SUCCESS)
             return false;
     }
 
+    return createImageSemaphores(imageCount);
+}
+
+
+bool SyncManager::createImageSemaphores(uint32_t imageCount) noexcept
+{
+    auto logicalDevice = vkContext->get<VkDevice>();
+
+    for (auto semaphore : renderFinishedSemaphores)
+        vkDestroySemaphore(logicalDevice, semaphore, VK_NULL_HANDLE);
+
+    renderFinishedSemaphores.assign(imageCount, VK_NULL_HANDLE);
+    imagesInFlight.assign(imageCount, VK_NULL_HANDLE);
+
+    for (uint32_t i = 0; i < imageCount; ++i)
+        if(vkCreateSemaphore(logicalDevice, &semaphore_info, VK_NULL_HANDLE, &renderFinishedSemaphores[i]) != VK_SUCCESS)
+            return false;
+
     return true;
 }
 
@@ -40,10 +62,17 @@ void SyncManager::destroy() noexcept
 {
     const auto logicalDevice = vkContext->get<VkDevice>();
 
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
-    {
-        vkDestroySemaphore(logicalDevice, renderFinishedSemaphores[i], VK_NULL_HANDLE);
-        vkDestroySemaphore(logicalDevice, imageAvailableSemaphores[i], VK_NULL_HANDLE);
-        vkDestroyFence(logicalDevice, inFlightFences[i], VK_NULL_HANDLE);
-    }
-}
\ No newline at end of file
+    for (auto semaphore : renderFinishedSemaphores)
+        vkDestroySemaphore(logicalDevice, semaphore, VK_NULL_HANDLE);
+
+    for (auto semaphore : imageAvailableSemaphores)
+        vkDestroySemaphore(logicalDevice, semaphore, VK_NULL_HANDLE);
+
+    for (auto fence : inFlightFences)
+        vkDestroyFence(logicalDevice, fence, VK_NULL_HANDLE);
+
+    renderFinishedSemaphores.clear();
+    imageAvailableSemaphores.clear();
+    inFlightFences.clear();
+    imagesInFlight.clear();
+}
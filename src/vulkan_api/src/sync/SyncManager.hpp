@@ -1,17 +1,24 @@
 #pragma once
 
-#include <array>
+#include <vector>
 
 #include "utils/Tools.hpp"
 
 
 struct SyncManager
 {
-    bool create() noexcept;
+    bool create(uint32_t frameCount, uint32_t imageCount) noexcept;
+    bool createImageSemaphores(uint32_t imageCount) noexcept;
     void destroy() noexcept;
 
-    std::array<VkSemaphore, MAX_FRAMES_IN_FLIGHT> imageAvailableSemaphores = { VK_NULL_HANDLE, VK_NULL_HANDLE };
-    std::array<VkSemaphore, MAX_FRAMES_IN_FLIGHT> renderFinishedSemaphores = { VK_NULL_HANDLE, VK_NULL_HANDLE };
-    std::array<VkFence, MAX_FRAMES_IN_FLIGHT>     inFlightFences           = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+//  per frame in flight
+    std::vector<VkSemaphore> imageAvailableSemaphores;
+    std::vector<VkFence>     inFlightFences;
+
+//  per swapchain image: the semaphore is waited on by the presentation engine, the fence is borrowed from the frame that renders into the image
+    std::vector<VkSemaphore> renderFinishedSemaphores;
+    std::vector<VkFence>     imagesInFlight;
+
+    uint32_t framesInFlight = 0;
     uint32_t currentFrame = 0;
-};
\ No newline at end of file
+};
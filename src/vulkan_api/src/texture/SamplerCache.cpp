@@ -0,0 +1,92 @@
+#include "context/Context.hpp"
+#include "texture/SamplerCache.hpp"
+
+
+static bool is_same_sampler(const VkSamplerCreateInfo& a, const VkSamplerCreateInfo& b) noexcept
+{
+    return a.flags                   == b.flags                   &&
+           a.magFilter               == b.magFilter               &&
+           a.minFilter               == b.minFilter               &&
+           a.mipmapMode              == b.mipmapMode              &&
+           a.addressModeU            == b.addressModeU            &&
+           a.addressModeV            == b.addressModeV            &&
+           a.addressModeW            == b.addressModeW            &&
+           a.mipLodBias              == b.mipLodBias              &&
+           a.anisotropyEnable        == b.anisotropyEnable        &&
+           a.maxAnisotropy           == b.maxAnisotropy           &&
+           a.compareEnable           == b.compareEnable           &&
+           a.compareOp               == b.compareOp               &&
+           a.minLod                  == b.minLod                  &&
+           a.maxLod                  == b.maxLod                  &&
+           a.borderColor             == b.borderColor             &&
+           a.unnormalizedCoordinates == b.unnormalizedCoordinates;
+}
+
+
+
+VkSampler SamplerCache::get(const VkSamplerCreateInfo& info) noexcept
+{
+    std::lock_guard lock(m_mutex);
+
+//  a handful of samplers at most, a linear search is enough
+    for (const auto& [samplerInfo, sampler] : m_samplers)
+        if (is_same_sampler(samplerInfo, info))
+            return sampler;
+
+    VkSampler sampler;
+
+    if (vkCreateSampler(vkContext->get<VkDevice>(), &info, VK_NULL_HANDLE, &sampler) != VK_SUCCESS)
+        return VK_NULL_HANDLE;
+
+    m_samplers.emplace_back(info, sampler);
+    m_samplers.back().first.pNext = VK_NULL_HANDLE;
+
+    return sampler;
+}
+
+
+VkSampler SamplerCache::getTrilinear(uint32_t mipLevels) noexcept
+{
+    const auto physicalDevice = vkContext->get<VkPhysicalDevice>();
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+
+    const VkSamplerCreateInfo samplerInfo = 
+    {
+        .sType                   = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .pNext                   = VK_NULL_HANDLE,
+        .flags                   = 0,
+        .magFilter               = VK_FILTER_LINEAR,
+        .minFilter               = VK_FILTER_LINEAR,
+        .mipmapMode              = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+        .addressModeU            = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        .addressModeV            = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        .addressModeW            = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        .mipLodBias              = 0.f,
+        .anisotropyEnable        = features.samplerAnisotropy,
+        .maxAnisotropy           = features.samplerAnisotropy ? properties.limits.maxSamplerAnisotropy : 1.f,
+        .compareEnable           = VK_FALSE,
+        .compareOp               = VK_COMPARE_OP_ALWAYS,
+        .minLod                  = 0.f,
+        .maxLod                  = static_cast<float>(mipLevels),
+        .borderColor             = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
+        .unnormalizedCoordinates = VK_FALSE
+    };
+
+    return get(samplerInfo);
+}
+
+
+void SamplerCache::destroy() noexcept
+{
+    std::lock_guard lock(m_mutex);
+
+    for (const auto& [samplerInfo, sampler] : m_samplers)
+        vkDestroySampler(vkContext->get<VkDevice>(), sampler, VK_NULL_HANDLE);
+
+    m_samplers.clear();
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+
+// Samplers shared by all textures, one VkSampler per distinct description.
+// Textures only borrow the handles, every sampler is destroyed by destroy().
+class SamplerCache final
+{
+public:
+    VkSampler get(const VkSamplerCreateInfo& info) noexcept;
+
+//  Trilinear, repeating and anisotropic when the device supports it, the LOD range covers mipLevels
+    VkSampler getTrilinear(uint32_t mipLevels) noexcept;
+
+    void destroy() noexcept;
+
+private:
+    std::vector<std::pair<VkSamplerCreateInfo, VkSampler>> m_samplers;
+    std::mutex m_mutex;
+};
@@ -1,16 +1,17 @@
 #pragma once
 
-#include <filesystem>
-
-#include <vulkan/vulkan.h>
+#include "memory/MemoryAllocator.hpp"
 
 struct Texture2D
 {
-    bool loadFromFile(const std::filesystem::path& filepath, VkCommandPool pool) noexcept;
+//  Creates an empty sampled image with levelCount mip levels, the content is uploaded by the caller.
+//  The sampler is borrowed from a SamplerCache and is not destroyed with the texture.
+    bool create(VkExtent2D extent, VkFormat format, uint32_t levelCount, VkSampler textureSampler) noexcept;
     void destroy() noexcept;
 
-    VkDeviceMemory imageMemory = VK_NULL_HANDLE;
-    VkImage        image       = VK_NULL_HANDLE;
-    VkImageView    imageView   = VK_NULL_HANDLE;
-    VkSampler      sampler     = VK_NULL_HANDLE;
-};
\ No newline at end of file
+    Allocation  allocation;
+    VkImage     image     = VK_NULL_HANDLE;
+    VkImageView imageView = VK_NULL_HANDLE;
+    VkSampler   sampler   = VK_NULL_HANDLE;
+    uint32_t    mipLevels = 1;
+};
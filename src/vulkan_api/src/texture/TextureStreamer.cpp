@@ -0,0 +1,866 @@
+#include <cstring>
+#include <array>
+#include <algorithm>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+#include "spdlog/spdlog.h"
+
+#include "files/CookedImage.hpp"
+#include "files/CookedTexture.hpp"
+#include "files/StbImage.hpp"
+#include "utils/Tools.hpp"
+#include "utils/CpuProfiler.hpp"
+#include "context/Context.hpp"
+#include "texture/TextureStreamer.hpp"
+
+
+static constexpr VkFormat decoded_format = VK_FORMAT_R8G8B8A8_SRGB; // images decoded at runtime, cooked ones carry their format
+static constexpr uint32_t placeholder_index = UINT32_MAX;
+static constexpr VkDeviceSize staging_alignment = 16;
+
+
+static VkImageMemoryBarrier create_image_barrier(VkImage image,
+                                                 VkAccessFlags srcAccess,
+                                                 VkAccessFlags dstAccess,
+                                                 VkImageLayout oldLayout,
+                                                 VkImageLayout newLayout,
+                                                 uint32_t srcQueueFamily,
+                                                 uint32_t dstQueueFamily,
+                                                 uint32_t levelCount) noexcept
+{
+    return
+    {
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext               = VK_NULL_HANDLE,
+        .srcAccessMask       = srcAccess,
+        .dstAccessMask       = dstAccess,
+        .oldLayout           = oldLayout,
+        .newLayout           = newLayout,
+        .srcQueueFamilyIndex = srcQueueFamily,
+        .dstQueueFamilyIndex = dstQueueFamily,
+        .image               = image,
+        .subresourceRange    =
+        {
+            .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel   = 0,
+            .levelCount     = levelCount,
+            .baseArrayLayer = 0,
+            .layerCount     = 1
+        }
+    };
+}
+
+
+static VkExtent2D get_level_extent(VkExtent2D extent, uint32_t level) noexcept
+{
+    return { std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u) };
+}
+
+
+//  Writes a row of the next level from two rows of the previous one, each texel averages a 2x2 block with the
+//  rounding of the scalar (a + b + c + d + 2) / 4. The vector loops cover the texels whose block lies in the row, the
+//  averages are widened to 16 bits since _mm_avg_epu8 rounds each half up and would drift from the exact result
+static void downsample_row(const uint8_t* row0, const uint8_t* row1, uint8_t* out, uint32_t srcWidth, uint32_t dstWidth) noexcept
+{
+    uint32_t x = 0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(2);
+
+//  4 texels out of 8 per row, 2x + 7 < srcWidth holds as long as x + 4 <= dstWidth
+    for (; x + 4 <= dstWidth; x += 4)
+    {
+        const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+        const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8 + 16));
+        const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+        const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8 + 16));
+
+//      vertical sums, two source texels per register
+        __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+        __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+        __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+        __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+//      horizontal sums of the pairs, left in the low half
+        s0 = _mm_add_epi16(s0, _mm_srli_si128(s0, 8));
+        s1 = _mm_add_epi16(s1, _mm_srli_si128(s1, 8));
+        s2 = _mm_add_epi16(s2, _mm_srli_si128(s2, 8));
+        s3 = _mm_add_epi16(s3, _mm_srli_si128(s3, 8));
+
+        const __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s0, s1), round), 2);
+        const __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s2, s3), round), 2);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(__ARM_NEON)
+//  8 texels out of 16 per row, deinterleaved by channel so the pairs are adjacent lanes
+    for (; x + 8 <= dstWidth; x += 8)
+    {
+        const uint8x16x4_t a = vld4q_u8(row0 + x * 8);
+        const uint8x16x4_t b = vld4q_u8(row1 + x * 8);
+        uint8x8x4_t result;
+
+        for (int c = 0; c < 4; ++c)
+            result.val[c] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(a.val[c]), b.val[c]), 2);
+
+        vst4_u8(out + x * 4, result);
+    }
+#endif
+
+//  the tail and odd sizes, which clamp the second column to the edge
+    for (; x < dstWidth; ++x)
+    {
+        const size_t x0 = size_t(std::min(2 * x, srcWidth - 1)) * 4;
+        const size_t x1 = size_t(std::min(2 * x + 1, srcWidth - 1)) * 4;
+
+        for (size_t c = 0; c < 4; ++c)
+            out[x * 4 + c] = static_cast<uint8_t>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+    }
+}
+
+
+//  Appends the levels 1..mipLevels-1 of an RGBA8 image, each texel averages a 2x2 block of the previous level
+static void append_mip_chain(std::vector<uint8_t>& pixels, VkExtent2D extent, uint32_t mipLevels) noexcept
+{
+    size_t bytes = 0;
+
+    for (uint32_t level = 0; level < mipLevels; ++level)
+    {
+        const VkExtent2D levelExtent = get_level_extent(extent, level);
+        bytes += size_t(levelExtent.width) * levelExtent.height * 4;
+    }
+
+    size_t srcOffset = 0;
+    pixels.resize(bytes);
+
+    for (uint32_t level = 1; level < mipLevels; ++level)
+    {
+        const VkExtent2D src = get_level_extent(extent, level - 1);
+        const VkExtent2D dst = get_level_extent(extent, level);
+
+        const size_t dstOffset = srcOffset + size_t(src.width) * src.height * 4;
+        const size_t srcPitch  = size_t(src.width) * 4;
+
+        for (uint32_t y = 0; y < dst.height; ++y)
+        {
+//          odd heights clamp the second row to the edge
+            const uint8_t* row0 = &pixels[srcOffset + std::min(2 * y, src.height - 1) * srcPitch];
+            const uint8_t* row1 = &pixels[srcOffset + std::min(2 * y + 1, src.height - 1) * srcPitch];
+
+            downsample_row(row0, row1, &pixels[dstOffset + size_t(y) * dst.width * 4], src.width, dst.width);
+        }
+
+        srcOffset = dstOffset;
+    }
+}
+
+
+static VkCommandBuffer begin_commands(VkCommandPool pool) noexcept
+{
+    const VkCommandBufferAllocateInfo allocInfo =
+    {
+        .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext              = VK_NULL_HANDLE,
+        .commandPool        = pool,
+        .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1
+    };
+
+    VkCommandBuffer cmd;
+
+    if (vkAllocateCommandBuffers(vkContext->get<VkDevice>(), &allocInfo, &cmd) != VK_SUCCESS)
+        return VK_NULL_HANDLE;
+
+    const VkCommandBufferBeginInfo beginInfo =
+    {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext            = VK_NULL_HANDLE,
+        .flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = VK_NULL_HANDLE
+    };
+
+    if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS)
+    {
+        vkFreeCommandBuffers(vkContext->get<VkDevice>(), pool, 1, &cmd);
+
+        return VK_NULL_HANDLE;
+    }
+
+    return cmd;
+}
+
+
+
+TextureStreamer::TextureStreamer() noexcept:
+    m_transferPool(VK_NULL_HANDLE),
+    m_graphicsPool(VK_NULL_HANDLE),
+    m_dedicatedTransfer(false),
+    m_cpuMips(false),
+    m_uploadBudget(32ull * 1024 * 1024),
+    m_stop(false),
+    m_pendingCount(0),
+    m_residentCount(0),
+    m_uploadedBytes(0),
+    m_decodeTime(0)
+{
+
+}
+
+
+TextureStreamer::~TextureStreamer()
+{
+    destroy();
+}
+
+
+bool TextureStreamer::create(uint32_t threadCount) noexcept
+{
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+    m_dedicatedTransfer = vkContext->getTransferQueueFamilyIndex() != vkContext->getQueueFamilyIndex();
+    m_cpuMips = !vktools::is_linear_blit_supported(decoded_format, vkContext->get<VkPhysicalDevice>());
+
+    const std::array<std::pair<uint32_t, VkCommandPool*>, 2> pools =
+    {
+        std::make_pair(vkContext->getTransferQueueFamilyIndex(), &m_transferPool),
+        std::make_pair(vkContext->getQueueFamilyIndex(), &m_graphicsPool)
+    };
+
+    for (auto [family, pool] : pools)
+    {
+        const VkCommandPoolCreateInfo poolInfo =
+        {
+            .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext            = VK_NULL_HANDLE,
+            .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = family
+        };
+
+        if (vkCreateCommandPool(logicalDevice, &poolInfo, VK_NULL_HANDLE, pool) != VK_SUCCESS)
+            return false;
+    }
+
+    {// Placeholder, a magenta and black checker which is resident before the first frame
+        const uint8_t checker[] =
+        {
+            255, 0, 255, 255,   0, 0,   0, 255,
+              0, 0,   0, 255, 255, 0, 255, 255
+        };
+
+        std::vector<Decoded> images(1);
+        images[0].texture      = placeholder_index;
+        images[0].extent       = { 2, 2 };
+        images[0].format       = decoded_format;
+        images[0].mipLevels    = 2;
+        images[0].storedLevels = 2;
+        images[0].pixels.assign(std::begin(checker), std::end(checker));
+
+        append_mip_chain(images[0].pixels, images[0].extent, images[0].mipLevels);
+        images[0].texels = images[0].pixels;
+
+        Batch batch;
+
+        if (!submit(images, &batch) || !retire(batch, true))
+        {
+            release(batch);
+
+            return false;
+        }
+    }
+
+    if (threadCount == 0)
+        threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+    m_stop = false;
+
+    try
+    {
+        for (uint32_t i = 0; i < threadCount; ++i)
+            m_workers.emplace_back(&TextureStreamer::workerLoop, this);
+    }
+    catch (const std::system_error& error)
+    {
+        spdlog::error("Texture streaming: failed to start a decoder thread, {}", error.what());
+
+        return false;
+    }
+
+    spdlog::info("Texture streaming: {} decoder threads, {} transfer queue, {} mipmaps",
+                 threadCount, m_dedicatedTransfer ? "dedicated" : "main", m_cpuMips ? "CPU" : "blitted");
+
+    return true;
+}
+
+
+void TextureStreamer::destroy() noexcept
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_requested.notify_all();
+
+    for (auto& worker : m_workers)
+        worker.join();
+
+    m_workers.clear();
+    m_requests.clear();
+    m_decoded.clear();
+
+    for (auto& batch : m_batches)
+    {
+        retire(batch, true);
+        release(batch);
+    }
+
+    m_batches.clear();
+
+    for (auto& entry : m_textures)
+        entry.texture.destroy();
+
+    m_textures.clear();
+    m_published.clear();
+
+    if (m_placeholder.texture.image)
+        m_placeholder.texture.destroy();
+
+    m_samplers.destroy();
+
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+    if (m_transferPool)
+        vkDestroyCommandPool(logicalDevice, m_transferPool, VK_NULL_HANDLE);
+
+    if (m_graphicsPool)
+        vkDestroyCommandPool(logicalDevice, m_graphicsPool, VK_NULL_HANDLE);
+
+    m_transferPool  = VK_NULL_HANDLE;
+    m_graphicsPool  = VK_NULL_HANDLE;
+    m_pendingCount  = 0;
+    m_residentCount = 0;
+    m_uploadedBytes = 0;
+    m_decodeTime    = 0;
+}
+
+
+uint32_t TextureStreamer::load(const std::filesystem::path& filepath) noexcept
+{
+    const uint32_t texture = static_cast<uint32_t>(m_textures.size());
+    m_textures.emplace_back();
+
+    if (m_pendingCount++ == 0)
+        m_loadStart = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_requests.emplace_back(texture, filepath);
+    }
+
+    m_requested.notify_one();
+
+    return texture;
+}
+
+
+uint32_t TextureStreamer::loadDirectory(const std::filesystem::path& directory) noexcept
+{
+    constexpr std::array<std::string_view, 6> extensions = { ".ctex", ".jpg", ".jpeg", ".png", ".bmp", ".tga" };
+
+    std::error_code error;
+    uint32_t count = 0;
+
+    for (const auto& file : std::filesystem::directory_iterator(directory, error))
+    {
+        const std::filesystem::path& path = file.path();
+        const std::string extension = path.extension().string();
+
+        if (!file.is_regular_file() || std::find(extensions.begin(), extensions.end(), extension) == extensions.end())
+            continue;
+
+//      a cooked sibling replaces the source image
+        if (extension != ".ctex" && std::filesystem::exists(std::filesystem::path(path).replace_extension(".ctex")))
+            continue;
+
+        load(path);
+        count++;
+    }
+
+    if (error)
+        spdlog::error("Texture streaming: failed to list {}, {}", directory.string(), error.message());
+
+    spdlog::info("Texture streaming: {} images queued from {}", count, directory.string());
+
+    return count;
+}
+
+
+void TextureStreamer::update() noexcept
+{
+    CPU_PROFILE_SCOPE("TextureStreamer::update");
+
+    m_published.clear();
+
+    while (!m_batches.empty() && retire(m_batches.front(), false))
+    {
+        release(m_batches.front());
+        m_batches.pop_front();
+    }
+
+    std::vector<Decoded> images;
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        VkDeviceSize bytes = 0;
+        auto it = m_decoded.begin();
+
+//      at least one image per update, a single image larger than the budget still gets through
+        for (; it != m_decoded.end() && (bytes < m_uploadBudget || images.empty()); ++it)
+        {
+            bytes += it->texels.size();
+            images.push_back(std::move(*it));
+        }
+
+        m_decoded.erase(m_decoded.begin(), it);
+    }
+
+    const auto failed = std::partition(images.begin(), images.end(), [](const Decoded& image) { return !image.texels.empty(); });
+
+    for (auto it = failed; it != images.end(); ++it)
+    {
+        m_textures[it->texture].failed = true;
+        m_pendingCount--;
+    }
+
+    images.erase(failed, images.end());
+
+    if (images.empty())
+        return;
+
+    Batch batch;
+
+    if (submit(images, &batch))
+    {
+        m_batches.push_back(std::move(batch));
+
+        return;
+    }
+
+    spdlog::error("Texture streaming: failed to submit {} images", images.size());
+
+    release(batch);
+
+    for (const auto& image : images)
+    {
+        m_textures[image.texture].texture.destroy();
+        m_textures[image.texture].failed = true;
+        m_pendingCount--;
+    }
+}
+
+
+const Texture2D& TextureStreamer::get(uint32_t texture) const noexcept
+{
+    if (texture < m_textures.size() && m_textures[texture].resident)
+        return m_textures[texture].texture;
+
+    return m_placeholder.texture;
+}
+
+
+bool TextureStreamer::isResident(uint32_t texture) const noexcept
+{
+    return (texture < m_textures.size() && m_textures[texture].resident);
+}
+
+
+uint32_t TextureStreamer::getPendingCount() const noexcept
+{
+    return m_pendingCount;
+}
+
+
+uint32_t TextureStreamer::getTextureCount() const noexcept
+{
+    return static_cast<uint32_t>(m_textures.size());
+}
+
+
+std::span<const uint32_t> TextureStreamer::getPublished() const noexcept
+{
+    return m_published;
+}
+
+
+bool TextureStreamer::submit(std::vector<Decoded>& images, Batch* batch) noexcept
+{
+    CPU_PROFILE_SCOPE("TextureStreamer::submit");
+
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+    const uint32_t transferFamily = vkContext->getTransferQueueFamilyIndex();
+    const uint32_t graphicsFamily = vkContext->getQueueFamilyIndex();
+
+    VkDeviceSize stagingSize = 0;
+
+//  every image starts on a 16 byte boundary, copies of block compressed images need offsets aligned to the block size
+    for (const auto& image : images)
+        stagingSize += (image.texels.size() + staging_alignment - 1) & ~(staging_alignment - 1);
+
+    batch->staging = vktools::create_buffer(stagingSize,
+                                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                            &batch->stagingAllocation,
+                                            logicalDevice);
+
+    if (!batch->staging)
+        return false;
+
+    std::vector<VkImageMemoryBarrier> toTransfer;
+    std::vector<VkImageMemoryBarrier> toShader;
+    std::vector<VkBufferImageCopy>    copies;
+    std::vector<uint32_t>             copyCounts;
+    std::vector<const Decoded*>       blitted;
+
+    VkDeviceSize offset = 0;
+
+    for (const auto& image : images)
+    {
+        Entry& entry = (image.texture == placeholder_index) ? m_placeholder : m_textures[image.texture];
+
+        if (!entry.texture.create(image.extent, image.format, image.mipLevels, m_samplers.getTrilinear(image.mipLevels)))
+            return false;
+
+        batch->textures.push_back(image.texture);
+
+        offset = (offset + staging_alignment - 1) & ~(staging_alignment - 1);
+        memcpy(static_cast<uint8_t*>(batch->stagingAllocation.mapped) + offset, image.texels.data(), image.texels.size());
+
+        for (uint32_t level = 0; level < image.storedLevels; ++level)
+        {
+            const VkExtent2D levelExtent = get_level_extent(image.extent, level);
+
+            const VkBufferImageCopy region =
+            {
+                .bufferOffset      = offset,
+                .bufferRowLength   = 0,
+                .bufferImageHeight = 0,
+                .imageSubresource  =
+                {
+                    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel       = level,
+                    .baseArrayLayer = 0,
+                    .layerCount     = 1
+                },
+                .imageOffset = { 0, 0, 0 },
+                .imageExtent = { levelExtent.width, levelExtent.height, 1 }
+            };
+
+            copies.push_back(region);
+            offset += get_texel_data_size(image.format, levelExtent.width, levelExtent.height);
+        }
+
+        copyCounts.push_back(image.storedLevels);
+        m_uploadedBytes += get_mip_chain_size(image.format, image.extent.width, image.extent.height, image.mipLevels);
+
+        toTransfer.push_back(create_image_barrier(entry.texture.image,
+                                                  VK_ACCESS_NONE,
+                                                  VK_ACCESS_TRANSFER_WRITE_BIT,
+                                                  VK_IMAGE_LAYOUT_UNDEFINED,
+                                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                  VK_QUEUE_FAMILY_IGNORED,
+                                                  VK_QUEUE_FAMILY_IGNORED,
+                                                  image.mipLevels));
+
+        const bool blit = image.storedLevels < image.mipLevels;
+
+        if (blit)
+            blitted.push_back(&image);
+
+//      on the main queue generate_mipmaps does the transition of blitted images itself
+        if (blit && !m_dedicatedTransfer)
+            continue;
+
+//      with a dedicated transfer queue this is the release half of the ownership transfer, the acquire half runs on the main queue.
+//      Blitted images keep TRANSFER_DST until the main queue generated their levels.
+        toShader.push_back(create_image_barrier(entry.texture.image,
+                                                VK_ACCESS_TRANSFER_WRITE_BIT,
+                                                m_dedicatedTransfer ? VK_ACCESS_NONE : VK_ACCESS_SHADER_READ_BIT,
+                                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                blit ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                m_dedicatedTransfer ? transferFamily : VK_QUEUE_FAMILY_IGNORED,
+                                                m_dedicatedTransfer ? graphicsFamily : VK_QUEUE_FAMILY_IGNORED,
+                                                image.mipLevels));
+    }
+
+    const VkFenceCreateInfo fenceInfo =
+    {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .pNext = VK_NULL_HANDLE,
+        .flags = 0
+    };
+
+    if (vkCreateFence(logicalDevice, &fenceInfo, VK_NULL_HANDLE, &batch->fence) != VK_SUCCESS)
+        return false;
+
+    if (batch->transferCmd = begin_commands(m_transferPool); !batch->transferCmd)
+        return false;
+
+    vkCmdPipelineBarrier(batch->transferCmd,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         0, VK_NULL_HANDLE,
+                         0, VK_NULL_HANDLE,
+                         static_cast<uint32_t>(toTransfer.size()), toTransfer.data());
+
+    for (size_t i = 0, first = 0; i < copyCounts.size(); first += copyCounts[i++])
+        vkCmdCopyBufferToImage(batch->transferCmd, batch->staging, toTransfer[i].image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, copyCounts[i], &copies[first]);
+
+    if (!toShader.empty())
+        vkCmdPipelineBarrier(batch->transferCmd,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             m_dedicatedTransfer ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0,
+                             0, VK_NULL_HANDLE,
+                             0, VK_NULL_HANDLE,
+                             static_cast<uint32_t>(toShader.size()), toShader.data());
+
+    if (!m_dedicatedTransfer)
+    {
+        for (const Decoded* image : blitted)
+        {
+            const Entry& entry = (image->texture == placeholder_index) ? m_placeholder : m_textures[image->texture];
+            vktools::generate_mipmaps(batch->transferCmd, entry.texture.image, image->extent, image->mipLevels);
+        }
+
+        if (vkEndCommandBuffer(batch->transferCmd) != VK_SUCCESS)
+            return false;
+
+        const VkSubmitInfo submitInfo =
+        {
+            .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext                = VK_NULL_HANDLE,
+            .waitSemaphoreCount   = 0,
+            .pWaitSemaphores      = VK_NULL_HANDLE,
+            .pWaitDstStageMask    = VK_NULL_HANDLE,
+            .commandBufferCount   = 1,
+            .pCommandBuffers      = &batch->transferCmd,
+            .signalSemaphoreCount = 0,
+            .pSignalSemaphores    = VK_NULL_HANDLE
+        };
+
+        return (vkQueueSubmit(vkContext->get<VkQueue>(), 1, &submitInfo, batch->fence) == VK_SUCCESS);
+    }
+
+    if (vkEndCommandBuffer(batch->transferCmd) != VK_SUCCESS)
+        return false;
+
+    const VkSemaphoreCreateInfo semaphoreInfo =
+    {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = VK_NULL_HANDLE,
+        .flags = 0
+    };
+
+    if (vkCreateSemaphore(logicalDevice, &semaphoreInfo, VK_NULL_HANDLE, &batch->released) != VK_SUCCESS)
+        return false;
+
+    if (batch->graphicsCmd = begin_commands(m_graphicsPool); !batch->graphicsCmd)
+        return false;
+
+//  the acquire barriers repeat the layout transition and the queue families of the release barriers
+    for (auto& barrier : toShader)
+    {
+        const bool blit = barrier.newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+
+        barrier.srcAccessMask = VK_ACCESS_NONE;
+        barrier.dstAccessMask = blit ? VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT;
+    }
+
+    vkCmdPipelineBarrier(batch->graphicsCmd,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0,
+                         0, VK_NULL_HANDLE,
+                         0, VK_NULL_HANDLE,
+                         static_cast<uint32_t>(toShader.size()), toShader.data());
+
+//  blits need the graphics queue, the levels are generated once the main queue owns the images
+    for (const Decoded* image : blitted)
+    {
+        const Entry& entry = (image->texture == placeholder_index) ? m_placeholder : m_textures[image->texture];
+        vktools::generate_mipmaps(batch->graphicsCmd, entry.texture.image, image->extent, image->mipLevels);
+    }
+
+    if (vkEndCommandBuffer(batch->graphicsCmd) != VK_SUCCESS)
+        return false;
+
+    const VkSubmitInfo transferSubmit =
+    {
+        .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext                = VK_NULL_HANDLE,
+        .waitSemaphoreCount   = 0,
+        .pWaitSemaphores      = VK_NULL_HANDLE,
+        .pWaitDstStageMask    = VK_NULL_HANDLE,
+        .commandBufferCount   = 1,
+        .pCommandBuffers      = &batch->transferCmd,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores    = &batch->released
+    };
+
+    if (vkQueueSubmit(vkContext->getTransferQueue(), 1, &transferSubmit, VK_NULL_HANDLE) != VK_SUCCESS)
+        return false;
+
+    const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+    const VkSubmitInfo graphicsSubmit =
+    {
+        .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext                = VK_NULL_HANDLE,
+        .waitSemaphoreCount   = 1,
+        .pWaitSemaphores      = &batch->released,
+        .pWaitDstStageMask    = &waitStage,
+        .commandBufferCount   = 1,
+        .pCommandBuffers      = &batch->graphicsCmd,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores    = VK_NULL_HANDLE
+    };
+
+    return (vkQueueSubmit(vkContext->get<VkQueue>(), 1, &graphicsSubmit, batch->fence) == VK_SUCCESS);
+}
+
+
+bool TextureStreamer::retire(Batch& batch, bool wait) noexcept
+{
+    if (!batch.fence)
+        return false;
+
+    const auto logicalDevice = vkContext->get<VkDevice>();
+    const VkResult result = wait ? vkWaitForFences(logicalDevice, 1, &batch.fence, VK_TRUE, UINT64_MAX) : vkGetFenceStatus(logicalDevice, batch.fence);
+
+    if (result != VK_SUCCESS)
+        return false;
+
+    using namespace std::chrono;
+
+    for (uint32_t texture : batch.textures)
+    {
+        if (texture == placeholder_index)
+        {
+            m_placeholder.resident = true;
+            continue;
+        }
+
+        m_textures[texture].resident = true;
+        m_published.push_back(texture);
+        m_pendingCount--;
+
+        if (m_residentCount++ == 0)
+            spdlog::info("Texture streaming: first texture resident after {:.3f} ms", duration<double, std::milli>(steady_clock::now() - m_loadStart).count());
+    }
+
+    batch.textures.clear();
+
+    if (m_pendingCount == 0 && m_residentCount)
+    {
+        std::lock_guard lock(m_mutex);
+
+        spdlog::info("Texture streaming: {} textures resident ({:.2f} MiB of texels), {:.3f} ms spent decoding, the queue drained after {:.3f} ms",
+                     m_residentCount, m_uploadedBytes / (1024.0 * 1024.0), m_decodeTime, duration<double, std::milli>(steady_clock::now() - m_loadStart).count());
+    }
+
+    return true;
+}
+
+
+void TextureStreamer::release(Batch& batch) noexcept
+{
+    const auto logicalDevice = vkContext->get<VkDevice>();
+
+    if (batch.transferCmd)
+        vkFreeCommandBuffers(logicalDevice, m_transferPool, 1, &batch.transferCmd);
+
+    if (batch.graphicsCmd)
+        vkFreeCommandBuffers(logicalDevice, m_graphicsPool, 1, &batch.graphicsCmd);
+
+    if (batch.released)
+        vkDestroySemaphore(logicalDevice, batch.released, VK_NULL_HANDLE);
+
+    if (batch.fence)
+        vkDestroyFence(logicalDevice, batch.fence, VK_NULL_HANDLE);
+
+    vktools::destroy_buffer(batch.staging, batch.stagingAllocation, logicalDevice);
+
+    batch = {};
+}
+
+
+void TextureStreamer::workerLoop() noexcept
+{
+    CPU_PROFILE_THREAD("texture decoder");
+
+    for (;;)
+    {
+        std::pair<uint32_t, std::filesystem::path> request;
+
+        {
+            std::unique_lock lock(m_mutex);
+            m_requested.wait(lock, [this] { return m_stop || !m_requests.empty(); });
+
+            if (m_stop)
+                return;
+
+            request = std::move(m_requests.front());
+            m_requests.pop_front();
+        }
+
+        using namespace std::chrono;
+
+        const auto start = steady_clock::now();
+        const bool cooked = request.second.extension() == ".ctex";
+
+        Decoded decoded = { request.first, {}, decoded_format, 1, 1, {}, {}, {} };
+
+//      empty texels tell update() the decoding failed
+        if (CookedImage cookedImage; cooked && cookedImage.loadFromFile(request.second, vkContext->get<VkPhysicalDevice>()))
+        {
+            decoded.extent       = { cookedImage.width, cookedImage.height };
+            decoded.format       = cookedImage.format;
+            decoded.mipLevels    = cookedImage.levelCount;
+            decoded.storedLevels = cookedImage.levelCount;
+            decoded.file         = std::move(cookedImage.file);
+            decoded.texels       = cookedImage.data;
+        }
+        else if (StbImage stbImage; !cooked && stbImage.loadFromFile(request.second, StbImage::Alpha))
+        {
+            decoded.extent = { static_cast<uint32_t>(stbImage.width), static_cast<uint32_t>(stbImage.height) };
+            decoded.pixels.assign(stbImage.pixels.get(), stbImage.pixels.get() + size_t(stbImage.width) * stbImage.height * 4);
+            decoded.mipLevels = vktools::get_mip_level_count(decoded.extent);
+
+            if (m_cpuMips)
+            {
+                append_mip_chain(decoded.pixels, decoded.extent, decoded.mipLevels);
+                decoded.storedLevels = decoded.mipLevels;
+            }
+
+            decoded.texels = decoded.pixels;
+        }
+        else
+        {
+            spdlog::error("Texture streaming: failed to decode {}", request.second.string());
+        }
+
+        std::lock_guard lock(m_mutex);
+        m_decoded.push_back(std::move(decoded));
+        m_decodeTime += duration<double, std::milli>(steady_clock::now() - start).count();
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "files/PackFile.hpp"
+#include "texture/SamplerCache.hpp"
+#include "texture/Texture2D.hpp"
+
+
+// Asynchronous texture loader.
+// Images are decoded by worker threads, update() uploads the decoded ones from the main thread through the transfer queue
+// and hands the images over to the main queue family. Precooked .ctex files skip the decoding and carry their own mip chain. Until a texture is resident get() returns a placeholder.
+// Mip chains are blitted on the main queue, formats without linear blit support get them box filtered by the workers.
+class TextureStreamer final
+{
+public:
+    TextureStreamer() noexcept;
+    ~TextureStreamer();
+
+    bool create(uint32_t threadCount = 0) noexcept; // 0 - one thread per core minus the main thread
+    void destroy() noexcept;
+
+    uint32_t load(const std::filesystem::path& filepath) noexcept;
+    uint32_t loadDirectory(const std::filesystem::path& directory) noexcept; // returns the number of queued images
+
+//  Called once per frame: submits decoded images and publishes the finished uploads
+    void update() noexcept;
+
+    const Texture2D& get(uint32_t texture) const noexcept;
+    bool isResident(uint32_t texture) const noexcept;
+    uint32_t getPendingCount() const noexcept;
+    uint32_t getTextureCount() const noexcept; // textures requested with load(), resident or not
+
+//  Textures which became resident during the last update()
+    std::span<const uint32_t> getPublished() const noexcept;
+
+private:
+//  moving a Decoded keeps texels valid, the vector buffer and the mapping move along
+    struct Decoded
+    {
+        uint32_t             texture;
+        VkExtent2D           extent;
+        VkFormat             format;
+        uint32_t             mipLevels;
+        uint32_t             storedLevels; // levels present in texels, the rest is blitted
+
+        std::vector<uint8_t>     pixels; // decoded images and their CPU mip chain
+        FileData                 file;   // cooked images are copied to the staging buffer from the mapping or the pack
+        std::span<const uint8_t> texels; // texel data of format level after level, points into pixels or file
+    };
+
+    struct Batch
+    {
+        VkCommandBuffer transferCmd = VK_NULL_HANDLE;
+        VkCommandBuffer graphicsCmd = VK_NULL_HANDLE;
+        VkSemaphore     released    = VK_NULL_HANDLE;
+        VkFence         fence       = VK_NULL_HANDLE;
+        VkBuffer        staging     = VK_NULL_HANDLE;
+        Allocation      stagingAllocation;
+        std::vector<uint32_t> textures;
+    };
+
+    struct Entry
+    {
+        Texture2D texture;
+        bool      resident = false;
+        bool      failed   = false;
+    };
+
+    bool submit(std::vector<Decoded>& images, Batch* batch) noexcept;
+    bool retire(Batch& batch, bool wait) noexcept;
+    void release(Batch& batch) noexcept;
+    void workerLoop() noexcept;
+
+    std::vector<Entry>    m_textures;
+    std::vector<uint32_t> m_published;
+    Entry              m_placeholder;
+    std::deque<Batch>  m_batches;
+    SamplerCache       m_samplers;
+
+    VkCommandPool m_transferPool;
+    VkCommandPool m_graphicsPool;
+    bool          m_dedicatedTransfer;
+    bool          m_cpuMips;
+    VkDeviceSize  m_uploadBudget; // bytes submitted per update()
+
+    std::vector<std::thread>                                 m_workers;
+    std::deque<std::pair<uint32_t, std::filesystem::path>>   m_requests;
+    std::vector<Decoded>                                     m_decoded;
+    mutable std::mutex                                       m_mutex;
+    std::condition_variable                                  m_requested;
+    bool                                                     m_stop;
+
+    uint32_t     m_pendingCount;
+    uint32_t     m_residentCount;
+    VkDeviceSize m_uploadedBytes;
+    double       m_decodeTime; // milliseconds summed over the workers, guarded by m_mutex
+    std::chrono::steady_clock::time_point m_loadStart;
+};
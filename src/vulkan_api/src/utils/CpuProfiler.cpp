@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "utils/CpuProfiler.hpp"
+
+
+namespace
+{
+    struct Event
+    {
+        const char* name;
+        uint64_t    start;
+        uint64_t    end;
+    };
+
+//  Written by its thread only, the others read the events below count. A full block stays where it is, readers never
+//  see an event move.
+    struct ThreadBuffer
+    {
+        ~ThreadBuffer()
+        {
+            for (auto& block : blocks)
+                delete[] block.load(std::memory_order_relaxed);
+        }
+
+        std::array<std::atomic<Event*>, CpuProfiler::max_events / CpuProfiler::block_size> blocks = {};
+        std::atomic<uint32_t>    count   = 0;
+        std::atomic<uint32_t>    dropped = 0;
+        std::atomic<const char*> name    = nullptr;
+        uint32_t                 index   = 0;
+    };
+}
+
+
+static std::mutex s_mutex; // s_threads, taken once per thread and by the readers
+static std::vector<std::unique_ptr<ThreadBuffer>> s_threads;
+static thread_local ThreadBuffer* t_buffer = nullptr;
+
+
+static ThreadBuffer* get_thread_buffer() noexcept
+{
+    if (!t_buffer)
+    {
+        std::lock_guard lock(s_mutex);
+
+        t_buffer = s_threads.emplace_back(std::make_unique<ThreadBuffer>()).get();
+        t_buffer->index = static_cast<uint32_t>(s_threads.size() - 1);
+    }
+
+    return t_buffer;
+}
+
+
+void CpuProfiler::record(const char* name, uint64_t start, uint64_t end) noexcept
+{
+    ThreadBuffer* buffer = get_thread_buffer();
+    const uint32_t index = buffer->count.load(std::memory_order_relaxed);
+
+    if (index == max_events)
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+
+        return;
+    }
+
+    auto& slot = buffer->blocks[index / block_size];
+    Event* block = slot.load(std::memory_order_relaxed);
+
+    if (!block)
+    {
+        block = new Event[block_size];
+        slot.store(block, std::memory_order_release);
+    }
+
+    block[index % block_size] = { name, start, end };
+
+//  publishes the event to the readers
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+
+void CpuProfiler::setThreadName(const char* name) noexcept
+{
+    get_thread_buffer()->name.store(name, std::memory_order_relaxed);
+}
+
+
+// calls visit(thread, event) for every event recorded so far
+template<class Visitor>
+static void for_each_event(Visitor&& visit) noexcept
+{
+    std::lock_guard lock(s_mutex);
+
+    for (const auto& thread : s_threads)
+    {
+        const uint32_t count = thread->count.load(std::memory_order_acquire);
+
+        for (uint32_t i = 0; i < count; ++i)
+            visit(*thread, thread->blocks[i / CpuProfiler::block_size].load(std::memory_order_acquire)[i % CpuProfiler::block_size]);
+    }
+}
+
+
+bool CpuProfiler::exportTrace(const std::filesystem::path& path) noexcept
+{
+#ifndef CPU_PROFILER
+    spdlog::warn("CPU profiler: the build has no CPU_PROFILER, {} gets no events", path.string());
+#endif
+
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+
+    if (!file)
+    {
+        spdlog::error("CPU profiler: failed to open {}", path.string());
+
+        return false;
+    }
+
+//  the trace starts at the first event, the timestamps are in microseconds
+    uint64_t origin = UINT64_MAX;
+    uint64_t eventCount = 0;
+    const char* separator = "";
+
+    for_each_event([&origin](const ThreadBuffer&, const Event& event) { origin = std::min(origin, event.start); });
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    {
+        std::lock_guard lock(s_mutex);
+
+        for (const auto& thread : s_threads)
+        {
+            const char* name = thread->name.load(std::memory_order_relaxed);
+
+            file << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->index << ",\"args\":{\"name\":\"";
+
+            if (name)
+                file << name;
+            else
+                file << "thread " << thread->index;
+
+            file << "\"}}";
+            separator = ",\n";
+        }
+    }
+
+    file << std::fixed;
+    file.precision(3);
+
+    for_each_event([&](const ThreadBuffer& thread, const Event& event)
+    {
+        file << separator << "{\"name\":\"" << event.name << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.index
+             << ",\"ts\":" << double(event.start - origin) * 1e-3 << ",\"dur\":" << double(event.end - event.start) * 1e-3 << '}';
+
+        separator = ",\n";
+        eventCount++;
+    });
+
+    file << "\n]}\n";
+
+    if (!file)
+    {
+        spdlog::error("CPU profiler: failed to write {}", path.string());
+
+        return false;
+    }
+
+    spdlog::info("CPU profiler: {} events written to {}", eventCount, path.string());
+
+    return true;
+}
+
+
+void CpuProfiler::logStatistics() noexcept
+{
+    struct Durations
+    {
+        std::string_view      name;
+        std::vector<uint64_t> times; // ns
+        uint64_t              total = 0;
+    };
+
+//  the same literal may have a pointer per translation unit, the scopes are grouped by their text
+    std::unordered_map<std::string_view, Durations> scopes;
+    uint32_t dropped = 0;
+
+    for_each_event([&scopes](const ThreadBuffer&, const Event& event)
+    {
+        auto& scope = scopes[event.name];
+
+        scope.name = event.name;
+        scope.times.push_back(event.end - event.start);
+        scope.total += event.end - event.start;
+    });
+
+    {
+        std::lock_guard lock(s_mutex);
+
+        for (const auto& thread : s_threads)
+            dropped += thread->dropped.load(std::memory_order_relaxed);
+    }
+
+    if (scopes.empty())
+        return;
+
+    std::vector<Durations*> sorted;
+
+    for (auto& [name, scope] : scopes)
+        sorted.push_back(&scope);
+
+    std::sort(sorted.begin(), sorted.end(), [](const Durations* a, const Durations* b) { return a->total > b->total; });
+
+    for (Durations* scope : sorted)
+    {
+        auto& times = scope->times;
+        std::sort(times.begin(), times.end());
+
+//      nearest rank
+        const size_t p99 = std::max<size_t>((times.size() * 99 + 99) / 100, 1) - 1;
+
+        spdlog::info("CPU profiler: {:<32} {:8} calls, min {:8.3f} ms, avg {:8.3f} ms, p99 {:8.3f} ms, total {:10.3f} ms",
+                     scope->name, times.size(), times.front() * 1e-6, double(scope->total) / times.size() * 1e-6, times[p99] * 1e-6, scope->total * 1e-6);
+    }
+
+    if (dropped)
+        spdlog::warn("CPU profiler: {} events dropped, a thread recorded more than {}", dropped, max_events);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+
+
+// CPU time of named scopes on every thread, recorded with the macros below. Each thread appends its events to a buffer
+// of its own without locks, only its first event registers the buffer. The events are kept until exit, at most
+// max_events per thread, the later ones are counted as dropped.
+// exportTrace() writes them as Chrome trace JSON for chrome://tracing or ui.perfetto.dev, logStatistics() logs
+// count, min, avg, p99 and total per scope name.
+// The macros expand to nothing unless CPU_PROFILER is defined, the VULKAN_API_CPU_PROFILER option of the build.
+// The scope names are string literals, only their pointers are stored.
+class CpuProfiler final
+{
+public:
+    static constexpr uint32_t block_size = 4096;
+    static constexpr uint32_t max_events = 256 * block_size;
+
+    class Scope final
+    {
+    public:
+        explicit Scope(const char* name) noexcept:
+            m_name(name),
+            m_start(now())
+        {
+
+        }
+
+        ~Scope()
+        {
+            record(m_name, m_start, now());
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* m_name;
+        uint64_t    m_start;
+    };
+
+    static void record(const char* name, uint64_t start, uint64_t end) noexcept;
+    static void setThreadName(const char* name) noexcept; // shown by the trace viewers instead of the thread index
+
+    static bool exportTrace(const std::filesystem::path& path) noexcept;
+    static void logStatistics() noexcept;
+
+    static uint64_t now() noexcept // ns
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+};
+
+
+#ifdef CPU_PROFILER
+    #define CPU_PROFILE_CONCAT_IMPL(a, b) a##b
+    #define CPU_PROFILE_CONCAT(a, b)      CPU_PROFILE_CONCAT_IMPL(a, b)
+
+    #define CPU_PROFILE_SCOPE(name)  const CpuProfiler::Scope CPU_PROFILE_CONCAT(cpu_profile_scope_, __LINE__)(name)
+    #define CPU_PROFILE_THREAD(name) CpuProfiler::setThreadName(name)
+#else
+    #define CPU_PROFILE_SCOPE(name)  ((void)0)
+    #define CPU_PROFILE_THREAD(name) ((void)0)
+#endif
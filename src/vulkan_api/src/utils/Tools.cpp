@@ -1,4 +1,6 @@
 #include <array>
+#include <algorithm>
+#include <bit>
 
 #include "spdlog/spdlog.h"
 #include <magic_enum/magic_enum.hpp>
@@ -82,7 +84,7 @@ void end_single_time_commands(VkCommandBuffer cmd, VkDevice device, VkCommandPoo
 }
 
 
-VkBuffer create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkDeviceMemory* bufferMemory, VkDevice device, VkPhysicalDevice gpu) noexcept
+VkBuffer create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, Allocation* allocation, VkDevice device) noexcept
 {
     const VkBufferCreateInfo bufferInfo = 
     {
@@ -104,24 +106,16 @@ VkBuffer create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryProp
     VkMemoryRequirements memRequirements;
     vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
 
-    const VkMemoryAllocateInfo allocInfo = 
-    {
-        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext           = VK_NULL_HANDLE,
-        .allocationSize  = memRequirements.size,
-        .memoryTypeIndex = find_memory_type(memRequirements.memoryTypeBits, properties, gpu)
-    };
-
-    if (vkAllocateMemory(device, &allocInfo, VK_NULL_HANDLE, bufferMemory) != VK_SUCCESS)
+    if (!vkAllocator->allocate(memRequirements, properties, true, allocation))
     {
         vkDestroyBuffer(device, buffer, VK_NULL_HANDLE);
 
         return VK_NULL_HANDLE;
     }
     
-    if(vkBindBufferMemory(device, buffer, *bufferMemory, 0) != VK_SUCCESS)
+    if(vkBindBufferMemory(device, buffer, allocation->memory, allocation->offset) != VK_SUCCESS)
     {
-        vkFreeMemory(device, *bufferMemory, VK_NULL_HANDLE);
+        vkAllocator->free(*allocation);
         vkDestroyBuffer(device, buffer, VK_NULL_HANDLE);
 
         return VK_NULL_HANDLE;
@@ -131,6 +125,15 @@ VkBuffer create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryProp
 }
 
 
+void destroy_buffer(VkBuffer buffer, Allocation& allocation, VkDevice device) noexcept
+{
+    if (buffer)
+        vkDestroyBuffer(device, buffer, VK_NULL_HANDLE);
+
+    vkAllocator->free(allocation);
+}
+
+
 void copy_buffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept
 {
     VkCommandBuffer cmd = begin_single_time_commands(device, pool);
@@ -281,9 +284,9 @@ VkImage create_image_2D(VkExtent2D extent,
                      VkImageTiling tiling, 
                      VkImageUsageFlags usage, 
                      VkMemoryPropertyFlags properties, 
-                     VkDeviceMemory* imageMemory) noexcept
+                     Allocation* allocation,
+                     uint32_t mipLevels) noexcept
 {
-    auto physicalDevive = vkContext->get<VkPhysicalDevice>();
     auto logicalDevice = vkContext->get<VkDevice>();
 
     VkImage image = VK_NULL_HANDLE;
@@ -301,7 +304,7 @@ VkImage create_image_2D(VkExtent2D extent,
             .height = extent.height,
             .depth  = 1
         },
-        .mipLevels             = 1,
+        .mipLevels             = mipLevels,
         .arrayLayers           = 1,
         .samples               = VK_SAMPLE_COUNT_1_BIT,
         .tiling                = tiling,
@@ -318,25 +321,30 @@ VkImage create_image_2D(VkExtent2D extent,
     VkMemoryRequirements memRequirements;
     vkGetImageMemoryRequirements(logicalDevice, image, &memRequirements);
 
-    const VkMemoryAllocateInfo allocInfo = 
-    {
-        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext           = VK_NULL_HANDLE,
-        .allocationSize  = memRequirements.size,
-        .memoryTypeIndex = find_memory_type(memRequirements.memoryTypeBits, properties, physicalDevive)
-    };
-
-    if (vkAllocateMemory(logicalDevice, &allocInfo, VK_NULL_HANDLE, imageMemory) == VK_SUCCESS)
+    if (vkAllocator->allocate(memRequirements, properties, tiling == VK_IMAGE_TILING_LINEAR, allocation))
     {
-        if ((vkBindImageMemory(logicalDevice, image, *imageMemory, 0) == VK_SUCCESS))
+        if ((vkBindImageMemory(logicalDevice, image, allocation->memory, allocation->offset) == VK_SUCCESS))
             return image;
+
+        vkAllocator->free(*allocation);
     }
 
+    vkDestroyImage(logicalDevice, image, VK_NULL_HANDLE);
+
     return VK_NULL_HANDLE;
 }
 
 
-VkImageView create_image_view_2D(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) noexcept
+void destroy_image(VkImage image, Allocation& allocation) noexcept
+{
+    if (image)
+        vkDestroyImage(vkContext->get<VkDevice>(), image, VK_NULL_HANDLE);
+
+    vkAllocator->free(allocation);
+}
+
+
+VkImageView create_image_view_2D(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels) noexcept
 {
     VkImageView imageView = VK_NULL_HANDLE;
 
@@ -359,7 +367,7 @@ VkImageView create_image_view_2D(VkImage image, VkFormat format, VkImageAspectFl
         {
             .aspectMask     = aspectFlags,
             .baseMipLevel   = 0,
-            .levelCount     = 1,
+            .levelCount     = mipLevels,
             .baseArrayLayer = 0,
             .layerCount     = 1
         }
@@ -398,4 +406,93 @@ bool has_stencil_component(VkFormat format) noexcept
     return ( (format == VK_FORMAT_D32_SFLOAT_S8_UINT) || (format == VK_FORMAT_D24_UNORM_S8_UINT) );
 }
 
+
+uint32_t get_mip_level_count(VkExtent2D extent) noexcept
+{
+    return static_cast<uint32_t>(std::bit_width(std::max(extent.width, extent.height)));
+}
+
+
+bool is_linear_blit_supported(VkFormat format, VkPhysicalDevice gpu) noexcept
+{
+    constexpr VkFormatFeatureFlags features = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(gpu, format, &props);
+
+    return ((props.optimalTilingFeatures & features) == features);
+}
+
+
+void generate_mipmaps(VkCommandBuffer cmd, VkImage image, VkExtent2D extent, uint32_t mipLevels) noexcept
+{
+    VkImageMemoryBarrier barrier = 
+    {
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext               = VK_NULL_HANDLE,
+        .srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask       = VK_ACCESS_TRANSFER_READ_BIT,
+        .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image               = image,
+        .subresourceRange    = 
+        {
+            .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel   = 0,
+            .levelCount     = 1,
+            .baseArrayLayer = 0,
+            .layerCount     = 1
+        }
+    };
+
+    int32_t width  = static_cast<int32_t>(extent.width);
+    int32_t height = static_cast<int32_t>(extent.height);
+
+    for (uint32_t level = 1; level < mipLevels; ++level)
+    {
+//      the previous level becomes the blit source
+        barrier.subresourceRange.baseMipLevel = level - 1;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, 1, &barrier);
+
+        const int32_t nextWidth  = std::max(width / 2, 1);
+        const int32_t nextHeight = std::max(height / 2, 1);
+
+        const VkImageBlit blit = 
+        {
+            .srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1 },
+            .srcOffsets     = { { 0, 0, 0 }, { width, height, 1 } },
+            .dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 },
+            .dstOffsets     = { { 0, 0, 0 }, { nextWidth, nextHeight, 1 } }
+        };
+
+        vkCmdBlitImage(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, 1, &barrier);
+
+        width  = nextWidth;
+        height = nextHeight;
+    }
+
+//  the last level was only written
+    barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, 1, &barrier);
+}
+
 END_NAMESPACE_VKTOOLS
\ No newline at end of file
@@ -8,6 +8,8 @@
 
 #include <vulkan/vulkan.h>
 
+#include "memory/MemoryAllocator.hpp"
+
 
 #define BEGIN_NAMESPACE_VKTOOLS namespace vktools {
 #define END_NAMESPACE_VKTOOLS }
@@ -23,15 +25,26 @@ VkCommandBuffer begin_single_time_commands(VkDevice device, VkCommandPool pool)
 void end_single_time_commands(VkCommandBuffer cmd, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept;
 
 
-VkBuffer create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkDeviceMemory* bufferMemory, VkDevice device, VkPhysicalDevice gpu) noexcept;
+VkBuffer create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, Allocation* allocation, VkDevice device) noexcept;
+void destroy_buffer(VkBuffer buffer, Allocation& allocation, VkDevice device) noexcept;
 void copy_buffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept;
 
 
 // Images
 bool transition_image_layout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, VkCommandPool pool) noexcept;
 bool copy_buffer_to_image(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, VkCommandPool pool) noexcept;
-VkImage create_image_2D(VkExtent2D extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkDeviceMemory* imageMemory) noexcept;
-VkImageView create_image_view_2D(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) noexcept;
+VkImage create_image_2D(VkExtent2D extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, Allocation* allocation, uint32_t mipLevels = 1) noexcept;
+void destroy_image(VkImage image, Allocation& allocation) noexcept;
+VkImageView create_image_view_2D(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1) noexcept;
+
+
+// Mipmaps
+uint32_t get_mip_level_count(VkExtent2D extent) noexcept;
+bool is_linear_blit_supported(VkFormat format, VkPhysicalDevice gpu) noexcept;
+
+// Expects every level in TRANSFER_DST_OPTIMAL with level 0 filled, leaves every level in SHADER_READ_ONLY_OPTIMAL.
+// Blits need a queue with graphics support.
+void generate_mipmaps(VkCommandBuffer cmd, VkImage image, VkExtent2D extent, uint32_t mipLevels) noexcept;
 
 
 VkFormat find_supported_format(std::span<const VkFormat> formats, VkImageTiling tiling, VkFormatFeatureFlags features, VkPhysicalDevice gpu) noexcept;
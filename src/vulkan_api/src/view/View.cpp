@@ -38,12 +38,33 @@ bool View::create(uint64_t windowHandle) noexcept
 }
 
 
+bool View::createOffscreen(VkExtent2D extent, uint32_t imageCount) noexcept
+{
+    if (m_swapchain)
+        return true;
+
+    auto swapchain = std::make_unique<Swapchain>(extent, imageCount);
+
+    if (!swapchain->create())
+    {
+        swapchain->destroy();
+
+        return false;
+    }
+
+    swapchain.swap(m_swapchain);
+
+    return true;
+}
+
+
 void View::destroy() noexcept
 {
     if (m_swapchain)
         m_swapchain->destroy();
 
-    vkDestroySurfaceKHR(vkContext->get<VkInstance>(), m_surface, VK_NULL_HANDLE);
+    if (m_surface)
+        vkDestroySurfaceKHR(vkContext->get<VkInstance>(), m_surface, VK_NULL_HANDLE);
 }
 
 
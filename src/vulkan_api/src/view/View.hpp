@@ -13,6 +13,7 @@ public:
     ~View();
 
     bool create(uint64_t windowHandle) noexcept;
+    bool createOffscreen(VkExtent2D extent, uint32_t imageCount) noexcept; // no surface, see Swapchain::isOffscreen()
     void destroy() noexcept;
     void resize() noexcept;
 
@@ -83,10 +83,27 @@ struct SwapChainSupportDetails
 
 
 
+// the readback gets the bytes in RGBA order, every device can render to it
+static constexpr VkFormat offscreen_format = VK_FORMAT_R8G8B8A8_SRGB;
+
+
 Swapchain::Swapchain(VkSurfaceKHR surface) noexcept:
     m_surface(surface),
     m_handle(VK_NULL_HANDLE),
-    m_depthBuffer{}
+    m_depthBuffer{},
+    m_extent{}
+{
+
+}
+
+
+Swapchain::Swapchain(VkExtent2D extent, uint32_t imageCount) noexcept:
+    m_surface(VK_NULL_HANDLE),
+    m_handle(VK_NULL_HANDLE),
+    m_colorAttachments(imageCount),
+    m_offscreenAllocations(imageCount),
+    m_depthBuffer{},
+    m_extent(extent)
 {
 
 }
@@ -94,6 +111,9 @@ Swapchain::Swapchain(VkSurfaceKHR surface) noexcept:
 
 bool Swapchain::create() noexcept
 {
+    if (isOffscreen())
+        return createOffscreenImages() && createDepthBuffer();
+
     auto context = vkContext;
     VkDevice device = context->get<VkDevice>();
 
@@ -164,39 +184,7 @@ bool Swapchain::create() noexcept
                     return false;  
             }
 
-//          Depth buffering
-            if (m_depthBuffer.attachment.imageView)
-                vkDestroyImageView(device, m_depthBuffer.attachment.imageView, VK_NULL_HANDLE);
-
-            if (m_depthBuffer.attachment.image)
-                vkDestroyImage(device, m_depthBuffer.attachment.image, VK_NULL_HANDLE);
-
-            if (m_depthBuffer.memory)
-                vkFreeMemory(device, m_depthBuffer.memory, VK_NULL_HANDLE);
-
-            if (m_depthBuffer.attachment.format == VK_FORMAT_UNDEFINED)
-            {
-                constexpr std::array<VkFormat, 3> formats = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT };
-                m_depthBuffer.attachment.format = vktools::find_supported_format(formats, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT, context->get<VkPhysicalDevice>());
-            }
-
-            if (m_depthBuffer.attachment.format != VK_FORMAT_UNDEFINED)
-            {
-                m_depthBuffer.attachment.image = vktools::create_image_2D(m_extent, 
-                                                                          m_depthBuffer.attachment.format, 
-                                                                          VK_IMAGE_TILING_OPTIMAL, 
-                                                                          VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, 
-                                                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
-                                                                          &m_depthBuffer.memory);
-
-                if (m_depthBuffer.attachment.image)
-                    m_depthBuffer.attachment.imageView = vktools::create_image_view_2D(m_depthBuffer.attachment.image, m_depthBuffer.attachment.format, VK_IMAGE_ASPECT_DEPTH_BIT);
-                
-                if (m_depthBuffer.attachment.imageView)
-                    return true;
-            }
-
-            return true;
+            return createDepthBuffer();
         }
     }
 
@@ -216,14 +204,13 @@ void Swapchain::destroy() noexcept
         vkDestroySwapchainKHR(device, m_handle, VK_NULL_HANDLE);
     }
 
+    if (isOffscreen())
+        destroyOffscreenImages();
+
     if (m_depthBuffer.attachment.imageView)
         vkDestroyImageView(device, m_depthBuffer.attachment.imageView, VK_NULL_HANDLE);
 
-    if (m_depthBuffer.attachment.image)
-        vkDestroyImage(device, m_depthBuffer.attachment.image, VK_NULL_HANDLE);
-
-    if (m_depthBuffer.memory)
-        vkFreeMemory(device, m_depthBuffer.memory, VK_NULL_HANDLE);
+    vktools::destroy_image(m_depthBuffer.attachment.image, m_depthBuffer.allocation);
 }
 
 
@@ -254,4 +241,96 @@ size_t Swapchain::getImageCount() const noexcept
 VkExtent2D Swapchain::getSize() const noexcept
 {
     return m_extent;
-}
\ No newline at end of file
+}
+
+
+bool Swapchain::createDepthBuffer() noexcept
+{
+    auto context = vkContext;
+    VkDevice device = context->get<VkDevice>();
+
+    if (m_depthBuffer.attachment.imageView)
+        vkDestroyImageView(device, m_depthBuffer.attachment.imageView, VK_NULL_HANDLE);
+
+    vktools::destroy_image(m_depthBuffer.attachment.image, m_depthBuffer.allocation);
+    m_depthBuffer.attachment.image = VK_NULL_HANDLE;
+
+    if (m_depthBuffer.attachment.format == VK_FORMAT_UNDEFINED)
+    {
+        constexpr std::array<VkFormat, 3> formats = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT };
+        m_depthBuffer.attachment.format = vktools::find_supported_format(formats, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT, context->get<VkPhysicalDevice>());
+    }
+
+    if (m_depthBuffer.attachment.format != VK_FORMAT_UNDEFINED)
+    {
+        m_depthBuffer.attachment.image = vktools::create_image_2D(m_extent, 
+                                                                  m_depthBuffer.attachment.format, 
+                                                                  VK_IMAGE_TILING_OPTIMAL, 
+                                                                  VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, 
+                                                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
+                                                                  &m_depthBuffer.allocation);
+
+        if (m_depthBuffer.attachment.image)
+            m_depthBuffer.attachment.imageView = vktools::create_image_view_2D(m_depthBuffer.attachment.image, m_depthBuffer.attachment.format, VK_IMAGE_ASPECT_DEPTH_BIT);
+        
+        if (m_depthBuffer.attachment.imageView)
+            return true;
+    }
+
+    return true;
+}
+
+
+bool Swapchain::isOffscreen() const noexcept
+{
+    return (m_surface == VK_NULL_HANDLE);
+}
+
+
+bool Swapchain::createOffscreenImages() noexcept
+{
+    destroyOffscreenImages();
+
+    for (size_t i = 0; i < m_colorAttachments.size(); ++i)
+    {
+        auto& attachment = m_colorAttachments[i];
+
+        attachment.format = offscreen_format;
+        attachment.image  = vktools::create_image_2D(m_extent, 
+                                                     offscreen_format, 
+                                                     VK_IMAGE_TILING_OPTIMAL, 
+                                                     VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, 
+                                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
+                                                     &m_offscreenAllocations[i]);
+
+        if (!attachment.image)
+            return false;
+
+        attachment.imageView = vktools::create_image_view_2D(attachment.image, offscreen_format, VK_IMAGE_ASPECT_COLOR_BIT);
+
+        if (!attachment.imageView)
+            return false;
+    }
+
+    return true;
+}
+
+
+void Swapchain::destroyOffscreenImages() noexcept
+{
+    VkDevice device = vkContext->get<VkDevice>();
+
+    for (size_t i = 0; i < m_colorAttachments.size(); ++i)
+    {
+        auto& attachment = m_colorAttachments[i];
+
+        if (attachment.imageView)
+            vkDestroyImageView(device, attachment.imageView, VK_NULL_HANDLE);
+
+        if (attachment.image)
+            vktools::destroy_image(attachment.image, m_offscreenAllocations[i]);
+
+        attachment = {};
+        m_offscreenAllocations[i] = {};
+    }
+}
@@ -4,7 +4,7 @@
 #include <vector>
 #include <memory>
 
-#include <vulkan/vulkan.h>
+#include "memory/MemoryAllocator.hpp"
 
 
 class Swapchain
@@ -19,6 +19,10 @@ public:
 
     Swapchain(VkSurfaceKHR surface) noexcept;
 
+//  Offscreen, the images are created and owned by the swapchain itself: nothing is acquired or presented and
+//  a rendered image is left in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL for the readback
+    Swapchain(VkExtent2D extent, uint32_t imageCount) noexcept;
+
     bool create() noexcept;
     void destroy() noexcept;
 
@@ -29,15 +33,22 @@ public:
     size_t getImageCount() const noexcept;
     VkExtent2D getSize() const noexcept;
 
+    bool isOffscreen() const noexcept;
+
 private:
+    bool createOffscreenImages() noexcept;
+    void destroyOffscreenImages() noexcept;
+    bool createDepthBuffer() noexcept;
+
     VkSurfaceKHR   m_surface;
     VkSwapchainKHR m_handle;
 
     std::vector<Attachment> m_colorAttachments;
+    std::vector<Allocation> m_offscreenAllocations; // offscreen only, one per color attachment
     struct
     {
-        Attachment     attachment;
-        VkDeviceMemory memory = nullptr;
+        Attachment attachment;
+        Allocation allocation;
     } m_depthBuffer;
     
     VkExtent2D m_extent;